@@ -0,0 +1,11 @@
+// bench_util.hpp
+#pragma once
+
+// Timing shared by the benchmarks in bench/
+#include <chrono>
+
+using Clock = std::chrono::steady_clock;
+
+inline double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
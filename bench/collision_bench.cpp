@@ -0,0 +1,90 @@
+// collision_bench.cpp
+// Player collision queries against a 1001x1001 maze: the old linear scan over every wall
+// against the CollisionWorld grid, which only looks at the cells around the player.
+// Query points are random positions inside the maze, radius is the player's 0.3.
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include "CollisionWorld.hpp"
+#include "MazeGenerator.hpp"
+#include "bench_util.hpp"
+
+namespace {
+    constexpr int MAZE_SIZE = 1001;
+    constexpr float PLAYER_RADIUS = 0.3f;
+    constexpr int LINEAR_QUERIES = 200;   // each one walks every wall
+    constexpr int GRID_QUERIES = 2000000;
+
+    // The scan App::checkWallCollision used to do: every wall, distance reject, then box overlap
+    bool linearScan(const std::vector<glm::vec2>& walls, const glm::vec2& position) {
+        const float maxDist = PLAYER_RADIUS + 0.5f;
+        bool hit = false;
+        for (const glm::vec2& wall : walls) {
+            if (hit) continue;
+            if (glm::distance(position, wall) > maxDist * 1.5f) continue;
+            float overlapX = maxDist - std::abs(position.x - wall.x);
+            float overlapZ = maxDist - std::abs(position.y - wall.y);
+            if (overlapX > 0 && overlapZ > 0) hit = true;
+        }
+        return hit;
+    }
+}
+
+int main() {
+    MazeGenerator generator;
+    MazeGrid grid;
+    generator.generate(grid, {.width = MAZE_SIZE, .height = MAZE_SIZE, .seed = 1234});
+
+    // Same world mapping as MazeBuild: cell centers at (x - size/2, y - size/2)
+    const float half = MAZE_SIZE / 2.0f;
+    std::vector<glm::vec2> walls;
+    CollisionWorld world;
+    world.resetGrid(MAZE_SIZE, MAZE_SIZE, glm::vec2(-half - 0.5f), 1.0f);
+    for (int y = 0; y < MAZE_SIZE; y++) {
+        for (int x = 0; x < MAZE_SIZE; x++) {
+            if (!grid.isWall(x, y)) continue;
+            walls.push_back(glm::vec2(x - half, y - half));
+            world.setSolid(x, y, true);
+        }
+    }
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> coord(-half, half);
+    std::vector<glm::vec2> points(GRID_QUERIES);
+    for (glm::vec2& point : points) point = glm::vec2(coord(rng), coord(rng));
+
+    auto start = Clock::now();
+    size_t linearHits = 0;
+    for (int i = 0; i < LINEAR_QUERIES; i++) {
+        linearHits += linearScan(walls, points[i]);
+    }
+    double linearMs = msSince(start) / LINEAR_QUERIES;
+
+    start = Clock::now();
+    size_t gridHits = 0;
+    for (const glm::vec2& point : points) {
+        gridHits += world.overlapCircle(point, PLAYER_RADIUS);
+    }
+    double gridMs = msSince(start) / GRID_QUERIES;
+
+    // The grid must agree with testing the circle against every wall
+    size_t mismatches = 0;
+    for (int i = 0; i < LINEAR_QUERIES; i++) {
+        bool brute = false;
+        for (const glm::vec2& wall : walls) {
+            brute = brute || circleVsBox(points[i], PLAYER_RADIUS, wall - 0.5f, wall + 0.5f);
+        }
+        mismatches += brute != world.overlapCircle(points[i], PLAYER_RADIUS);
+    }
+
+    std::printf("%dx%d maze, %zu walls\n", MAZE_SIZE, MAZE_SIZE, walls.size());
+    std::printf("linear scan : %12.1f ns/query (%d queries, %.1f%% hit)\n",
+                linearMs * 1e6, LINEAR_QUERIES, 100.0 * linearHits / LINEAR_QUERIES);
+    std::printf("grid        : %12.1f ns/query (%d queries, %.1f%% hit)\n",
+                gridMs * 1e6, GRID_QUERIES, 100.0 * gridHits / GRID_QUERIES);
+    std::printf("speedup     : %12.0fx, grid vs brute force circle test: %zu mismatches\n",
+                linearMs / gridMs, mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
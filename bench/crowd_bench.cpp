@@ -0,0 +1,71 @@
+// crowd_bench.cpp
+// CPU side of the crowd stress mode on a 201x201 maze, from 1k to 1M agents: the fixed
+// step (steering, wall collision, retargeting) and writing the instance data the GPU
+// reads, on one thread and on all. The GPU draw time needs a context and is shown by
+// the app's overlay; together they show where the costs cross over.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "Crowd.hpp"
+#include "bench_util.hpp"
+
+namespace {
+    constexpr int MAZE_SIZE = 201;
+    constexpr std::uint64_t SEED = 42;
+    constexpr int STEPS = 60;
+    constexpr float STEP = 1.0f / 120.0f;
+    constexpr size_t COUNTS[] = {1000, 10000, 100000, 1000000};
+
+    // Agents whose center ended up inside a wall, should stay 0
+    size_t agentsInWalls(const MazeGrid& grid, const std::vector<CrowdInstance>& instances) {
+        size_t count = 0;
+        for (const CrowdInstance& instance : instances) {
+            int x = static_cast<int>(std::floor(instance.positionScale.x + 0.5f));
+            int y = static_cast<int>(std::floor(instance.positionScale.z + 0.5f));
+            if (grid.isWall(x, y)) count++;
+        }
+        return count;
+    }
+}
+
+int main() {
+    const int hardware = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    MazeGrid grid;
+    MazeGenerator generator;
+    generator.generate(grid, {MAZE_SIZE, MAZE_SIZE, MazeAlgorithm::Backtracker, SEED});
+    std::printf("maze %dx%d, %d steps per run\n\n", MAZE_SIZE, MAZE_SIZE, STEPS);
+
+    std::vector<CrowdInstance> instances;
+    for (int threads : {1, hardware}) {
+        Crowd crowd(threads);
+        for (size_t count : COUNTS) {
+            CrowdSettings settings;
+            settings.agents = count;
+            crowd.reset(grid, settings, SEED);
+            instances.resize(count);
+
+            double updateMs = 0.0, instanceMs = 0.0;
+            for (int step = 0; step < STEPS; step++) {
+                auto begin = Clock::now();
+                crowd.update(STEP);
+                updateMs += msSince(begin);
+                begin = Clock::now();
+                crowd.writeInstances(instances.data(), 0.5f, CrowdPlacement{});
+                instanceMs += msSince(begin);
+            }
+            crowd.writeInstances(instances.data(), 1.0f, CrowdPlacement{});
+
+            std::printf("%7zu agents, %d thread(s): update %.3f ms, instances %.3f ms (%.1f MB/frame), "
+                        "%.1f MB state, %zu in walls\n",
+                        count, threads, updateMs / STEPS, instanceMs / STEPS,
+                        count * sizeof(CrowdInstance) / (1024.0 * 1024.0), crowd.bytes() / (1024.0 * 1024.0),
+                        agentsInWalls(grid, instances));
+        }
+        if (threads == hardware) break;
+        std::printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+// maze_bench.cpp
+// Maze generation throughput in cells per second for every algorithm, up to 10001x10001,
+// against the old generator (uchar cv::Mat-like grid, std::stack, shuffle per step).
+// Eller is also run streaming, where only one row is ever held. Last, the chunk streamer
+// follows a long walk, to show update cost and memory don't grow with the distance.
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <random>
+#include <stack>
+#include <vector>
+#include "MazeGenerator.hpp"
+#include "MazeStreamer.hpp"
+#include "bench_util.hpp"
+
+namespace {
+    constexpr int SIZES[] = {1001, 4001, 10001};
+    constexpr std::uint64_t SEED = 1234;
+
+    // The carve App::genLabyrinth used to do, on a byte per grid position
+    void legacyGenerate(std::vector<unsigned char>& map, int size, std::mt19937& gen) {
+        map.assign(static_cast<size_t>(size) * size, '#');
+        auto at = [&](int x, int y) -> unsigned char& { return map[static_cast<size_t>(y) * size + x]; };
+        const int dx[] = {0, 1, 0, -1};
+        const int dy[] = {-1, 0, 1, 0};
+
+        struct Point { int x, y; };
+        std::stack<Point> stack;
+        stack.push({1, 1});
+        at(1, 1) = '.';
+        while (!stack.empty()) {
+            Point current = stack.top();
+            std::array<int, 4> directions = {0, 1, 2, 3};
+            std::shuffle(directions.begin(), directions.end(), gen);
+
+            bool found = false;
+            for (int dir : directions) {
+                int nx = current.x + dx[dir] * 2;
+                int ny = current.y + dy[dir] * 2;
+                if (nx >= 1 && nx < size - 1 && ny >= 1 && ny < size - 1 && at(nx, ny) == '#') {
+                    at(current.x + dx[dir], current.y + dy[dir]) = '.';
+                    at(nx, ny) = '.';
+                    stack.push({nx, ny});
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) stack.pop();
+        }
+    }
+
+    void report(const char* name, int size, double ms, size_t bytes) {
+        double cells = static_cast<double>(size / 2) * (size / 2);
+        std::printf("%-18s %6dx%-6d %10.1f ms %8.1f Mcells/s %10.2f MB\n",
+                    name, size, size, ms, cells / (ms * 1e-3) / 1e6, bytes / (1024.0 * 1024.0));
+    }
+}
+
+int main() {
+    std::printf("%-18s %13s %13s %17s %13s\n", "algorithm", "size", "time", "throughput", "memory");
+    for (int size : SIZES) {
+        {
+            std::mt19937 gen(SEED);
+            std::vector<unsigned char> map;
+            auto start = Clock::now();
+            legacyGenerate(map, size, gen);
+            report("legacy stack", size, msSince(start), map.size());
+        }
+
+        MazeGenerator generator;
+        MazeGrid grid;
+        for (MazeAlgorithm algorithm : {MazeAlgorithm::Backtracker, MazeAlgorithm::Wilson, MazeAlgorithm::Eller}) {
+            MazeSettings settings{size, size, algorithm, SEED};
+            auto start = Clock::now();
+            generator.generate(grid, settings);
+            report(mazeAlgorithmName(algorithm), size, msSince(start), grid.bytes() + generator.scratchBytes());
+        }
+
+        // Rows are consumed and dropped, memory is O(width)
+        MazeGenerator streaming;
+        size_t openPositions = 0;
+        auto start = Clock::now();
+        streaming.streamEller({size, size, MazeAlgorithm::Eller, SEED}, [&](int, const std::uint64_t* row) {
+            openPositions += row[0] & 1u;
+        });
+        report("eller streaming", size, msSince(start), streaming.scratchBytes());
+        (void)openPositions;
+    }
+
+    // Walk 2000 chunks east and back north-west, moving one chunk every few frames. The
+    // workers are given time to catch up outside the timed part, as frame time would.
+    MazeStreamSettings settings;
+    settings.seed = SEED;
+    settings.chunkCells = 8;
+    settings.viewRadius = 2;
+    MazeStreamer streamer(settings);
+    glm::ivec2 focus(0);
+    size_t loaded = 0, evicted = 0;
+    double totalMs = 0.0, worstMs = 0.0;
+    const size_t startBytes = streamer.bytes();
+    const int frames = 12000;
+    for (int frame = 0; frame < frames; frame++) {
+        if (frame % 3 == 0) focus += frame < frames / 2 ? glm::ivec2(1, 0) : glm::ivec2(-1, -1);
+        auto start = Clock::now();
+        streamer.update(focus);
+        double ms = msSince(start);
+        totalMs += ms;
+        worstMs = std::max(worstMs, ms);
+        loaded += streamer.loaded().size();
+        evicted += streamer.evicted().size();
+        streamer.finish();
+    }
+    std::printf("\nstreaming %d frames, %zu chunks loaded, %zu evicted, %zu/%zu resident\n",
+                frames, loaded, evicted, streamer.residentCount(), streamer.capacity());
+    std::printf("update %.2f us mean, %.2f us worst, memory %zu bytes at start, %zu at the end\n",
+                totalMs * 1000.0 / frames, worstMs * 1000.0, startBytes, streamer.bytes());
+    return 0;
+}
@@ -0,0 +1,119 @@
+// nav_bench.cpp
+// Navigation on a 2001x2001 maze: one agent finding its way with jump point search, and
+// 100k agents sharing flow fields, with the fields built serially and in parallel, steering
+// on one thread and on all, and the incremental field repair after walls change.
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+#include "Navigation.hpp"
+#include "bench_util.hpp"
+
+namespace {
+    constexpr int MAZE_SIZE = 2001;
+    constexpr std::uint64_t SEED = 2001;
+    constexpr int PATH_QUERIES = 200;
+    constexpr size_t CROWD = 100000;
+    constexpr int TARGETS = 16;
+    constexpr int STEPS = 100;
+    constexpr float STEP = 1.0f / 120.0f;
+
+    glm::ivec2 randomCell(std::mt19937& rng) {
+        std::uniform_int_distribution<int> cell(0, MAZE_SIZE / 2 - 1);
+        return glm::ivec2(2 * cell(rng) + 1, 2 * cell(rng) + 1);
+    }
+}
+
+int main() {
+    const int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::mt19937 rng(SEED);
+
+    MazeGrid grid;
+    MazeGenerator generator;
+    generator.generate(grid, {MAZE_SIZE, MAZE_SIZE, MazeAlgorithm::Backtracker, SEED});
+    std::printf("maze %dx%d, %d threads\n\n", MAZE_SIZE, MAZE_SIZE, threads);
+
+    // One agent: a path per query
+    JumpPointSearch search;
+    std::vector<glm::ivec2> path;
+    double searchMs = 0.0;
+    size_t expanded = 0, length = 0;
+    for (int i = 0; i < PATH_QUERIES; i++) {
+        glm::ivec2 start = randomCell(rng), goal = randomCell(rng);
+        auto begin = Clock::now();
+        search.findPath(grid, start, goal, path);
+        searchMs += msSince(begin);
+        expanded += search.lastExpanded();
+        length += path.size();
+    }
+    std::printf("1 agent, jump point search: %.2f ms per path, %zu jump points expanded, %zu positions long (mean of %d)\n",
+                searchMs / PATH_QUERIES, expanded / PATH_QUERIES, length / PATH_QUERIES, PATH_QUERIES);
+
+    FlowField single;
+    auto begin = Clock::now();
+    single.build(grid, randomCell(rng));
+    std::printf("1 agent, flow field instead: %.2f ms to build, %.1f MB\n\n", msSince(begin), single.bytes() / (1024.0 * 1024.0));
+
+    // 100k agents split over shared targets
+    std::vector<glm::ivec2> targets;
+    for (int i = 0; i < TARGETS; i++) targets.push_back(randomCell(rng));
+    ThreadPool serial(1), parallel(threads);
+    std::vector<FlowField> fields;
+    begin = Clock::now();
+    FlowField::buildAll(grid, targets, fields, serial);
+    double serialMs = msSince(begin);
+    begin = Clock::now();
+    FlowField::buildAll(grid, targets, fields, parallel);
+    double parallelMs = msSince(begin);
+    std::printf("%d flow fields: %.1f ms on 1 thread, %.1f ms on %d (%.1fx)\n",
+                TARGETS, serialMs, parallelMs, threads, serialMs / parallelMs);
+
+    NavAgents agents;
+    for (size_t i = 0; i < CROWD; i++) {
+        agents.add(glm::vec2(randomCell(rng)), static_cast<std::uint16_t>(i % TARGETS));
+    }
+    SteeringSettings steering;
+    for (ThreadPool* pool : {&serial, &parallel}) {
+        NavAgents crowd = agents;
+        begin = Clock::now();
+        for (int step = 0; step < STEPS; step++) {
+            steerAgentsParallel(crowd, fields, steering, STEP, *pool);
+        }
+        double ms = msSince(begin);
+        std::printf("%zu agents, %d thread(s): %.2f ms per step, %.1f ns per agent\n",
+                    CROWD, pool->size(), ms / STEPS, ms * 1e6 / (static_cast<double>(STEPS) * CROWD));
+    }
+
+    // Walls change: knock through 8 walls between cells and close 8 passages
+    FlowField& field = fields[0];
+    std::vector<glm::ivec2> changed;
+    while (changed.size() < 16) {
+        glm::ivec2 cell = randomCell(rng);
+        glm::ivec2 between = cell + directionOffset(static_cast<std::uint8_t>(rng() % 4));
+        if (between.x <= 0 || between.y <= 0 || between.x >= MAZE_SIZE - 1 || between.y >= MAZE_SIZE - 1) continue;
+        bool wall = grid.isWall(between.x, between.y);
+        if (wall == (changed.size() < 8)) {
+            grid.setWall(between.x, between.y, !wall);
+            changed.push_back(between);
+        }
+    }
+    begin = Clock::now();
+    field.update(grid, changed);
+    double updateMs = msSince(begin);
+    size_t settled = field.lastSettled();
+    FlowField rebuilt;
+    begin = Clock::now();
+    rebuilt.build(grid, field.target());
+    double rebuildMs = msSince(begin);
+
+    size_t mismatches = 0;
+    for (int y = 0; y < MAZE_SIZE; y++) {
+        for (int x = 0; x < MAZE_SIZE; x++) {
+            mismatches += field.distance(x, y) != rebuilt.distance(x, y);
+        }
+    }
+    std::printf("16 walls changed: update %.2f ms (%zu positions settled) vs rebuild %.2f ms, %zu mismatches\n",
+                updateMs, settled, rebuildMs, mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
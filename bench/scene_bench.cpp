@@ -0,0 +1,145 @@
+// scene_bench.cpp
+// Per-frame scene work at 100k entities: the old layout (vector of heap objects, matrices
+// rebuilt on every draw) against the entity store + TransformStore.
+// Each frame: spin 10% of the objects, refresh matrices, frustum cull and build a draw list.
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "Frustum.hpp"
+#include "Scene.hpp"
+#include "TransformStore.hpp"
+#include "bench_util.hpp"
+
+namespace {
+    constexpr int ENTITY_COUNT = 100000;
+    constexpr int FRAMES = 100;
+    constexpr float SPIN_SHARE = 0.1f;
+
+    // Stand-in for the old Model: transform, material and per-draw matrix in one heap object
+    struct LegacyObject {
+        glm::vec3 position{0.0f}, rotation{0.0f}, scale{1.0f};
+        glm::vec3 color{1.0f};
+        float alpha = 1.0f;
+        float boundingRadius = 0.87f;
+        bool spins = false;
+        std::vector<int> meshes = std::vector<int>(4);
+    };
+
+    struct Transform { TransformStore::Id id; };
+    struct Renderable { int model; float radius; };
+    struct Spin { glm::vec3 degreesPerSecond; };
+    using BenchScene = EntityStore<Transform, Renderable, Spin>;
+
+    struct DrawItem {
+        const void* model;
+        const glm::mat4* world;
+    };
+
+    Frustum benchFrustum() {
+        glm::mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 20.0f, 0.0f), glm::vec3(100.0f, 0.0f, 100.0f), glm::vec3(0, 1, 0));
+        return Frustum::fromMatrix(projection * view);
+    }
+}
+
+int main() {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> coord(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    std::vector<glm::vec3> positions(ENTITY_COUNT);
+    std::vector<bool> spins(ENTITY_COUNT);
+    for (int i = 0; i < ENTITY_COUNT; i++) {
+        positions[i] = glm::vec3(coord(rng), unit(rng) * 10.0f, coord(rng));
+        spins[i] = unit(rng) < SPIN_SHARE;
+    }
+    const Frustum frustum = benchFrustum();
+    const float dt = 1.0f / 60.0f;
+    const glm::vec3 spinSpeed(50.0f, 100.0f, 80.0f);
+
+    // Legacy layout
+    std::vector<std::unique_ptr<LegacyObject>> legacy;
+    for (int i = 0; i < ENTITY_COUNT; i++) {
+        auto obj = std::make_unique<LegacyObject>();
+        obj->position = positions[i];
+        obj->spins = spins[i];
+        legacy.push_back(std::move(obj));
+    }
+
+    std::vector<DrawItem> drawList;
+    std::vector<glm::mat4> legacyMatrices;
+    drawList.reserve(ENTITY_COUNT);
+    legacyMatrices.reserve(ENTITY_COUNT);
+
+    auto start = Clock::now();
+    size_t legacyVisible = 0;
+    for (int frame = 0; frame < FRAMES; frame++) {
+        drawList.clear();
+        legacyMatrices.clear();
+        for (auto& obj : legacy) {
+            if (obj->spins) obj->rotation += spinSpeed * dt;
+        }
+        for (auto& obj : legacy) {
+            if (!frustum.intersectsSphere(obj->position, obj->boundingRadius)) continue;
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), obj->position);
+            model = glm::rotate(model, glm::radians(obj->rotation.x), glm::vec3(1, 0, 0));
+            model = glm::rotate(model, glm::radians(obj->rotation.y), glm::vec3(0, 1, 0));
+            model = glm::rotate(model, glm::radians(obj->rotation.z), glm::vec3(0, 0, 1));
+            legacyMatrices.push_back(glm::scale(model, obj->scale));
+            drawList.push_back({obj.get(), &legacyMatrices.back()});
+        }
+        legacyVisible = drawList.size();
+    }
+    double legacyMs = msSince(start) / FRAMES;
+
+    // Entity store
+    TransformStore transforms;
+    BenchScene scene;
+    for (int i = 0; i < ENTITY_COUNT; i++) {
+        Transform transform{transforms.create(positions[i])};
+        if (spins[i]) {
+            scene.create(transform, Renderable{0, 0.87f}, Spin{spinSpeed});
+        } else {
+            scene.create(transform, Renderable{0, 0.87f});
+        }
+    }
+    transforms.updateMatrices();
+
+    start = Clock::now();
+    size_t sceneVisible = 0;
+    double updateMs = 0.0, matrixMs = 0.0, cullMs = 0.0;
+    for (int frame = 0; frame < FRAMES; frame++) {
+        auto phase = Clock::now();
+        scene.each<Transform, Spin>([&](const Transform& transform, const Spin& spin) {
+            transforms.setRotation(transform.id, transforms.rotation(transform.id) + spin.degreesPerSecond * dt);
+        });
+        updateMs += msSince(phase);
+
+        phase = Clock::now();
+        transforms.updateMatrices();
+        matrixMs += msSince(phase);
+
+        phase = Clock::now();
+        drawList.clear();
+        scene.each<Transform, Renderable>([&](const Transform& transform, const Renderable& renderable) {
+            if (frustum.intersectsSphere(transforms.position(transform.id), renderable.radius)) {
+                drawList.push_back({&renderable, &transforms.world(transform.id)});
+            }
+        });
+        cullMs += msSince(phase);
+        sceneVisible = drawList.size();
+    }
+    double sceneMs = msSince(start) / FRAMES;
+
+    std::printf("%d entities, %d frames, %.0f%% spinning\n", ENTITY_COUNT, FRAMES, SPIN_SHARE * 100.0f);
+    std::printf("legacy objects : %8.3f ms/frame (%zu visible)\n", legacyMs, legacyVisible);
+    std::printf("entity store   : %8.3f ms/frame (%zu visible, %zu archetypes)\n",
+                sceneMs, sceneVisible, scene.archetypeCount());
+    std::printf("  update %.3f ms, matrices %.3f ms, cull + list %.3f ms\n",
+                updateMs / FRAMES, matrixMs / FRAMES, cullMs / FRAMES);
+    std::printf("speedup        : %8.2fx\n", legacyMs / sceneMs);
+    return 0;
+}
@@ -0,0 +1,88 @@
+// terrain_bench.cpp
+// Terrain mesh generation on synthetic heightmaps: the original layout (four vertices with a
+// flat normal per quad, 32-bit indices) against shared-vertex chunks with 16-bit indices,
+// built on one thread and on all. Memory is what the mesh data takes on the CPU while
+// building, and what the GPU buffers take after upload.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "TerrainMeshBuilder.hpp"
+#include "bench_util.hpp"
+
+namespace {
+    constexpr int SIZES[] = {1024, 4096};
+    constexpr int STEP = 2;
+
+    double megabytes(size_t bytes) { return bytes / (1024.0 * 1024.0); }
+
+    struct LegacyVertex {
+        glm::vec3 position, normal;
+        glm::vec2 texcoord;
+    };
+
+    // The loop App::generateHeightMap used to run
+    size_t buildLegacy(const TerrainQuery& terrain, int step) {
+        std::vector<LegacyVertex> vertices;
+        std::vector<std::uint32_t> indices;
+        const TerrainLayout& layout = terrain.layout();
+        auto point = [&](int x, int z) {
+            return glm::vec3(layout.origin.x + x * layout.worldScale, terrain.texelHeight(x, z),
+                             layout.origin.y + z * layout.worldScale);
+        };
+        auto uv = [&](int x, int z) {
+            return glm::vec2(static_cast<float>(x) / terrain.columns(), static_cast<float>(z) / terrain.rows()) * 15.0f;
+        };
+        std::uint32_t index = 0;
+        for (int z = 0; z < terrain.rows() - step; z += step) {
+            for (int x = 0; x < terrain.columns() - step; x += step) {
+                glm::vec3 p0 = point(x, z), p1 = point(x + step, z), p2 = point(x + step, z + step), p3 = point(x, z + step);
+                glm::vec3 normal = glm::normalize(glm::cross(p2 - p0, p1 - p0));
+                vertices.push_back({p0, normal, uv(x, z)});
+                vertices.push_back({p1, normal, uv(x + step, z)});
+                vertices.push_back({p2, normal, uv(x + step, z + step)});
+                vertices.push_back({p3, normal, uv(x, z + step)});
+                indices.insert(indices.end(), {index, index + 1, index + 2, index, index + 2, index + 3});
+                index += 4;
+            }
+        }
+        return vertices.size() * sizeof(LegacyVertex) + indices.size() * sizeof(std::uint32_t);
+    }
+}
+
+int main() {
+    const int hardware = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (int size : SIZES) {
+        std::vector<std::uint8_t> heights(static_cast<size_t>(size) * size);
+        for (int z = 0; z < size; z++) {
+            for (int x = 0; x < size; x++) {
+                heights[static_cast<size_t>(z) * size + x] =
+                    static_cast<std::uint8_t>(127.5f + 127.0f * std::sin(x * 0.011f) * std::cos(z * 0.017f));
+            }
+        }
+        TerrainQuery terrain;
+        terrain.build(heights.data(), size, size, size, TerrainLayout::centered(size, size, 0.2f, 20.0f / 255.0f));
+
+        auto begin = Clock::now();
+        const size_t legacyBytes = buildLegacy(terrain, STEP);
+        const double legacyMs = msSince(begin);
+        std::printf("%dx%d, step %d\n", size, size, STEP);
+        std::printf("  original: %.1f ms, %.1f MB (kept on the CPU and again on the GPU)\n",
+                    legacyMs, megabytes(legacyBytes));
+
+        for (int threads : {1, hardware}) {
+            TerrainMeshSettings settings;
+            settings.step = STEP;
+            settings.threads = threads;
+            begin = Clock::now();
+            TerrainMeshData mesh = buildTerrainMesh(terrain, settings);
+            const double ms = msSince(begin);
+            std::printf("  chunked, %d thread(s): %.1f ms, %.1f MB (%zu vertices, %zu indices, %zu chunks), %.1fx smaller\n",
+                        threads, ms, megabytes(mesh.bytes()), mesh.vertices.size(), mesh.indices.size(),
+                        mesh.chunks.size(), static_cast<double>(legacyBytes) / mesh.bytes());
+            if (threads == hardware) break;
+        }
+    }
+    return 0;
+}
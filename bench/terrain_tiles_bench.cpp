@@ -0,0 +1,91 @@
+// terrain_tiles_bench.cpp
+// Out-of-core terrain: writes a synthetic heightfield (32768x32768 unless a side is given)
+// as a tiles file, then flies a camera across it with the tile cache streaming around it,
+// timing the page-ins and height queries and comparing the memory held with what the
+// in-memory TerrainQuery would need for the same terrain.
+//   terrain_tiles_bench [side] [path]
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "TerrainLod.hpp"
+#include "TerrainTileCache.hpp"
+#include "bench_util.hpp"
+
+namespace {
+    constexpr int DEFAULT_SIDE = 32768;
+    constexpr int RADIUS = 4;
+    constexpr int FRAMES = 2000;
+    constexpr float SPEED = 2.0f; // world units per frame
+    constexpr int QUERIES = 1000; // height queries per frame, around the camera
+
+    double megabytes(double bytes) { return bytes / (1024.0 * 1024.0); }
+
+    std::uint16_t synthetic(int x, int z) {
+        const float h = std::sin(x * 0.0021f) * std::cos(z * 0.0017f) * 0.6f + std::sin((x + z) * 0.013f) * 0.15f;
+        return static_cast<std::uint16_t>(32767.5f + 32767.0f * std::clamp(h, -1.0f, 1.0f));
+    }
+}
+
+int main(int argc, char** argv) {
+    const int side = argc > 1 ? std::max(std::atoi(argv[1]), 2) : DEFAULT_SIDE;
+    const std::string path = argc > 2 ? argv[2] : "terrain_bench.pgt";
+    const TerrainLayout layout = TerrainLayout::centered(side, side, 0.2f, 200.0f / 65535.0f);
+
+    auto start = Clock::now();
+    writeTerrainTiles(path, side, side, layout, {}, [side](int z, std::uint16_t* row) {
+        for (int x = 0; x < side; x++) row[x] = synthetic(x, z);
+    });
+    const double writeMs = msSince(start);
+
+    TerrainTiles tiles;
+    tiles.open(path);
+    std::printf("%dx%d samples, %dx%d tiles of %d: written in %.1f s, %.1f MB on disk\n", side, side,
+                tiles.tilesX(), tiles.tilesZ(), tiles.tileSize(), writeMs / 1000.0, megabytes(tiles.fileBytes()));
+
+    start = Clock::now();
+    TerrainLod lod;
+    lod.build(tiles, TerrainLodSettings{});
+    std::printf("  CDLOD from the pyramid: %.1f ms, %d levels, %.1f MB\n", msSince(start), lod.levelCount(),
+                megabytes(lod.bytes()));
+
+    // Fly diagonally from one corner, streaming a page-in per frame, then querying around
+    TerrainTileCache cache(tiles, RADIUS);
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> around(-100.0f, 100.0f);
+    glm::vec2 camera = layout.origin + glm::vec2(50.0f);
+    double updateMs = 0.0, worstUpdateMs = 0.0, queryMs = 0.0;
+    float checksum = 0.0f;
+    start = Clock::now();
+    for (int frame = 0; frame < FRAMES; frame++) {
+        camera += glm::vec2(SPEED * 0.7071f);
+        auto updateStart = Clock::now();
+        cache.update(camera);
+        const double ms = msSince(updateStart);
+        updateMs += ms;
+        worstUpdateMs = std::max(worstUpdateMs, ms);
+
+        auto queryStart = Clock::now();
+        for (int i = 0; i < QUERIES; i++) checksum += cache.height(camera.x + around(rng), camera.y + around(rng));
+        queryMs += msSince(queryStart);
+    }
+    const double flightMs = msSince(start);
+    const size_t queries = cache.hits() + cache.misses();
+    std::printf("  flight of %d frames over %.0f world units: %.1f ms\n", FRAMES, FRAMES * SPEED, flightMs);
+    std::printf("    cache update %.3f ms/frame (worst %.3f), %zu resident, %zu loading at the end\n",
+                updateMs / FRAMES, worstUpdateMs, cache.residentCount(), cache.pendingCount());
+    std::printf("    height queries %.1f ns each, %.2f%% from resident tiles (checksum %.1f)\n",
+                queryMs * 1e6 / queries, 100.0 * cache.hits() / queries, checksum);
+
+    // What stays in memory: cache, overview, pyramid and LOD tree; in memory the same
+    // terrain would be a float per sample plus the max-mip levels (a third more)
+    const double overviewBytes = static_cast<double>(tiles.overviewColumns()) * tiles.overviewRows() * sizeof(std::uint16_t);
+    const double heldBytes = cache.bytes() + overviewBytes + lod.bytes();
+    const double inMemoryBytes = static_cast<double>(side) * side * sizeof(float) * 4.0 / 3.0;
+    std::printf("  held: %.1f MB (cache %.1f, overview %.1f) vs %.1f MB for an in-memory TerrainQuery\n",
+                megabytes(heldBytes), megabytes(cache.bytes()), megabytes(overviewBytes), megabytes(inMemoryBytes));
+    return 0;
+}
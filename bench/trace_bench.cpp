@@ -0,0 +1,74 @@
+// trace_bench.cpp
+// Cost of a TRACE_SCOPE with tracing off and on, against an empty loop with the same
+// side effect, then four threads recording at once and a write of everything they left.
+//   trace_bench [scopes] [path]
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Trace.hpp"
+#include "bench_util.hpp"
+
+namespace {
+    constexpr int DEFAULT_SCOPES = 1000000;
+    constexpr int THREADS = 4;
+
+    // Keeps the loops from being optimized away
+    volatile int sink = 0;
+
+    double nsPerScope(int scopes, bool traced) {
+        const auto start = Clock::now();
+        for (int i = 0; i < scopes; i++) {
+            if (traced) {
+                TRACE_SCOPE("bench scope");
+                sink = sink + 1;
+            } else {
+                sink = sink + 1;
+            }
+        }
+        return msSince(start) * 1e6 / scopes;
+    }
+}
+
+int main(int argc, char** argv) {
+    const int scopes = argc > 1 ? std::max(std::atoi(argv[1]), 1) : DEFAULT_SCOPES;
+    const std::string path = argc > 2 ? argv[2] : "trace_bench.json";
+#ifndef PG2_TRACING
+    std::printf("Built without PG2_TRACING, TRACE_SCOPE compiles to nothing\n");
+#endif
+
+    // Scopes per thread stay under the per-thread limit, 2 events each
+    const int recorded = std::min<int>(scopes, static_cast<int>(Trace::MAX_EVENTS_PER_THREAD / 2));
+    const double baseline = nsPerScope(scopes, false);
+    Trace::setEnabled(false);
+    const double disabled = nsPerScope(scopes, true);
+    Trace::setEnabled(true);
+    Trace::setThreadName("bench main");
+    const double enabled = nsPerScope(recorded, true);
+    std::printf("%d scopes: empty loop %.2f ns, tracing off %.2f ns (+%.2f), on %.2f ns per scope\n", scopes,
+                baseline, disabled, disabled - baseline, enabled);
+
+    auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([recorded] {
+            Trace::setThreadName("bench worker");
+            for (int i = 0; i < recorded; i++) {
+                TRACE_SCOPE("worker scope");
+                if ((i & 1023) == 0) TRACE_COUNTER("worker progress", i);
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    const double threadedMs = msSince(start);
+    std::printf("  %d threads x %d scopes: %.1f ms, %.2f ns per scope and thread\n", THREADS, recorded, threadedMs,
+                threadedMs * 1e6 / recorded);
+
+    const size_t events = Trace::eventCount();
+    start = Clock::now();
+    Trace::write(path);
+    std::printf("  %zu events (%zu dropped) written in %.1f ms\n", events, Trace::droppedCount(), msSince(start));
+    return EXIT_SUCCESS;
+}
@@ -3,15 +3,23 @@
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoord;
+#ifdef INSTANCED
+flat in vec4 InstanceColor;
+#endif
 
 out vec4 FragColor;
 
-// Material properties
-uniform float alpha = 1.0;
-uniform sampler2D texture0;
-uniform sampler2D diffuseTexture;
-uniform int useTexture;
-uniform vec3 objectColor = vec3(1.0, 0.5, 0.2);
+// Variant switches, injected as #defines by ShaderVariants:
+//   NUM_POINT_LIGHTS  - point lights evaluated, picked through pointLightIndices
+//   INSTANCED         - placement and a color multiplier per instance (basic.vert)
+//   ALPHA_TEST        - discard (nearly) transparent fragments, only for MATERIAL_ALPHA_TEST
+//                       materials so every other program keeps early depth testing
+
+#include "frame_data.glsl"
+#include "materials.glsl"
+
+// Row of the material table this draw uses
+uniform int materialId;
 
 // Directional light Sun
 struct DirLight {
@@ -20,10 +28,12 @@ struct DirLight {
     vec3 diffuse;
     vec3 specular;
 };
-uniform DirLight dirLight;
 
 // Point lights
 #define NR_POINT_LIGHTS 3
+#ifndef NUM_POINT_LIGHTS
+#define NUM_POINT_LIGHTS NR_POINT_LIGHTS
+#endif
 struct PointLight {
     vec3 position;
     vec3 ambient;
@@ -33,7 +43,6 @@ struct PointLight {
     float linear;
     float quadratic;
 };
-uniform PointLight pointLights[NR_POINT_LIGHTS];
 
 // Spot light
 struct SpotLight {
@@ -48,9 +57,18 @@ struct SpotLight {
     float linear;
     float quadratic;
 };
-uniform SpotLight spotLight;
 
-uniform vec3 viewPos;
+// All lights in one std140 block (mirrored by LightUniforms in FrameUniforms.hpp)
+layout(std140, binding = 1) uniform LightData {
+    DirLight dirLight;
+    PointLight pointLights[NR_POINT_LIGHTS];
+    SpotLight spotLight;
+};
+
+#if NUM_POINT_LIGHTS > 0
+// Lights that reach this object, chosen per draw
+uniform int pointLightIndices[NUM_POINT_LIGHTS];
+#endif
 
 // Function prototypes
 vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);
@@ -58,10 +76,21 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
 vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
 
 void main() {
-    // Common calculations
-    vec4 texColor = texture(texture0, TexCoord);
-    float finalAlpha = texColor.a * alpha;
+    // Base color, materialId is the same for the whole draw so the branches are uniform
+    Material material = materials[materialId];
+    vec4 base = material.baseColor;
+    if (material.textureArray >= 0) {
+        base *= texture(materialTextures[material.textureArray], vec3(TexCoord, material.layer));
+    }
+#ifdef INSTANCED
+    base *= InstanceColor;
+#endif
+    vec3 baseColor = base.rgb;
+    float finalAlpha = base.a;
+
+#ifdef ALPHA_TEST
     if (finalAlpha <= 0.01) discard;
+#endif
 
     vec3 norm = normalize(Normal);
     vec3 viewDir = normalize(viewPos - FragPos);
@@ -73,14 +102,15 @@ void main() {
     result += CalcDirLight(dirLight, norm, viewDir);
 
     // Point lights
-    for(int i = 0; i < NR_POINT_LIGHTS; i++)
-    result += CalcPointLight(pointLights[i], norm, FragPos, viewDir);
+#if NUM_POINT_LIGHTS > 0
+    for(int i = 0; i < NUM_POINT_LIGHTS; i++)
+    result += CalcPointLight(pointLights[pointLightIndices[i]], norm, FragPos, viewDir);
+#endif
 
     // Spot light
     result += CalcSpotLight(spotLight, norm, FragPos, viewDir);
 
     // Apply texture/color
-    vec3 baseColor = useTexture == 1 ? texColor.rgb : objectColor;
     FragColor = vec4(result * baseColor, finalAlpha);
 }
 
@@ -9,12 +9,35 @@ out vec3 Normal;
 out vec2 TexCoord;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform mat3 normalMatrix; // transpose(inverse(mat3(model))), computed on the CPU
+
+#include "frame_data.glsl"
+
+#ifdef INSTANCED
+// One entry per instance, mirrored by CrowdInstance in Crowd.hpp. Instances are only
+// translated and uniformly scaled, so the normal needs no matrix.
+struct Instance {
+    vec4 positionScale;
+    vec4 color;
+};
+
+layout(std430, binding = 3) readonly buffer Instances {
+    Instance instances[];
+};
+
+flat out vec4 InstanceColor;
+#endif
 
 void main() {
+#ifdef INSTANCED
+    Instance instance = instances[gl_InstanceID];
+    FragPos = aPos * instance.positionScale.w + instance.positionScale.xyz;
+    Normal = aNormal;
+    InstanceColor = instance.color;
+#else
     FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal; // Proper normal transformation
+    Normal = normalMatrix * aNormal;
+#endif
     TexCoord = aTexCoord;
 
     gl_Position = projection * view * vec4(FragPos, 1.0);
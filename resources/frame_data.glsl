@@ -0,0 +1,6 @@
+// Per-frame camera data, streamed by the application (CameraUniforms in FrameUniforms.hpp)
+layout(std140, binding = 0) uniform CameraData {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
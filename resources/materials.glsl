@@ -0,0 +1,18 @@
+// Material table, mirrored by GpuMaterial in MaterialTable.hpp
+#define MAX_MATERIAL_TEXTURE_ARRAYS 8
+#define MATERIAL_ALPHA_TEST 1u
+
+struct Material {
+    vec4 baseColor;   // rgb multiplies the texture, a is the material alpha
+    int textureArray; // index into materialTextures, -1 if untextured
+    int layer;        // current layer (animation frame) in that array
+    uint flags;
+    int _pad;
+};
+
+layout(std430, binding = 2) readonly buffer MaterialData {
+    Material materials[];
+};
+
+// One array per texture format/size, bound to units 0..N-1
+layout(binding = 0) uniform sampler2DArray materialTextures[MAX_MATERIAL_TEXTURE_ARRAYS];
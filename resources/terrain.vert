@@ -0,0 +1,49 @@
+#version 460 core
+
+// CDLOD terrain: one patch mesh instanced over the quadtree nodes TerrainLod selected,
+// displaced by the height texture. Outputs match basic.vert, so basic.frag shades it.
+
+layout(location = 0) in vec3 aPos; // patch grid position, xz in [0, 1]
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+
+#include "frame_data.glsl"
+
+// Mirrored by TerrainLodHeader/TerrainLodNode in TerrainLod.hpp
+struct TerrainNode {
+    vec4 placement; // world xz of the corner, world size, level
+    vec4 morph;     // distances where morphing starts and ends, quads per side
+};
+
+layout(std430, binding = 3) readonly buffer TerrainNodes {
+    vec4 terrainLayout; // world xz of texel (0, 0), world units per texel, world units per texture unit
+    vec4 terrainExtent; // columns, rows, base height, texture tiling
+    TerrainNode nodes[];
+};
+
+#include "terrain_height.glsl"
+
+void main() {
+    TerrainNode node = nodes[gl_InstanceID];
+    float size = node.placement.z;
+    float quads = node.morph.z;
+    vec2 world = node.placement.xy + aPos.xz * size;
+
+    // Towards the end of the node's range, odd grid vertices slide onto their even
+    // neighbours, which turns the grid into the next level's by the time it takes over
+    float cameraDistance = distance(viewPos, vec3(world.x, terrainHeight(world), world.y));
+    float morph = clamp((cameraDistance - node.morph.x) / (node.morph.y - node.morph.x), 0.0, 1.0);
+    vec2 odd = mod(round(aPos.xz * quads), 2.0);
+    world -= odd / quads * size * morph;
+
+    // Nodes overhanging the heightmap fold onto its edge
+    world = terrainClamp(world);
+
+    FragPos = vec3(world.x, terrainHeight(world), world.y);
+    Normal = terrainNormal(world);
+    TexCoord = terrainTexCoord(world);
+
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,47 @@
+// Height texture lookups shared by the terrain shaders. The including shader declares
+// terrainLayout and terrainExtent (the header of its terrain buffer, TerrainLodHeader
+// in TerrainLod.hpp) before including this.
+
+// TERRAIN_HEIGHT_TEXTURE_UNIT and TERRAIN_WINDOW_TEXTURE_UNIT in FrameUniforms.hpp
+layout(binding = 8) uniform sampler2D heightMap;
+layout(binding = 9) uniform sampler2D heightWindow;
+
+// TerrainWindowUniforms in FrameUniforms.hpp. For a tiled terrain heightMap is the overview,
+// every info.z-th sample, and heightWindow holds the tiles around the camera at their
+// coordinates modulo its size (TerrainTileCache), valid within rect.
+layout(std140, binding = 2) uniform TerrainWindow {
+    vec4 windowRect; // min x, min z, max x, max z in samples; empty when max < min
+    vec4 windowInfo; // window texture size, blend width in samples, overview step
+};
+
+float terrainHeight(vec2 world) {
+    vec2 texel = (world - terrainLayout.xy) / terrainLayout.z;
+    float height = texture(heightMap, (texel / windowInfo.z + 0.5) / vec2(textureSize(heightMap, 0))).r;
+
+    // Full resolution where resident, fading into the overview towards the window's edge
+    vec2 inside = min(texel - windowRect.xy, windowRect.zw - texel);
+    float detail = clamp(min(inside.x, inside.y) / windowInfo.y, 0.0, 1.0);
+    if (detail > 0.0) {
+        height = mix(height, texture(heightWindow, (texel + 0.5) / windowInfo.x).r, detail);
+    }
+    return terrainExtent.z + height * terrainLayout.w;
+}
+
+// Central differences one texel apart, detail independent of the mesh density
+vec3 terrainNormal(vec2 world) {
+    float step = terrainLayout.z;
+    float left = terrainHeight(world - vec2(step, 0.0));
+    float right = terrainHeight(world + vec2(step, 0.0));
+    float back = terrainHeight(world - vec2(0.0, step));
+    float front = terrainHeight(world + vec2(0.0, step));
+    return normalize(vec3(left - right, 2.0 * step, back - front));
+}
+
+vec2 terrainTexCoord(vec2 world) {
+    return (world - terrainLayout.xy) / terrainLayout.z / terrainExtent.xy * terrainExtent.w;
+}
+
+// Points past the heightmap fold onto its edge
+vec2 terrainClamp(vec2 world) {
+    return clamp(world, terrainLayout.xy, terrainLayout.xy + (terrainExtent.xy - 1.0) * terrainLayout.z);
+}
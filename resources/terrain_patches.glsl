@@ -0,0 +1,10 @@
+// Buffer of the tessellated terrain, mirrored by TerrainTessellationHeader in
+// TerrainTessellation.hpp, followed by the height bounds of every patch
+layout(std430, binding = 3) readonly buffer TerrainPatches {
+    vec4 terrainLayout; // world xz of texel (0, 0), world units per texel, world units per texture unit
+    vec4 terrainExtent; // columns, rows, base height, texture tiling
+    vec4 tessellation;  // target edge length in pixels, viewport height, max level, detail kept on flat ground
+    vec2 patchHeights[]; // min, max
+};
+
+#include "terrain_height.glsl"
@@ -0,0 +1,14 @@
+#version 460 core
+
+// Tessellated terrain: patch corners pass through, terrain.tesc picks the detail
+
+layout(location = 0) in vec3 aPos;      // corner world position, xz used
+layout(location = 2) in vec2 aTexCoord; // x: roughness of the patches around the corner, [0, 1]
+
+out vec2 vWorld;
+out float vRoughness;
+
+void main() {
+    vWorld = aPos.xz;
+    vRoughness = aTexCoord.x;
+}
@@ -0,0 +1,85 @@
+// AllocationCounter.cpp
+#include "AllocationCounter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<std::uint64_t> g_allocations{0};
+
+    void* countedAlloc(std::size_t size) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        if (size == 0) size = 1;
+        return std::malloc(size);
+    }
+
+    void* countedAlignedAlloc(std::size_t size, std::align_val_t alignment) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        auto align = static_cast<std::size_t>(alignment);
+        // aligned_alloc wants the size to be a multiple of the alignment
+        size = (size + align - 1) / align * align;
+        if (size == 0) size = align;
+#ifdef _WIN32
+        return _aligned_malloc(size, align);
+#else
+        return std::aligned_alloc(align, size);
+#endif
+    }
+
+    void alignedFree(void* ptr) {
+#ifdef _WIN32
+        _aligned_free(ptr);
+#else
+        std::free(ptr);
+#endif
+    }
+}
+
+std::uint64_t AllocationCounter::total() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+void AllocationCounter::beginFrame() {
+    std::uint64_t now = total();
+    s_lastFrame = now - s_frameStart;
+    if (s_lastFrame > s_peakFrame) s_peakFrame = s_lastFrame;
+    s_frameStart = now;
+}
+
+// Replacement global allocation functions
+void* operator new(std::size_t size) {
+    if (void* ptr = countedAlloc(size)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* ptr = countedAlloc(size)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* ptr = countedAlignedAlloc(size, alignment)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    if (void* ptr = countedAlignedAlloc(size, alignment)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { alignedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { alignedFree(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { alignedFree(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { alignedFree(ptr); }
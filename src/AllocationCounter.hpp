@@ -0,0 +1,21 @@
+// AllocationCounter.hpp
+#pragma once
+
+#include <cstdint>
+
+// Counts every heap allocation made through global operator new (the replacement
+// operators live in AllocationCounter.cpp). The main loop calls beginFrame() once per
+// frame, after which lastFrame() reports how many allocations the previous frame made.
+class AllocationCounter {
+public:
+    static std::uint64_t total();
+    static void beginFrame();
+    static std::uint64_t lastFrame() { return s_lastFrame; }
+    static std::uint64_t peakFrame() { return s_peakFrame; }
+    static void resetPeak() { s_peakFrame = 0; }
+
+private:
+    static inline std::uint64_t s_frameStart = 0;
+    static inline std::uint64_t s_lastFrame = 0;
+    static inline std::uint64_t s_peakFrame = 0;
+};
@@ -0,0 +1,117 @@
+// Benchmark.cpp
+#include "Benchmark.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+CameraPath CameraPath::fromJson(const nlohmann::json& keys) {
+    if (!keys.is_array() || keys.empty()) {
+        throw std::runtime_error("Camera path must be a non-empty array of keys");
+    }
+    CameraPath path;
+    for (const nlohmann::json& key : keys) {
+        const nlohmann::json& position = key.at("position");
+        CameraKey parsed{key.at("time").get<float>(),
+                         glm::vec3(position.at(0).get<float>(), position.at(1).get<float>(), position.at(2).get<float>()),
+                         key.value("yaw", 0.0f), key.value("pitch", 0.0f)};
+        if (!path.m_keys.empty() && parsed.time <= path.m_keys.back().time) {
+            throw std::runtime_error("Camera path key times must increase");
+        }
+        path.m_keys.push_back(parsed);
+    }
+    return path;
+}
+
+nlohmann::json CameraPath::toJson() const {
+    nlohmann::json keys = nlohmann::json::array();
+    for (const CameraKey& key : m_keys) {
+        keys.push_back({{"time", key.time},
+                        {"position", {key.position.x, key.position.y, key.position.z}},
+                        {"yaw", key.yaw},
+                        {"pitch", key.pitch}});
+    }
+    return keys;
+}
+
+void CameraPath::add(const CameraKey& key) {
+    if (m_keys.empty() || key.time > m_keys.back().time) m_keys.push_back(key);
+}
+
+CameraKey CameraPath::sample(float time) const {
+    if (m_keys.empty()) return {time};
+    if (time <= m_keys.front().time) return {time, m_keys.front().position, m_keys.front().yaw, m_keys.front().pitch};
+    if (time >= m_keys.back().time) return {time, m_keys.back().position, m_keys.back().yaw, m_keys.back().pitch};
+
+    // Segment [i, i + 1] holding time, with its neighbours for the spline's tangents
+    const size_t i = static_cast<size_t>(std::upper_bound(m_keys.begin(), m_keys.end(), time,
+        [](float t, const CameraKey& key) { return t < key.time; }) - m_keys.begin()) - 1;
+    const CameraKey& a = m_keys[i];
+    const CameraKey& b = m_keys[i + 1];
+    const glm::vec3& before = m_keys[i > 0 ? i - 1 : i].position;
+    const glm::vec3& after = m_keys[std::min(i + 2, m_keys.size() - 1)].position;
+    const float t = (time - a.time) / (b.time - a.time);
+    const float t2 = t * t, t3 = t2 * t;
+
+    CameraKey pose;
+    pose.time = time;
+    pose.position = 0.5f * (2.0f * a.position + (b.position - before) * t +
+                            (2.0f * before - 5.0f * a.position + 4.0f * b.position - after) * t2 +
+                            (3.0f * a.position - before - 3.0f * b.position + after) * t3);
+    float turn = b.yaw - a.yaw;
+    turn -= 360.0f * std::round(turn / 360.0f);
+    pose.yaw = a.yaw + turn * t;
+    pose.pitch = a.pitch + (b.pitch - a.pitch) * t;
+    return pose;
+}
+
+TimingSummary TimingSummary::of(std::vector<double> values) {
+    TimingSummary summary;
+    summary.count = values.size();
+    if (values.empty()) return summary;
+
+    std::sort(values.begin(), values.end());
+    auto percentile = [&](double p) {
+        const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * values.size()));
+        return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+    };
+    summary.mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+    summary.p50 = percentile(50.0);
+    summary.p95 = percentile(95.0);
+    summary.p99 = percentile(99.0);
+    summary.min = values.front();
+    summary.max = values.back();
+    return summary;
+}
+
+nlohmann::json TimingSummary::toJson() const {
+    return {{"count", count}, {"mean", mean}, {"p50", p50}, {"p95", p95}, {"p99", p99}, {"min", min}, {"max", max}};
+}
+
+nlohmann::json benchmarkReport(const std::vector<FrameSample>& frames, const nlohmann::json& settings, bool perFrame) {
+    std::vector<double> cpu, gpu, draws, triangles;
+    cpu.reserve(frames.size());
+    draws.reserve(frames.size());
+    triangles.reserve(frames.size());
+    for (const FrameSample& frame : frames) {
+        cpu.push_back(frame.cpuMs);
+        if (frame.gpuMs >= 0.0) gpu.push_back(frame.gpuMs);
+        draws.push_back(static_cast<double>(frame.drawCalls));
+        triangles.push_back(static_cast<double>(frame.triangles));
+    }
+
+    nlohmann::json report = {{"settings", settings},
+                             {"frames", frames.size()},
+                             {"cpu_ms", TimingSummary::of(cpu).toJson()},
+                             {"gpu_ms", TimingSummary::of(gpu).toJson()},
+                             {"draw_calls", TimingSummary::of(draws).toJson()},
+                             {"triangles", TimingSummary::of(triangles).toJson()}};
+    if (perFrame) {
+        nlohmann::json samples = nlohmann::json::array();
+        for (const FrameSample& frame : frames) {
+            samples.push_back({frame.cpuMs, frame.gpuMs, frame.drawCalls, frame.triangles});
+        }
+        report["per_frame"] = {{"columns", {"cpu_ms", "gpu_ms", "draw_calls", "triangles"}}, {"samples", samples}};
+    }
+    return report;
+}
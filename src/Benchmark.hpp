@@ -0,0 +1,63 @@
+// Benchmark.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <nlohmann/json.hpp>
+
+// One camera pose of a path; yaw and pitch in degrees like Camera
+struct CameraKey {
+    float time = 0.0f; // seconds from the start of the path
+    glm::vec3 position = glm::vec3(0.0f);
+    float yaw = 0.0f;
+    float pitch = 0.0f;
+};
+
+// Camera keyframes played back by time: positions on a Catmull-Rom spline through the
+// keys, yaw and pitch interpolated linearly (yaw the short way round). Paths are either
+// scripted in JSON or recorded from a live session.
+class CameraPath {
+public:
+    // Array of {"time": s, "position": [x, y, z], "yaw": deg, "pitch": deg}, times increasing.
+    // Throws std::runtime_error (or nlohmann::json's exceptions) on malformed input.
+    static CameraPath fromJson(const nlohmann::json& keys);
+    nlohmann::json toJson() const;
+
+    // Appends a key, ignored unless later than the last one
+    void add(const CameraKey& key);
+    void clear() { m_keys.clear(); }
+
+    // Pose at time, held at the first and last keys outside the path
+    CameraKey sample(float time) const;
+
+    bool empty() const { return m_keys.empty(); }
+    size_t size() const { return m_keys.size(); }
+    float duration() const { return m_keys.empty() ? 0.0f : m_keys.back().time - m_keys.front().time; }
+
+private:
+    std::vector<CameraKey> m_keys;
+};
+
+// What one measured frame cost and drew
+struct FrameSample {
+    double cpuMs = 0.0;      // frame loop iteration on the CPU
+    double gpuMs = -1.0;     // GPU time of the frame's commands, negative if not measured
+    std::uint64_t drawCalls = 0;
+    std::uint64_t triangles = 0; // primitives generated, tessellated ones included
+};
+
+// Mean and nearest-rank percentiles of a set of values
+struct TimingSummary {
+    size_t count = 0;
+    double mean = 0.0, p50 = 0.0, p95 = 0.0, p99 = 0.0, min = 0.0, max = 0.0;
+
+    static TimingSummary of(std::vector<double> values);
+    nlohmann::json toJson() const;
+};
+
+// Report of a benchmark run: CPU and GPU frame-time summaries, draw calls and triangles
+// per frame, next to the settings the caller describes the run with. perFrame adds
+// every sample, for plotting.
+nlohmann::json benchmarkReport(const std::vector<FrameSample>& frames, const nlohmann::json& settings, bool perFrame);
@@ -0,0 +1,327 @@
+// CollisionWorld.cpp
+#include "CollisionWorld.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    // Gap kept between a moved circle and the surface it stopped at, so rounding never
+    // leaves it overlapping and the slide that follows starts free
+    constexpr float CONTACT_SKIN = 1e-4f;
+
+    // Entry of center + motion * t into a box, the straight part of the grown box
+    bool segmentVsBox(const glm::vec2& center, const glm::vec2& motion, const glm::vec2& boxMin,
+                      const glm::vec2& boxMax, SweepHit& hit) {
+        float enter = -std::numeric_limits<float>::infinity();
+        float exit = std::numeric_limits<float>::infinity();
+        glm::vec2 normal(0.0f);
+        for (int axis = 0; axis < 2; axis++) {
+            if (motion[axis] == 0.0f) {
+                // Moving along a face (or beside the box) never enters it
+                if (center[axis] <= boxMin[axis] || center[axis] >= boxMax[axis]) return false;
+                continue;
+            }
+            float t0 = (boxMin[axis] - center[axis]) / motion[axis];
+            float t1 = (boxMax[axis] - center[axis]) / motion[axis];
+            float side = -1.0f;
+            if (t0 > t1) {
+                std::swap(t0, t1);
+                side = 1.0f;
+            }
+            if (t0 > enter) {
+                enter = t0;
+                normal = glm::vec2(0.0f);
+                normal[axis] = side;
+            }
+            exit = std::min(exit, t1);
+        }
+        if (enter >= exit || enter < 0.0f || enter > 1.0f) return false;
+        hit.time = enter;
+        hit.normal = normal;
+        return true;
+    }
+
+    // Entry of center + motion * t into a circle, the rounded corners of the grown box
+    bool segmentVsCircle(const glm::vec2& center, const glm::vec2& motion, const glm::vec2& circleCenter,
+                         float radius, SweepHit& hit) {
+        glm::vec2 offset = center - circleCenter;
+        float b = glm::dot(offset, motion);
+        if (b >= 0.0f) return false; // moving away or tangent
+        float a = glm::dot(motion, motion);
+        float c = glm::dot(offset, offset) - radius * radius;
+        float discriminant = b * b - a * c;
+        if (discriminant < 0.0f) return false;
+        float t = (-b - std::sqrt(discriminant)) / a;
+        if (t < 0.0f || t > 1.0f) return false;
+        hit.time = t;
+        hit.normal = (offset + motion * t) / radius;
+        return true;
+    }
+}
+
+bool circleVsBox(const glm::vec2& center, float radius, const glm::vec2& boxMin, const glm::vec2& boxMax,
+                 CollisionHit* hit) {
+    glm::vec2 closest = glm::clamp(center, boxMin, boxMax);
+    glm::vec2 offset = center - closest;
+    float distance2 = glm::dot(offset, offset);
+    if (distance2 >= radius * radius) return false;
+    if (!hit) return true;
+
+    if (distance2 > 0.0f) {
+        float distance = std::sqrt(distance2);
+        hit->normal = offset / distance;
+        hit->depth = radius - distance;
+    } else {
+        // Center inside the box: leave through the nearest face
+        float left = center.x - boxMin.x, right = boxMax.x - center.x;
+        float down = center.y - boxMin.y, up = boxMax.y - center.y;
+        float nearest = std::min({left, right, down, up});
+        if (nearest == left) hit->normal = glm::vec2(-1.0f, 0.0f);
+        else if (nearest == right) hit->normal = glm::vec2(1.0f, 0.0f);
+        else if (nearest == down) hit->normal = glm::vec2(0.0f, -1.0f);
+        else hit->normal = glm::vec2(0.0f, 1.0f);
+        hit->depth = nearest + radius;
+    }
+    return true;
+}
+
+bool sweepCircleVsBox(const glm::vec2& center, float radius, const glm::vec2& motion,
+                      const glm::vec2& boxMin, const glm::vec2& boxMax, SweepHit* hit) {
+    // The box grown by the radius: two slabs and four corner circles
+    SweepHit best{std::numeric_limits<float>::infinity()};
+    SweepHit candidate;
+    auto keep = [&](bool found) {
+        if (found && candidate.time < best.time) best = candidate;
+    };
+    keep(segmentVsBox(center, motion, boxMin - glm::vec2(radius, 0.0f), boxMax + glm::vec2(radius, 0.0f), candidate));
+    keep(segmentVsBox(center, motion, boxMin - glm::vec2(0.0f, radius), boxMax + glm::vec2(0.0f, radius), candidate));
+    keep(segmentVsCircle(center, motion, boxMin, radius, candidate));
+    keep(segmentVsCircle(center, motion, boxMax, radius, candidate));
+    keep(segmentVsCircle(center, motion, glm::vec2(boxMin.x, boxMax.y), radius, candidate));
+    keep(segmentVsCircle(center, motion, glm::vec2(boxMax.x, boxMin.y), radius, candidate));
+
+    if (best.time > 1.0f) return false;
+    if (hit) *hit = best;
+    return true;
+}
+
+/////////////////// SpatialHash /////////////////////////////
+SpatialHash::Id SpatialHash::insert(const glm::vec2& center, const glm::vec2& halfExtents) {
+    Id id;
+    if (!m_free.empty()) {
+        id = m_free.back();
+        m_free.pop_back();
+    } else {
+        id = static_cast<Id>(m_boxes.size());
+        m_boxes.emplace_back();
+    }
+
+    Box& box = m_boxes[id];
+    box.center = center;
+    box.halfExtents = halfExtents;
+    box.alive = true;
+    link(id);
+    return id;
+}
+
+void SpatialHash::update(Id id, const glm::vec2& center, const glm::vec2& halfExtents) {
+    if (id >= m_boxes.size() || !m_boxes[id].alive) return;
+
+    Box& box = m_boxes[id];
+    box.center = center;
+    box.halfExtents = halfExtents;
+    // Most moves stay inside the same cells
+    if (cellOf(center - halfExtents) == box.cellMin && cellOf(center + halfExtents) == box.cellMax) return;
+
+    unlink(id);
+    link(id);
+}
+
+void SpatialHash::remove(Id id) {
+    if (id >= m_boxes.size() || !m_boxes[id].alive) return;
+    unlink(id);
+    m_boxes[id].alive = false;
+    m_free.push_back(id);
+}
+
+void SpatialHash::clear() {
+    m_cells.clear();
+    m_boxes.clear();
+    m_free.clear();
+}
+
+void SpatialHash::link(Id id) {
+    Box& box = m_boxes[id];
+    box.cellMin = cellOf(box.center - box.halfExtents);
+    box.cellMax = cellOf(box.center + box.halfExtents);
+    for (int y = box.cellMin.y; y <= box.cellMax.y; y++) {
+        for (int x = box.cellMin.x; x <= box.cellMax.x; x++) {
+            m_cells[key(x, y)].push_back(id);
+        }
+    }
+}
+
+void SpatialHash::unlink(Id id) {
+    const Box& box = m_boxes[id];
+    for (int y = box.cellMin.y; y <= box.cellMax.y; y++) {
+        for (int x = box.cellMin.x; x <= box.cellMax.x; x++) {
+            auto cell = m_cells.find(key(x, y));
+            if (cell == m_cells.end()) continue;
+            std::vector<Id>& ids = cell->second;
+            ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+            if (ids.empty()) m_cells.erase(cell);
+        }
+    }
+}
+
+/////////////////// CollisionWorld /////////////////////////////
+void CollisionWorld::resetGrid(int width, int height, const glm::vec2& origin, float cellSize) {
+    m_width = std::max(width, 0);
+    m_height = std::max(height, 0);
+    m_origin = origin;
+    m_cellSize = cellSize;
+    m_solid.assign(static_cast<size_t>(m_width) * m_height, 0);
+    m_solidCount = 0;
+}
+
+void CollisionWorld::assignGrid(int width, int height, const glm::vec2& origin, float cellSize,
+                                std::vector<std::uint8_t> solid, size_t solidCount) {
+    m_width = std::max(width, 0);
+    m_height = std::max(height, 0);
+    m_origin = origin;
+    m_cellSize = cellSize;
+    m_solid = std::move(solid);
+    m_solid.resize(static_cast<size_t>(m_width) * m_height, 0);
+    m_solidCount = solidCount;
+}
+
+void CollisionWorld::setSolid(int x, int y, bool solid) {
+    if (x < 0 || y < 0 || x >= m_width || y >= m_height) return;
+    std::uint8_t& cell = m_solid[static_cast<size_t>(y) * m_width + x];
+    if (static_cast<bool>(cell) == solid) return;
+    cell = solid ? 1 : 0;
+    if (solid) m_solidCount++;
+    else m_solidCount--;
+}
+
+bool CollisionWorld::overlapCircle(const glm::vec2& center, float radius, CollisionHit* hit) const {
+    bool found = false;
+    CollisionHit deepest;
+
+    auto consider = [&](const glm::vec2& boxMin, const glm::vec2& boxMax) {
+        CollisionHit contact;
+        if (!circleVsBox(center, radius, boxMin, boxMax, &contact)) return;
+        if (!found || contact.depth > deepest.depth) deepest = contact;
+        found = true;
+    };
+
+    // Grid: the circle spans at most a few cells around its center
+    glm::ivec2 first = glm::max(cellOf(center - radius), glm::ivec2(0));
+    glm::ivec2 last = glm::min(cellOf(center + radius), glm::ivec2(m_width - 1, m_height - 1));
+    for (int y = first.y; y <= last.y; y++) {
+        for (int x = first.x; x <= last.x; x++) {
+            if (isSolid(x, y)) consider(cellMin(x, y), cellMax(x, y));
+        }
+    }
+
+    m_bodies.query(center - radius, center + radius, [&](SpatialHash::Id, const glm::vec2& boxMin, const glm::vec2& boxMax) {
+        consider(boxMin, boxMax);
+    });
+
+    if (found && hit) *hit = deepest;
+    return found;
+}
+
+bool CollisionWorld::sweepCircle(const glm::vec2& start, float radius, const glm::vec2& motion, SweepHit* hit) const {
+    if (motion == glm::vec2(0.0f)) return false;
+
+    SweepHit best{std::numeric_limits<float>::infinity()};
+    auto consider = [&](const glm::vec2& boxMin, const glm::vec2& boxMax) {
+        SweepHit contact;
+        if (sweepCircleVsBox(start, radius, motion, boxMin, boxMax, &contact) && contact.time < best.time) {
+            best = contact;
+        }
+    };
+
+    // Cells the center passes through, in order (Amanatides & Woo). Any wall the circle
+    // touches at time t is within reach cells of the cell holding the center at t.
+    if (m_width > 0 && m_height > 0) {
+        const int reach = static_cast<int>(std::ceil(radius / m_cellSize));
+        const glm::vec2 from = (start - m_origin) / m_cellSize;
+        const glm::vec2 delta = motion / m_cellSize;
+        glm::ivec2 cell(glm::floor(from));
+        const glm::ivec2 last(glm::floor(from + delta));
+
+        glm::ivec2 step(0);
+        glm::vec2 tNext(std::numeric_limits<float>::infinity());
+        glm::vec2 tStep(std::numeric_limits<float>::infinity());
+        for (int axis = 0; axis < 2; axis++) {
+            if (delta[axis] > 0.0f) {
+                step[axis] = 1;
+                tStep[axis] = 1.0f / delta[axis];
+                tNext[axis] = (cell[axis] + 1 - from[axis]) * tStep[axis];
+            } else if (delta[axis] < 0.0f) {
+                step[axis] = -1;
+                tStep[axis] = -1.0f / delta[axis];
+                tNext[axis] = (from[axis] - cell[axis]) * tStep[axis];
+            }
+        }
+
+        float tEnter = 0.0f;
+        const int maxSteps = std::abs(last.x - cell.x) + std::abs(last.y - cell.y);
+        for (int steps = 0; steps <= maxSteps && tEnter <= best.time; steps++) {
+            glm::ivec2 first = glm::max(cell - reach, glm::ivec2(0));
+            glm::ivec2 end = glm::min(cell + reach, glm::ivec2(m_width - 1, m_height - 1));
+            for (int y = first.y; y <= end.y; y++) {
+                for (int x = first.x; x <= end.x; x++) {
+                    if (isSolid(x, y)) consider(cellMin(x, y), cellMax(x, y));
+                }
+            }
+
+            int axis = tNext.x < tNext.y ? 0 : 1;
+            tEnter = tNext[axis];
+            cell[axis] += step[axis];
+            tNext[axis] += tStep[axis];
+        }
+    }
+
+    // Bodies are few, test everything the swept bounds touch
+    glm::vec2 sweepMin = glm::min(start, start + motion) - radius;
+    glm::vec2 sweepMax = glm::max(start, start + motion) + radius;
+    m_bodies.query(sweepMin, sweepMax, [&](SpatialHash::Id, const glm::vec2& boxMin, const glm::vec2& boxMax) {
+        consider(boxMin, boxMax);
+    });
+
+    if (best.time > 1.0f) return false;
+    if (hit) *hit = best;
+    return true;
+}
+
+glm::vec2 CollisionWorld::moveCircle(const glm::vec2& start, float radius, const glm::vec2& motion, int maxSlides) const {
+    glm::vec2 position = start;
+
+    // Sweeps only see entering contacts, so get out of anything we're already in
+    CollisionHit overlap;
+    for (int i = 0; i < 4 && overlapCircle(position, radius, &overlap); i++) {
+        position += overlap.normal * (overlap.depth + CONTACT_SKIN);
+    }
+
+    glm::vec2 remaining = motion;
+    for (int slide = 0; slide <= maxSlides; slide++) {
+        float length = glm::length(remaining);
+        if (length <= CONTACT_SKIN) break;
+
+        SweepHit hit;
+        if (!sweepCircle(position, radius, remaining, &hit)) {
+            position += remaining;
+            break;
+        }
+
+        // Stop just short of the contact, then keep only the part of the rest along the surface
+        float travel = std::max(hit.time - CONTACT_SKIN / length, 0.0f);
+        position += remaining * travel;
+        remaining *= 1.0f - travel;
+        remaining -= hit.normal * glm::dot(remaining, hit.normal);
+    }
+    return position;
+}
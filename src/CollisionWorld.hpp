@@ -0,0 +1,166 @@
+// CollisionWorld.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Contact of a circle with an obstacle on the XZ plane (x, z stored as x, y)
+struct CollisionHit {
+    glm::vec2 normal = glm::vec2(0.0f); // points out of the obstacle, towards the circle
+    float depth = 0.0f;                 // how far the circle has to move along normal to be free
+};
+
+// First contact of a moving circle, see CollisionWorld::sweepCircle
+struct SweepHit {
+    float time = 1.0f;                  // fraction of the motion covered before touching
+    glm::vec2 normal = glm::vec2(0.0f); // surface normal at the contact
+};
+
+// Overlap of a circle with an axis aligned box. Touching doesn't count, so a circle
+// pushed out to exactly the surface is free and can slide along it.
+bool circleVsBox(const glm::vec2& center, float radius, const glm::vec2& boxMin, const glm::vec2& boxMax,
+                 CollisionHit* hit = nullptr);
+
+// Time in [0, 1] at which a circle moving from center by motion starts to overlap the box,
+// found exactly as the segment entering the box grown by the radius (rounded corners).
+// Only entering contacts count: a circle already overlapping or moving along a face isn't hit.
+bool sweepCircleVsBox(const glm::vec2& center, float radius, const glm::vec2& motion,
+                      const glm::vec2& boxMin, const glm::vec2& boxMax, SweepHit* hit = nullptr);
+
+// Uniform spatial hash of axis aligned boxes on the XZ plane, for colliders that aren't
+// maze cells. A box is linked into every hash cell it overlaps; moving it only relinks
+// when it crosses into other cells. Cells are keyed by coordinates, so the world is unbounded.
+class SpatialHash {
+public:
+    using Id = std::uint32_t;
+    static constexpr Id INVALID = UINT32_MAX;
+
+    explicit SpatialHash(float cellSize = 2.0f) : m_cellSize(cellSize) {}
+
+    Id insert(const glm::vec2& center, const glm::vec2& halfExtents);
+    void update(Id id, const glm::vec2& center, const glm::vec2& halfExtents);
+    void remove(Id id);
+    void clear();
+
+    // Calls fn(id, boxMin, boxMax) once for every box whose cells the rectangle touches
+    template <typename Fn>
+    void query(const glm::vec2& min, const glm::vec2& max, Fn&& fn) const {
+        glm::ivec2 first = cellOf(min), last = cellOf(max);
+        // A box spanning several queried cells is reported once
+        m_stamp++;
+        for (int y = first.y; y <= last.y; y++) {
+            for (int x = first.x; x <= last.x; x++) {
+                auto cell = m_cells.find(key(x, y));
+                if (cell == m_cells.end()) continue;
+                for (Id id : cell->second) {
+                    const Box& box = m_boxes[id];
+                    if (box.stamp == m_stamp) continue;
+                    box.stamp = m_stamp;
+                    fn(id, box.center - box.halfExtents, box.center + box.halfExtents);
+                }
+            }
+        }
+    }
+
+    size_t size() const { return m_boxes.size() - m_free.size(); }
+    size_t cellCount() const { return m_cells.size(); }
+
+private:
+    struct Box {
+        glm::vec2 center;
+        glm::vec2 halfExtents;
+        glm::ivec2 cellMin, cellMax; // hash cells the box is linked into
+        bool alive = false;
+        mutable std::uint32_t stamp = 0;
+    };
+
+    glm::ivec2 cellOf(const glm::vec2& point) const {
+        return glm::ivec2(glm::floor(point / m_cellSize));
+    }
+    static std::uint64_t key(int x, int y) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+    }
+    void link(Id id);
+    void unlink(Id id);
+
+    float m_cellSize;
+    std::unordered_map<std::uint64_t, std::vector<Id>> m_cells;
+    std::vector<Box> m_boxes;
+    std::vector<Id> m_free;
+    mutable std::uint32_t m_stamp = 0;
+};
+
+// Collision geometry of the level on the XZ plane: the maze as a grid of solid cells,
+// plus a spatial hash for everything else. Both are looked up by position, so a query
+// only visits the few cells around the circle no matter how large the maze is.
+class CollisionWorld {
+public:
+    // Clears the grid to width x height free cells. origin is the corner of cell (0, 0),
+    // cell (x, y) covers origin + [x, x+1) * cellSize on X and [y, y+1) * cellSize on Z.
+    void resetGrid(int width, int height, const glm::vec2& origin, float cellSize);
+    void setSolid(int x, int y, bool solid);
+    // Takes over a grid built elsewhere (one byte per cell, row major, solidCount of them set),
+    // e.g. on a worker thread, without another pass over the cells
+    void assignGrid(int width, int height, const glm::vec2& origin, float cellSize,
+                    std::vector<std::uint8_t> solid, size_t solidCount);
+    // Cells outside the grid are free, the maze openings lead out of it
+    bool isSolid(int x, int y) const {
+        return x >= 0 && y >= 0 && x < m_width && y < m_height && m_solid[static_cast<size_t>(y) * m_width + x];
+    }
+
+    glm::ivec2 cellOf(const glm::vec2& point) const {
+        return glm::ivec2(glm::floor((point - m_origin) / m_cellSize));
+    }
+    glm::vec2 cellMin(int x, int y) const { return m_origin + glm::vec2(x, y) * m_cellSize; }
+    glm::vec2 cellMax(int x, int y) const { return cellMin(x + 1, y + 1); }
+
+    // Calls fn(cell) for every solid cell the circle overlaps
+    template <typename Fn>
+    void forEachSolidCell(const glm::vec2& center, float radius, Fn&& fn) const {
+        glm::ivec2 first = glm::max(cellOf(center - radius), glm::ivec2(0));
+        glm::ivec2 last = glm::min(cellOf(center + radius), glm::ivec2(m_width - 1, m_height - 1));
+        for (int y = first.y; y <= last.y; y++) {
+            for (int x = first.x; x <= last.x; x++) {
+                if (isSolid(x, y) && circleVsBox(center, radius, cellMin(x, y), cellMax(x, y))) {
+                    fn(glm::ivec2(x, y));
+                }
+            }
+        }
+    }
+
+    // True if the circle overlaps a solid cell or a body. hit gets the deepest contact.
+    bool overlapCircle(const glm::vec2& center, float radius, CollisionHit* hit = nullptr) const;
+
+    // Earliest contact of a circle moving by motion, against solid cells and bodies.
+    // The cells along the motion are walked in order (DDA) and the walk stops once it
+    // is past the best contact, so the cost follows the distance moved, not the maze size.
+    // Contact times are solved analytically, so no step size can skip a wall.
+    bool sweepCircle(const glm::vec2& start, float radius, const glm::vec2& motion, SweepHit* hit = nullptr) const;
+
+    // Moves the circle by motion, stopping at the first contact and sliding the rest of the
+    // motion along the surface (up to maxSlides contacts, for corners). A circle that starts
+    // inside an obstacle is pushed out first. Returns the new center.
+    glm::vec2 moveCircle(const glm::vec2& start, float radius, const glm::vec2& motion, int maxSlides = 3) const;
+
+    SpatialHash& bodies() { return m_bodies; }
+    const SpatialHash& bodies() const { return m_bodies; }
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    float cellSize() const { return m_cellSize; }
+    const glm::vec2& origin() const { return m_origin; }
+    size_t solidCount() const { return m_solidCount; }
+
+private:
+    int m_width = 0;
+    int m_height = 0;
+    glm::vec2 m_origin = glm::vec2(0.0f);
+    float m_cellSize = 1.0f;
+    std::vector<std::uint8_t> m_solid;
+    size_t m_solidCount = 0;
+
+    SpatialHash m_bodies;
+};
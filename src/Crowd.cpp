@@ -0,0 +1,218 @@
+// Crowd.cpp
+#include "Crowd.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    // Agents per task, small ranges cost more in handing out than they save
+    constexpr size_t MIN_RANGE = 4096;
+
+    double millisecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Evenly spread hues, fully saturated
+    glm::vec4 groupColor(int group, int groups) {
+        const float hue = 6.0f * static_cast<float>(group) / static_cast<float>(std::max(groups, 1));
+        auto channel = [&](float offset) {
+            float k = std::fmod(offset + hue, 6.0f);
+            return 1.0f - std::clamp(std::min(k, 4.0f - k), 0.0f, 1.0f);
+        };
+        return glm::vec4(channel(5.0f), channel(3.0f), channel(1.0f), 1.0f);
+    }
+
+    // Uniformly random open position, by rejection: about half a maze is open, so a few draws
+    // do. A grid that keeps rejecting is walked on from the last draw instead, which finds an
+    // open position if there is any. False if the grid is all walls.
+    bool randomOpenPosition(const MazeGrid& grid, MazeRandom& random, glm::ivec2& out) {
+        constexpr int ATTEMPTS = 64;
+        const std::uint32_t width = static_cast<std::uint32_t>(grid.width());
+        const std::uint32_t height = static_cast<std::uint32_t>(grid.height());
+        if (width == 0 || height == 0) return false;
+        glm::ivec2 p(0);
+        for (int attempt = 0; attempt < ATTEMPTS; attempt++) {
+            p = glm::ivec2(random.below(width), random.below(height));
+            if (!grid.isWall(p.x, p.y)) {
+                out = p;
+                return true;
+            }
+        }
+        const size_t cells = static_cast<size_t>(width) * height;
+        const size_t first = static_cast<size_t>(p.y) * width + p.x;
+        for (size_t i = 1; i < cells; i++) {
+            const size_t cell = (first + i) % cells;
+            const int x = static_cast<int>(cell % width), y = static_cast<int>(cell / width);
+            if (!grid.isWall(x, y)) {
+                out = glm::ivec2(x, y);
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+void CrowdSpawn::build(CrowdSpawn& out, const MazeGrid& grid, const CrowdSettings& settings, std::uint64_t seed,
+                       ThreadPool& pool) {
+    auto start = std::chrono::steady_clock::now();
+    out.agents.clear();
+    out.previousX.clear();
+    out.previousY.clear();
+    out.fields.clear();
+    out.colors.clear();
+    out.settings = settings;
+    out.settings.radius = std::clamp(settings.radius, 0.01f, 0.49f);
+    out.buildMs = 0.0;
+    if (settings.agents == 0) return; // every maze build gets here, most without a crowd
+
+    // Targets and spawn positions are drawn straight from the grid, no list of open positions
+    MazeRandom random(seed);
+    const int groups = std::clamp(settings.groups, 1, static_cast<int>(UINT16_MAX));
+    std::vector<glm::ivec2> targets(groups);
+    for (glm::ivec2& target : targets) {
+        if (!randomOpenPosition(grid, random, target)) return;
+    }
+    FlowField::buildAll(grid, targets, out.fields, pool);
+    for (int group = 0; group < groups; group++) {
+        out.colors.push_back(groupColor(group, groups));
+    }
+
+    // Spawn with a little jitter so agents sharing a position don't overlap exactly
+    const float jitter = 0.5f - out.settings.radius;
+    auto offset = [&] { return (static_cast<float>(random.below(65536)) / 65535.0f * 2.0f - 1.0f) * jitter; };
+    NavAgents& agents = out.agents;
+    agents.x.reserve(settings.agents);
+    agents.y.reserve(settings.agents);
+    agents.velocityX.reserve(settings.agents);
+    agents.velocityY.reserve(settings.agents);
+    agents.field.reserve(settings.agents);
+    for (size_t i = 0; i < settings.agents; i++) {
+        glm::ivec2 cell;
+        randomOpenPosition(grid, random, cell); // the targets proved there is one
+        agents.add(glm::vec2(cell) + glm::vec2(offset(), offset()), static_cast<std::uint16_t>(i % groups));
+    }
+    out.previousX = agents.x;
+    out.previousY = agents.y;
+    out.buildMs = millisecondsSince(start);
+}
+
+void Crowd::reset(const MazeGrid& grid, const CrowdSettings& settings, std::uint64_t seed) {
+    CrowdSpawn spawn;
+    CrowdSpawn::build(spawn, grid, settings, seed, m_pool);
+    assign(grid, std::move(spawn));
+}
+
+void Crowd::assign(const MazeGrid& grid, CrowdSpawn&& spawn) {
+    m_grid = &grid;
+    m_settings = spawn.settings;
+    m_agents = std::move(spawn.agents);
+    m_previousX = std::move(spawn.previousX);
+    m_previousY = std::move(spawn.previousY);
+    m_fields = std::move(spawn.fields);
+    m_colors = std::move(spawn.colors);
+    m_stats.fieldsMs = spawn.buildMs;
+}
+
+void Crowd::clear() {
+    m_agents.clear();
+    m_previousX.clear();
+    m_previousY.clear();
+    m_fields.clear();
+    m_colors.clear();
+}
+
+void Crowd::update(float dt) {
+    if (m_agents.size() == 0) return;
+    auto start = std::chrono::steady_clock::now();
+    m_pool.parallelFor(m_agents.size(), MIN_RANGE, [&](size_t begin, size_t end) {
+        const size_t count = end - begin;
+        std::memcpy(m_previousX.data() + begin, m_agents.x.data() + begin, count * sizeof(float));
+        std::memcpy(m_previousY.data() + begin, m_agents.y.data() + begin, count * sizeof(float));
+        steerAgents(m_agents, m_fields, m_settings.steering, dt, begin, end);
+        collide(begin, end);
+        retarget(begin, end);
+    });
+    m_stats.updateMs = millisecondsSince(start);
+}
+
+void Crowd::collide(size_t begin, size_t end) {
+    const MazeGrid& grid = *m_grid;
+    const float radius = m_settings.radius;
+    const float inner = 0.5f - radius;
+    float* px = m_agents.x.data();
+    float* py = m_agents.y.data();
+    float* vx = m_agents.velocityX.data();
+    float* vy = m_agents.velocityY.data();
+
+    for (size_t i = begin; i < end; i++) {
+        const int cellX = static_cast<int>(std::floor(px[i] + 0.5f));
+        const int cellY = static_cast<int>(std::floor(py[i] + 0.5f));
+        // Most agents are well inside their (open) position and touch nothing
+        if (std::abs(px[i] - cellX) <= inner && std::abs(py[i] - cellY) <= inner) continue;
+
+        // Wall position (x, y) covers [x - 0.5, x + 0.5]; push the circle out of each wall
+        // it overlaps and drop the velocity into it, so agents slide along corridors
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                const int wallX = cellX + dx, wallY = cellY + dy;
+                if (!grid.isWall(wallX, wallY)) continue;
+                const float closestX = std::clamp(px[i], wallX - 0.5f, wallX + 0.5f);
+                const float closestY = std::clamp(py[i], wallY - 0.5f, wallY + 0.5f);
+                const float awayX = px[i] - closestX, awayY = py[i] - closestY;
+                const float distance2 = awayX * awayX + awayY * awayY;
+                if (distance2 >= radius * radius || distance2 <= 0.0f) continue;
+
+                const float distance = std::sqrt(distance2);
+                const float normalX = awayX / distance, normalY = awayY / distance;
+                px[i] = closestX + normalX * radius;
+                py[i] = closestY + normalY * radius;
+                const float into = vx[i] * normalX + vy[i] * normalY;
+                if (into < 0.0f) {
+                    vx[i] -= normalX * into;
+                    vy[i] -= normalY * into;
+                }
+            }
+        }
+    }
+}
+
+void Crowd::retarget(size_t begin, size_t end) {
+    const std::uint16_t groups = static_cast<std::uint16_t>(m_fields.size());
+    for (size_t i = begin; i < end; i++) {
+        const FlowField& field = m_fields[m_agents.field[i]];
+        const glm::ivec2 cell(static_cast<int>(std::floor(m_agents.x[i] + 0.5f)),
+                              static_cast<int>(std::floor(m_agents.y[i] + 0.5f)));
+        if (cell == field.target()) {
+            m_agents.field[i] = static_cast<std::uint16_t>((m_agents.field[i] + 1) % groups);
+        }
+    }
+}
+
+void Crowd::writeInstances(CrowdInstance* out, float alpha, const CrowdPlacement& placement) {
+    auto start = std::chrono::steady_clock::now();
+    m_pool.parallelFor(m_agents.size(), MIN_RANGE, [&](size_t begin, size_t end) {
+        const float* x = m_agents.x.data();
+        const float* y = m_agents.y.data();
+        const float* previousX = m_previousX.data();
+        const float* previousY = m_previousY.data();
+        // Sequential whole-struct stores, out is usually write-combined mapped memory
+        for (size_t i = begin; i < end; i++) {
+            const float gridX = previousX[i] + (x[i] - previousX[i]) * alpha;
+            const float gridY = previousY[i] + (y[i] - previousY[i]) * alpha;
+            out[i] = CrowdInstance{
+                glm::vec4(placement.origin.x + gridX * placement.cellSize, placement.height,
+                          placement.origin.y + gridY * placement.cellSize, placement.scale),
+                m_colors[m_agents.field[i]]};
+        }
+    });
+    m_stats.instanceMs = millisecondsSince(start);
+}
+
+size_t Crowd::bytes() const {
+    size_t total = (m_agents.x.capacity() + m_agents.y.capacity() + m_agents.velocityX.capacity() +
+                    m_agents.velocityY.capacity() + m_previousX.capacity() + m_previousY.capacity()) * sizeof(float) +
+                   m_agents.field.capacity() * sizeof(std::uint16_t);
+    for (const FlowField& field : m_fields) total += field.bytes();
+    return total;
+}
@@ -0,0 +1,102 @@
+// Crowd.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "MazeGenerator.hpp"
+#include "Navigation.hpp"
+#include "ThreadPool.hpp"
+
+// std430 mirror of one entry of the Instances buffer in basic.vert
+struct CrowdInstance {
+    glm::vec4 positionScale; // world position, uniform scale of the mesh
+    glm::vec4 color;         // multiplies the material's base color
+};
+static_assert(sizeof(CrowdInstance) == 32, "CrowdInstance must match std430 layout");
+
+struct CrowdSettings {
+    size_t agents = 0;   // 0 = no crowd
+    int groups = 8;      // each group follows its own flow field
+    int threads = 0;     // update/upload threads, 0 = one per hardware thread
+    float radius = 0.2f; // collision radius in grid units, keep below 0.5
+    SteeringSettings steering;
+};
+
+// Where the grid sits in the world: position (x, y) of the maze is at
+// origin + (x, y) * cellSize on the XZ plane
+struct CrowdPlacement {
+    glm::vec2 origin = glm::vec2(0.0f);
+    float cellSize = 1.0f;
+    float height = 0.0f; // y of the agents' centers
+    float scale = 1.0f;  // mesh scale of one instance
+};
+
+// A crowd spawned on a maze but not running yet: the group fields and the agents at their
+// spawn positions. Keeps no reference to the grid, so it can be built on a worker thread
+// (MazeBuild does, next to the maze) and handed to Crowd::assign() later.
+struct CrowdSpawn {
+    CrowdSettings settings; // radius clamped
+    NavAgents agents;
+    std::vector<float> previousX, previousY; // same as the agents' positions
+    std::vector<FlowField> fields;
+    std::vector<glm::vec4> colors; // per group
+    double buildMs = 0.0;
+
+    // Builds the group fields over grid, spread over pool's threads, and spawns
+    // settings.agents agents on random open positions
+    static void build(CrowdSpawn& out, const MazeGrid& grid, const CrowdSettings& settings, std::uint64_t seed,
+                      ThreadPool& pool);
+};
+
+// Stress test crowd: lots of agents walking a maze, drawn as one instanced draw. Agents
+// are NavAgents (parallel arrays in grid units), steered by flow fields towards their
+// group's target; on arrival an agent moves on to the next group's target. Walls are
+// resolved against the MazeGrid itself, each agent against the up to 8 wall positions
+// around it, so there is no per-wall collider. Agents don't collide with each other.
+// Update and instance writing are split over a thread pool in contiguous ranges.
+class Crowd {
+public:
+    struct Stats {
+        double updateMs = 0.0;  // last step
+        double instanceMs = 0.0; // last writeInstances
+        double fieldsMs = 0.0;   // building the fields and agents of the last reset/assign
+    };
+
+    explicit Crowd(int threads = 0) : m_pool(threads) {}
+
+    // Builds the group fields over grid and spawns the agents on random open positions.
+    // grid must outlive the crowd or the next reset().
+    void reset(const MazeGrid& grid, const CrowdSettings& settings, std::uint64_t seed);
+    // Takes over a crowd spawned elsewhere on grid, or on a grid equal to it; same lifetime rule
+    void assign(const MazeGrid& grid, CrowdSpawn&& spawn);
+    void clear();
+
+    // One fixed step: steer, collide with the walls, retarget arrivals
+    void update(float dt);
+    // Writes every agent's instance, its position blended between the last two steps
+    void writeInstances(CrowdInstance* out, float alpha, const CrowdPlacement& placement);
+
+    size_t size() const { return m_agents.size(); }
+    int groups() const { return static_cast<int>(m_fields.size()); }
+    int threads() const { return m_pool.size(); }
+    // The pool update() runs on, free for other work on the same thread between updates
+    ThreadPool& pool() { return m_pool; }
+    const CrowdSettings& settings() const { return m_settings; }
+    const Stats& stats() const { return m_stats; }
+    size_t bytes() const;
+
+private:
+    void collide(size_t begin, size_t end);
+    void retarget(size_t begin, size_t end);
+
+    ThreadPool m_pool;
+    const MazeGrid* m_grid = nullptr;
+    CrowdSettings m_settings;
+    NavAgents m_agents;
+    std::vector<float> m_previousX, m_previousY;
+    std::vector<FlowField> m_fields;
+    std::vector<glm::vec4> m_colors; // per group
+    Stats m_stats;
+};
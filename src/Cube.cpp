@@ -4,8 +4,7 @@
 #include "Model.hpp"
 #include <memory>
 
-Cube::Cube(std::shared_ptr<ShaderProgram> shader, const std::string& texturePath)
-    : Model("resources/objects/cube.obj", shader)
+Cube::Cube(std::shared_ptr<ShaderVariants> shaders)
+    : Model("resources/objects/cube.obj", shaders)
 {
-    setTexture(texturePath);
 }
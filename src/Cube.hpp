@@ -4,5 +4,6 @@
 
 class Cube : public Model {
 public:
-    Cube(std::shared_ptr<ShaderProgram> shader, const std::string& texturePath);
+    // Unit cube mesh, the material comes from the entity drawing it
+    explicit Cube(std::shared_ptr<ShaderVariants> shaders);
 };
\ No newline at end of file
@@ -0,0 +1,26 @@
+// FixedTimestep.cpp
+#include "FixedTimestep.hpp"
+#include <algorithm>
+
+void FixedTimestep::configure(double rateHz, int maxSteps) {
+    m_step = 1.0 / std::clamp(rateHz, 1.0, 10000.0);
+    m_maxSteps = std::max(maxSteps, 1);
+    m_accumulator = std::min(m_accumulator, m_step);
+}
+
+int FixedTimestep::advance(double frameSeconds) {
+    m_accumulator += std::max(frameSeconds, 0.0);
+
+    // Never owe more than the cap, the excess is time the simulation skips
+    const double limit = m_step * m_maxSteps;
+    if (m_accumulator > limit) {
+        m_dropped += m_accumulator - limit;
+        m_accumulator = limit;
+    }
+
+    int steps = static_cast<int>(m_accumulator / m_step);
+    m_accumulator -= steps * m_step;
+    m_lastSteps = steps;
+    m_totalSteps += steps;
+    return steps;
+}
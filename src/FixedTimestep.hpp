@@ -0,0 +1,38 @@
+// FixedTimestep.hpp
+#pragma once
+
+#include <cstdint>
+
+// Accumulator for running the simulation at a fixed rate independent of the frame rate.
+// Each frame's time is added, and advance() returns how many whole steps are due. The
+// leftover fraction of a step is alpha(), which rendering uses to blend the previous and
+// current simulation states. After a long hitch at most maxSteps run and the rest of the
+// backlog is dropped, so a slow frame can't start a spiral of ever longer catch-ups.
+class FixedTimestep {
+public:
+    explicit FixedTimestep(double rateHz = 120.0, int maxSteps = 8) { configure(rateHz, maxSteps); }
+
+    void configure(double rateHz, int maxSteps);
+
+    // Adds the frame time and returns the number of steps to simulate now
+    int advance(double frameSeconds);
+
+    double step() const { return m_step; }
+    double rate() const { return 1.0 / m_step; }
+    int maxSteps() const { return m_maxSteps; }
+
+    // How far past the last step the frame is, in steps [0, 1)
+    float alpha() const { return static_cast<float>(m_accumulator / m_step); }
+
+    int lastSteps() const { return m_lastSteps; }
+    std::uint64_t totalSteps() const { return m_totalSteps; }
+    double droppedSeconds() const { return m_dropped; }
+
+private:
+    double m_step = 1.0 / 120.0;
+    int m_maxSteps = 8;
+    double m_accumulator = 0.0;
+    int m_lastSteps = 0;
+    std::uint64_t m_totalSteps = 0;
+    double m_dropped = 0.0;
+};
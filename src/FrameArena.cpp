@@ -0,0 +1,32 @@
+// FrameArena.cpp
+#include "FrameArena.hpp"
+#include <iostream>
+
+FrameArena::FrameArena(std::size_t capacity)
+    : m_buffer(std::make_unique<std::byte[]>(capacity)), m_capacity(capacity) {
+    m_resource.emplace(m_buffer.get(), m_capacity, std::pmr::new_delete_resource());
+}
+
+void FrameArena::reset() {
+    if (m_used > m_capacity) {
+        // Last frame spilled to the heap, grow so it doesn't happen again
+        std::size_t newCapacity = m_capacity;
+        while (newCapacity < m_used) newCapacity *= 2;
+
+        std::cerr << "FrameArena: grew from " << m_capacity << " to " << newCapacity << " bytes\n";
+        m_resource.reset();
+        m_buffer = std::make_unique<std::byte[]>(newCapacity);
+        m_capacity = newCapacity;
+        m_resource.emplace(m_buffer.get(), m_capacity, std::pmr::new_delete_resource());
+    } else {
+        m_resource->release();
+    }
+    m_used = 0;
+}
+
+void* FrameArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    // Count the worst case alignment padding so the growth estimate is never short
+    m_used += bytes + alignment - 1;
+    if (m_used > m_peak) m_peak = m_used;
+    return m_resource->allocate(bytes, alignment);
+}
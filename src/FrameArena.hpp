@@ -0,0 +1,40 @@
+// FrameArena.hpp
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+// Linear allocator for data that only lives for the duration of one frame.
+// Allocations bump through a fixed buffer and are all released at once by reset().
+// If a frame needs more than the buffer holds, the overflow goes to the heap and the
+// buffer is grown on the next reset, so steady state runs without heap allocations.
+class FrameArena final : public std::pmr::memory_resource {
+public:
+    explicit FrameArena(std::size_t capacity = 256 * 1024);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Call once at the start of every frame
+    void reset();
+
+    std::size_t capacity() const { return m_capacity; }
+    std::size_t bytesUsed() const { return m_used; }
+    std::size_t peakBytesUsed() const { return m_peak; }
+    bool overflowed() const { return m_used > m_capacity; }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void*, std::size_t, std::size_t) override {} // released by reset()
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::unique_ptr<std::byte[]> m_buffer;
+    std::size_t m_capacity = 0;
+    std::size_t m_used = 0;
+    std::size_t m_peak = 0;
+    std::optional<std::pmr::monotonic_buffer_resource> m_resource;
+};
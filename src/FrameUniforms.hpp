@@ -0,0 +1,48 @@
+// FrameUniforms.hpp
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include "Light.h"
+
+// Uniform block bindings, must match layout(binding = N) in the shaders
+constexpr GLuint CAMERA_UBO_BINDING = 0;
+constexpr GLuint LIGHTS_UBO_BINDING = 1;
+constexpr GLuint TERRAIN_WINDOW_UBO_BINDING = 2;
+// Shader storage binding of the per-instance data of instanced draws (basic.vert)
+constexpr GLuint INSTANCES_SSBO_BINDING = 3;
+// Texture unit of the terrain height texture, after the material arrays (terrain.vert)
+constexpr GLuint TERRAIN_HEIGHT_TEXTURE_UNIT = 8;
+// Streamed full resolution tiles around the camera (terrain_height.glsl)
+constexpr GLuint TERRAIN_WINDOW_TEXTURE_UNIT = 9;
+
+// NR_POINT_LIGHTS in basic.frag
+constexpr int MAX_POINT_LIGHTS = 3;
+
+// std140 mirror of the CameraData block
+struct CameraUniforms {
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::vec3 viewPos;
+    float _pad0 = 0.0f;
+};
+
+// std140 mirror of the LightData block
+struct LightUniforms {
+    DirLight dirLight;
+    PointLight pointLights[MAX_POINT_LIGHTS];
+    SpotLight spotLight;
+};
+
+// std140 mirror of the TerrainWindow block. With a tiled terrain the height texture is
+// its overview and the window holds the resident tiles; otherwise the rect is empty.
+struct TerrainWindowUniforms {
+    glm::vec4 rect = glm::vec4(0.0f, 0.0f, -1.0f, -1.0f); // resident samples: min x, min z, max x, max z
+    glm::vec4 info = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);   // window texture size, blend width in samples, overview step
+};
+
+static_assert(sizeof(TerrainWindowUniforms) == 32, "TerrainWindowUniforms must match std140 layout");
+static_assert(sizeof(CameraUniforms) == 144, "CameraUniforms must match std140 layout");
+static_assert(offsetof(LightUniforms, pointLights) == 64, "LightUniforms must match std140 layout");
+static_assert(offsetof(LightUniforms, spotLight) == 304, "LightUniforms must match std140 layout");
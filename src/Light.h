@@ -1,33 +1,72 @@
 // Light.h
 #pragma once
+#include <algorithm>
+#include <cmath>
 #include <glm/glm.hpp>
 
+// The light structs are laid out to match std140, so they can be copied straight
+// into the LightData uniform block (see FrameUniforms.hpp and basic.frag).
+// The _pad members only exist for that layout.
+
 struct DirLight {
     glm::vec3 direction;
+    float _pad0 = 0.0f;
     glm::vec3 ambient;
+    float _pad1 = 0.0f;
     glm::vec3 diffuse;
+    float _pad2 = 0.0f;
     glm::vec3 specular;
+    float _pad3 = 0.0f;
 };
 
 struct PointLight {
     glm::vec3 position;
+    float _pad0 = 0.0f;
     glm::vec3 ambient;
+    float _pad1 = 0.0f;
     glm::vec3 diffuse;
+    float _pad2 = 0.0f;
     glm::vec3 specular;
     float constant;
     float linear;
     float quadratic;
+    float _pad3[2] = {};
 };
 
 struct SpotLight {
     glm::vec3 position;
+    float _pad0 = 0.0f;
     glm::vec3 direction;
     float cutOff;
     float outerCutOff;
+    float _pad1[3] = {};
     glm::vec3 ambient;
+    float _pad2 = 0.0f;
     glm::vec3 diffuse;
+    float _pad3 = 0.0f;
     glm::vec3 specular;
     float constant;
     float linear;
     float quadratic;
-};
\ No newline at end of file
+    float _pad4[2] = {};
+};
+
+static_assert(sizeof(DirLight) == 64, "DirLight must match std140 layout");
+static_assert(sizeof(PointLight) == 80, "PointLight must match std140 layout");
+static_assert(sizeof(SpotLight) == 112, "SpotLight must match std140 layout");
+
+
+// Distance at which a point light's contribution falls below 1/256, used to skip
+// lights that cannot visibly affect an object
+inline float pointLightRange(const PointLight& light) {
+    glm::vec3 total = light.ambient + light.diffuse + light.specular;
+    float intensity = std::max({total.r, total.g, total.b});
+    if (intensity <= 0.0f) return 0.0f;
+
+    // Solve constant + linear*d + quadratic*d^2 = 256 * intensity
+    float c = light.constant - 256.0f * intensity;
+    if (light.quadratic <= 0.0f) {
+        return light.linear > 0.0f ? -c / light.linear : INFINITY;
+    }
+    return (-light.linear + std::sqrt(light.linear * light.linear - 4.0f * light.quadratic * c)) / (2.0f * light.quadratic);
+}
\ No newline at end of file
@@ -0,0 +1,248 @@
+// MaterialTable.cpp
+#include "MaterialTable.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <opencv2/videoio.hpp>
+
+MaterialTable::~MaterialTable() {
+    for (ArrayGroup& group : m_groups) {
+        if (group.texture) glDeleteTextures(1, &group.texture);
+    }
+    if (m_buffer) glDeleteBuffers(1, &m_buffer);
+}
+
+MaterialTexture MaterialTable::loadTexture(const std::string& path) {
+    TRACE_SCOPE_DETAIL("MaterialTable::loadTexture", path);
+    cv::Mat image = cv::imread(path, cv::IMREAD_UNCHANGED);
+    if (image.empty()) {
+        std::cerr << "Failed to load texture: " << path << std::endl;
+        return {};
+    }
+
+    // Convert color space
+    if (image.channels() == 4) {
+        cv::cvtColor(image, image, cv::COLOR_BGRA2RGBA);
+    } else if (image.channels() == 3) {
+        cv::cvtColor(image, image, cv::COLOR_BGR2RGB);
+    } else if (image.channels() == 1) {
+        cv::cvtColor(image, image, cv::COLOR_GRAY2RGB);
+    } else {
+        std::cerr << "Unsupported number of channels in texture: " << path << std::endl;
+        return {};
+    }
+
+    std::vector<cv::Mat> frames{image};
+    return stage(frames, image.channels() == 4, 0.0f, path);
+}
+
+MaterialTexture MaterialTable::loadAnimation(const std::string& gifPath) {
+    cv::VideoCapture cap(gifPath);
+    if (!cap.isOpened()) {
+        std::cerr << "Failed to open animation: " << gifPath << std::endl;
+        return {};
+    }
+
+    double fps = cap.get(cv::CAP_PROP_FPS);
+    bool hasAlpha = false;
+    std::vector<cv::Mat> frames;
+    cv::Mat frame;
+    while (cap.read(frame)) {
+        hasAlpha = hasAlpha || frame.channels() == 4;
+        // Convert to RGBA if needed
+        if (frame.channels() == 3) {
+            cv::cvtColor(frame, frame, cv::COLOR_BGR2RGBA);
+        } else if (frame.channels() == 4) {
+            cv::cvtColor(frame, frame, cv::COLOR_BGRA2RGBA);
+        }
+
+        // GIF frames all share the canvas size, anything else can't be a layer
+        if (!frames.empty() && (frame.cols != frames[0].cols || frame.rows != frames[0].rows)) {
+            std::cerr << "Skipping GIF frame with mismatched size in " << gifPath << std::endl;
+            continue;
+        }
+        frames.push_back(frame.clone());
+    }
+
+    if (frames.empty()) {
+        std::cerr << "No frames in animation: " << gifPath << std::endl;
+        return {};
+    }
+    return stage(frames, hasAlpha, fps > 0.0 ? static_cast<float>(1.0 / fps) : 0.1f, gifPath);
+}
+
+int MaterialTable::findGroup(GLenum internalFormat, GLenum format, int width, int height) {
+    for (size_t i = 0; i < m_groups.size(); i++) {
+        const ArrayGroup& group = m_groups[i];
+        if (group.internalFormat == internalFormat && group.width == width && group.height == height) {
+            return static_cast<int>(i);
+        }
+    }
+    if (m_groups.size() >= MAX_MATERIAL_TEXTURE_ARRAYS) return -1;
+
+    m_groups.push_back({internalFormat, format, width, height});
+    return static_cast<int>(m_groups.size() - 1);
+}
+
+MaterialTexture MaterialTable::stage(std::vector<cv::Mat>& frames, bool hasAlpha, float frameDelay,
+                                     const std::string& path) {
+    if (m_uploaded) {
+        std::cerr << "Texture arrays are already uploaded, ignoring " << path << std::endl;
+        return {};
+    }
+
+    const cv::Mat& first = frames.front();
+    bool rgba = first.channels() == 4;
+    int groupIndex = findGroup(rgba ? GL_RGBA8 : GL_RGB8, rgba ? GL_RGBA : GL_RGB, first.cols, first.rows);
+    if (groupIndex < 0) {
+        std::cerr << "Out of material texture arrays (" << MAX_MATERIAL_TEXTURE_ARRAYS
+                  << " formats/sizes), ignoring " << path << std::endl;
+        return {};
+    }
+
+    ArrayGroup& group = m_groups[groupIndex];
+    MaterialTexture texture;
+    texture.array = groupIndex;
+    texture.firstLayer = group.layers;
+    texture.frameCount = static_cast<int>(frames.size());
+    texture.frameDelay = frameDelay;
+    texture.hasAlpha = hasAlpha;
+
+    for (cv::Mat& frame : frames) {
+        group.staged.push_back(std::move(frame));
+    }
+    group.layers += texture.frameCount;
+    return texture;
+}
+
+MaterialTable::Id MaterialTable::add(const Material& material) {
+    m_entries.push_back({material});
+    Id id = static_cast<Id>(m_entries.size() - 1);
+    markDirty(id);
+    return id;
+}
+
+void MaterialTable::set(Id id, const Material& material) {
+    m_entries[id] = {material};
+    markDirty(id);
+}
+
+bool MaterialTable::isTransparent(Id id) const {
+    const Material& material = m_entries[id].material;
+    return material.alpha < 0.99f || material.texture.hasAlpha;
+}
+
+size_t MaterialTable::layerCount() const {
+    size_t layers = 0;
+    for (const ArrayGroup& group : m_groups) layers += group.layers;
+    return layers;
+}
+
+void MaterialTable::upload() {
+    if (m_uploaded) return;
+    m_uploaded = true;
+
+    float maxAniso = 0.0f;
+    if (GLEW_EXT_texture_filter_anisotropic) {
+        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAniso);
+    }
+
+    // RGB rows aren't 4-byte aligned in general
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (ArrayGroup& group : m_groups) {
+        GLsizei levels = static_cast<GLsizei>(std::floor(std::log2(std::max(group.width, group.height)))) + 1;
+
+        glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &group.texture);
+        glTextureStorage3D(group.texture, levels, group.internalFormat, group.width, group.height, group.layers);
+        for (int layer = 0; layer < group.layers; layer++) {
+            const cv::Mat& image = group.staged[layer];
+            glTextureSubImage3D(group.texture, 0, 0, 0, layer, group.width, group.height, 1,
+                                group.format, GL_UNSIGNED_BYTE, image.data);
+        }
+        glGenerateTextureMipmap(group.texture);
+
+        glTextureParameteri(group.texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTextureParameteri(group.texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(group.texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTextureParameteri(group.texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        if (maxAniso > 0.0f) {
+            glTextureParameterf(group.texture, GL_TEXTURE_MAX_ANISOTROPY_EXT, maxAniso);
+        }
+
+        group.staged.clear();
+        group.staged.shrink_to_fit();
+        std::cout << "Material texture array " << group.width << "x" << group.height
+                  << (group.format == GL_RGBA ? " RGBA" : " RGB") << ": " << group.layers << " layer(s)\n";
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void MaterialTable::update(float deltaTime) {
+    for (Id id = 0; id < m_entries.size(); id++) {
+        Entry& entry = m_entries[id];
+        const MaterialTexture& texture = entry.material.texture;
+        if (texture.frameCount <= 1) continue;
+
+        entry.frameTime += deltaTime;
+        if (entry.frameTime >= texture.frameDelay) {
+            entry.frameTime = 0.0f;
+            entry.frame = (entry.frame + 1) % texture.frameCount;
+            markDirty(id);
+        }
+    }
+}
+
+GpuMaterial MaterialTable::pack(const Entry& entry) const {
+    const Material& material = entry.material;
+    GpuMaterial gpu{};
+    gpu.baseColor = glm::vec4(material.baseColor, material.alpha);
+    gpu.textureArray = material.texture.array;
+    gpu.layer = material.texture.firstLayer + entry.frame;
+    gpu.flags = alphaTested(material) ? ALPHA_TEST : 0u;
+    return gpu;
+}
+
+void MaterialTable::markDirty(Id id) {
+    if (m_dirtyBegin == m_dirtyEnd) {
+        m_dirtyBegin = id;
+        m_dirtyEnd = id + 1;
+    } else {
+        m_dirtyBegin = std::min(m_dirtyBegin, id);
+        m_dirtyEnd = std::max(m_dirtyEnd, id + 1);
+    }
+}
+
+void MaterialTable::bind() {
+    if (m_entries.empty()) return;
+
+    // Grow the buffer (and re-upload everything) when materials outgrew it
+    if (m_entries.size() > m_bufferCapacity) {
+        if (m_buffer) glDeleteBuffers(1, &m_buffer);
+        m_bufferCapacity = std::max<size_t>(m_entries.size() * 2, 16);
+        glCreateBuffers(1, &m_buffer);
+        glNamedBufferStorage(m_buffer, m_bufferCapacity * sizeof(GpuMaterial), nullptr, GL_DYNAMIC_STORAGE_BIT);
+        m_dirtyBegin = 0;
+        m_dirtyEnd = static_cast<Id>(m_entries.size());
+    }
+
+    // Only the changed range, usually the animated materials
+    if (m_dirtyBegin != m_dirtyEnd) {
+        m_packed.clear();
+        for (Id id = m_dirtyBegin; id < m_dirtyEnd; id++) {
+            m_packed.push_back(pack(m_entries[id]));
+        }
+        glNamedBufferSubData(m_buffer, m_dirtyBegin * sizeof(GpuMaterial),
+                             m_packed.size() * sizeof(GpuMaterial), m_packed.data());
+        m_dirtyBegin = m_dirtyEnd = 0;
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MATERIALS_SSBO_BINDING, m_buffer);
+
+    GLuint textures[MAX_MATERIAL_TEXTURE_ARRAYS] = {};
+    for (size_t i = 0; i < m_groups.size(); i++) {
+        textures[i] = m_groups[i].texture;
+    }
+    glBindTextures(0, static_cast<GLsizei>(m_groups.size()), textures);
+}
@@ -0,0 +1,122 @@
+// MaterialTable.hpp
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <opencv2/core.hpp>
+
+// Shader storage binding of the material table, must match materials.glsl
+constexpr GLuint MATERIALS_SSBO_BINDING = 2;
+// Texture arrays are bound to units 0..MAX_MATERIAL_TEXTURE_ARRAYS-1 (materialTextures[] in materials.glsl)
+constexpr int MAX_MATERIAL_TEXTURE_ARRAYS = 8;
+
+// Layers of one image (or GIF) inside the table's texture arrays
+struct MaterialTexture {
+    int array = -1;         // -1: untextured
+    int firstLayer = 0;
+    int frameCount = 1;     // > 1 for animations, frames are consecutive layers
+    float frameDelay = 0.0f; // seconds per animation frame
+    bool hasAlpha = false;
+};
+
+struct Material {
+    glm::vec3 baseColor = glm::vec3(1.0f); // multiplies the texture, or the whole color if untextured
+    float alpha = 1.0f;
+    MaterialTexture texture;
+};
+
+// std430 mirror of Material in materials.glsl
+struct GpuMaterial {
+    glm::vec4 baseColor; // rgb + alpha
+    std::int32_t textureArray;
+    std::int32_t layer;
+    std::uint32_t flags;
+    std::int32_t _pad;
+};
+static_assert(sizeof(GpuMaterial) == 32, "GpuMaterial must match the std430 Material layout");
+
+// Every material of the scene in one shader storage buffer, indexed by a per-draw
+// material ID, so draws that use different materials only differ by an integer.
+// Images are grouped by format and size into texture arrays, each bound once per frame.
+// Textures are staged on the CPU and uploaded together by upload(); materials can be
+// added or changed at any time and reach the GPU on the next bind().
+class MaterialTable {
+public:
+    using Id = std::uint32_t;
+
+    enum Flags : std::uint32_t {
+        ALPHA_TEST = 1u << 0, // discard (nearly) transparent fragments
+    };
+
+    MaterialTable() = default;
+    ~MaterialTable();
+
+    MaterialTable(const MaterialTable&) = delete;
+    MaterialTable& operator=(const MaterialTable&) = delete;
+
+    // Decode an image / every frame of a GIF into the matching array group. Returns an
+    // untextured MaterialTexture (array -1) if loading fails or upload() already ran.
+    MaterialTexture loadTexture(const std::string& path);
+    MaterialTexture loadAnimation(const std::string& gifPath);
+
+    Id add(const Material& material);
+    const Material& get(Id id) const { return m_entries[id].material; }
+    void set(Id id, const Material& material);
+
+    // Blended pass needed: translucent alpha or a texture with an alpha channel
+    bool isTransparent(Id id) const;
+    // ALPHA_TEST flag set, draws need the ALPHA_TEST shader variant
+    bool isAlphaTested(Id id) const { return alphaTested(m_entries[id].material); }
+
+    // Creates the texture arrays from the staged images and frees the CPU copies
+    void upload();
+
+    // Advances animated materials
+    void update(float deltaTime);
+
+    // Uploads changed entries, binds the SSBO and all texture arrays
+    void bind();
+
+    size_t size() const { return m_entries.size(); }
+    size_t arrayCount() const { return m_groups.size(); }
+    size_t layerCount() const;
+
+private:
+    struct ArrayGroup {
+        GLenum internalFormat;
+        GLenum format;
+        int width;
+        int height;
+        int layers = 0;
+        std::vector<cv::Mat> staged;
+        GLuint texture = 0;
+    };
+
+    struct Entry {
+        Material material;
+        int frame = 0;
+        float frameTime = 0.0f;
+    };
+
+    static bool alphaTested(const Material& material) {
+        return material.texture.array >= 0 && material.texture.hasAlpha;
+    }
+    // Index of the group for this format/size, creating it if there's room
+    int findGroup(GLenum internalFormat, GLenum format, int width, int height);
+    MaterialTexture stage(std::vector<cv::Mat>& frames, bool hasAlpha, float frameDelay, const std::string& path);
+    GpuMaterial pack(const Entry& entry) const;
+    void markDirty(Id id);
+
+    std::vector<ArrayGroup> m_groups;
+    std::vector<Entry> m_entries;
+    bool m_uploaded = false;
+
+    GLuint m_buffer = 0;
+    size_t m_bufferCapacity = 0; // in materials
+    Id m_dirtyBegin = 0;
+    Id m_dirtyEnd = 0;
+    std::vector<GpuMaterial> m_packed; // upload scratch, keeps its capacity
+};
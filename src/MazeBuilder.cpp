@@ -0,0 +1,99 @@
+// MazeBuilder.cpp
+#include "MazeBuilder.hpp"
+#include "Trace.hpp"
+#include <chrono>
+#include <iostream>
+
+void MazeBuild::build(MazeBuild& out, MazeGenerator& generator, const MazeSettings& settings,
+                      const MazePlacement& placement, const CrowdSettings& crowd, ThreadPool* crowdPool) {
+    auto start = std::chrono::steady_clock::now();
+
+    out.settings = settings;
+    out.placement = placement;
+    generator.generate(out.grid, settings);
+
+    const int width = out.grid.width(), height = out.grid.height();
+    const glm::vec2 half = glm::vec2(width, height) / 2.0f;
+    out.collisionOrigin = (-half - 0.5f) * placement.cellSize;
+    out.solid.assign(static_cast<size_t>(width) * height, 0);
+    out.walls.clear();
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (!out.grid.isWall(x, y)) continue;
+            out.solid[static_cast<size_t>(y) * width + x] = 1;
+            out.walls.emplace_back((x - half.x) * placement.cellSize, placement.elevation,
+                                   (y - half.y) * placement.cellSize);
+        }
+    }
+
+    out.buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // Seeded with the maze, so the same maze always gets the same crowd. Timed on its own.
+    if (crowd.agents > 0 && crowdPool) {
+        CrowdSpawn::build(out.crowd, out.grid, crowd, out.settings.seed, *crowdPool);
+    } else {
+        out.crowd = {};
+    }
+}
+
+MazeBuilder::MazeBuilder() : m_thread(&MazeBuilder::work, this) {}
+
+MazeBuilder::~MazeBuilder() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+void MazeBuilder::request(const MazeSettings& settings, const MazePlacement& placement, const CrowdSettings& crowd) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_request = Request{settings, placement, crowd};
+    }
+    m_wake.notify_one();
+}
+
+std::unique_ptr<MazeBuild> MazeBuilder::takeResult() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::move(m_result);
+}
+
+bool MazeBuilder::busy() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_building || m_request.has_value();
+}
+
+void MazeBuilder::work() {
+    TRACE_THREAD_NAME("Maze builder");
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this] { return m_stop || m_request.has_value(); });
+        if (m_stop) return;
+
+        const Request request = *m_request;
+        m_request.reset();
+        m_building = true;
+        lock.unlock();
+
+        // Built outside the lock, the render thread only ever waits for the handover
+        TRACE_SCOPE("Maze build");
+        auto build = std::make_unique<MazeBuild>();
+        try {
+            if (request.crowd.agents > 0 && !m_crowdPool) {
+                m_crowdPool = std::make_unique<ThreadPool>(request.crowd.threads);
+            }
+            MazeBuild::build(*build, m_generator, request.settings, request.placement, request.crowd,
+                             m_crowdPool.get());
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: maze build failed: " << e.what() << "\n";
+            build.reset();
+        }
+
+        lock.lock();
+        m_building = false;
+        // A result nobody picked up yet is stale once a newer one exists
+        if (build) m_result = std::move(build);
+    }
+}
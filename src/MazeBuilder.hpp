@@ -0,0 +1,77 @@
+// MazeBuilder.hpp
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Crowd.hpp"
+#include "MazeGenerator.hpp"
+
+// Where a maze goes in the world: grid position (x, y) is centered on
+// ((x - width/2) * cellSize, elevation, (y - height/2) * cellSize)
+struct MazePlacement {
+    float cellSize = 1.0f;
+    float elevation = 0.5f;
+};
+
+// Everything a maze needs before it touches the scene: the grid, the wall instances, the
+// collision cells and the crowd walking it, ready to be handed over without further
+// per-cell or per-agent work
+struct MazeBuild {
+    MazeSettings settings; // with the seed actually used
+    MazePlacement placement;
+    MazeGrid grid;
+    std::vector<glm::vec3> walls;    // wall cube centers, row by row
+    glm::vec2 collisionOrigin = glm::vec2(0.0f);
+    std::vector<std::uint8_t> solid; // CollisionWorld cells, 1 per grid position
+    CrowdSpawn crowd;                // crowd.settings.agents == 0 if none was asked for
+    double buildMs = 0.0;            // grid, walls and cells, the crowd has its own time
+
+    // The crowd's fields are built on crowdPool, there is no crowd without one
+    static void build(MazeBuild& out, MazeGenerator& generator, const MazeSettings& settings,
+                      const MazePlacement& placement, const CrowdSettings& crowd = {},
+                      ThreadPool* crowdPool = nullptr);
+};
+
+// Builds mazes on a worker thread. request() hands over the settings and returns at once;
+// the finished MazeBuild is picked up with takeResult() on a later frame. Requests made
+// while a build runs replace each other, only the newest is built next.
+class MazeBuilder {
+public:
+    MazeBuilder();
+    ~MazeBuilder();
+
+    MazeBuilder(const MazeBuilder&) = delete;
+    MazeBuilder& operator=(const MazeBuilder&) = delete;
+
+    void request(const MazeSettings& settings, const MazePlacement& placement, const CrowdSettings& crowd = {});
+    // The finished maze, or nullptr if none is ready. Never blocks on a running build.
+    std::unique_ptr<MazeBuild> takeResult();
+    // A request is queued or being built
+    bool busy() const;
+
+private:
+    struct Request {
+        MazeSettings settings;
+        MazePlacement placement;
+        CrowdSettings crowd;
+    };
+
+    void work();
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::optional<Request> m_request;
+    std::unique_ptr<MazeBuild> m_result;
+    bool m_building = false;
+    bool m_stop = false;
+    MazeGenerator m_generator; // only touched by the worker, keeps its scratch between builds
+    std::unique_ptr<ThreadPool> m_crowdPool; // worker only, made with the first crowd
+    std::thread m_thread;
+};
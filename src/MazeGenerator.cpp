@@ -0,0 +1,244 @@
+// MazeGenerator.cpp
+#include "MazeGenerator.hpp"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+namespace {
+    // Directions: up, right, down, left; the opposite of d is d ^ 2
+    constexpr int DX[] = {0, 1, 0, -1};
+    constexpr int DY[] = {-1, 0, 1, 0};
+    constexpr int MAX_SIDE = 65535;
+    constexpr std::uint32_t NONE = UINT32_MAX;
+
+    int normalizeSide(int side) {
+        if (side > MAX_SIDE) {
+            throw std::runtime_error("Maze side " + std::to_string(side) + " exceeds " + std::to_string(MAX_SIDE));
+        }
+        return std::max(side, 3) | 1;
+    }
+
+    void openEntranceAndExit(MazeGrid& grid) {
+        grid.setWall(0, 1, false);
+        grid.setWall(grid.width() - 1, grid.height() - 2, false);
+    }
+}
+
+void MazeGrid::reset(int width, int height, bool wall) {
+    m_width = std::max(width, 0);
+    m_height = std::max(height, 0);
+    m_wordsPerRow = (static_cast<size_t>(m_width) + 63) / 64;
+    m_words.assign(m_wordsPerRow * m_height, wall ? ~std::uint64_t(0) : 0);
+}
+
+MazeAlgorithm mazeAlgorithmFromName(const std::string& name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lower == "wilson") return MazeAlgorithm::Wilson;
+    if (lower == "eller") return MazeAlgorithm::Eller;
+    return MazeAlgorithm::Backtracker;
+}
+
+const char* mazeAlgorithmName(MazeAlgorithm algorithm) {
+    switch (algorithm) {
+        case MazeAlgorithm::Wilson: return "wilson";
+        case MazeAlgorithm::Eller: return "eller";
+        default: return "backtracker";
+    }
+}
+
+void MazeGenerator::generate(MazeGrid& grid, const MazeSettings& settings) {
+    const int width = normalizeSide(settings.width);
+    const int height = normalizeSide(settings.height);
+
+    grid.reset(width, height);
+    if (settings.algorithm == MazeAlgorithm::Eller) {
+        streamEller(settings, [&](int y, const std::uint64_t* bits) {
+            std::copy(bits, bits + grid.wordsPerRow(), grid.row(y));
+        });
+        return;
+    }
+
+    const size_t cells = static_cast<size_t>(width / 2) * (height / 2);
+    // assign() keeps the capacity, so a generator reused at the same size doesn't allocate
+    m_directions.assign((cells + 3) / 4, 0);
+
+    MazeRandom random(settings.seed);
+    if (settings.algorithm == MazeAlgorithm::Wilson) {
+        carveWilson(grid, random);
+    } else {
+        carveBacktracker(grid, random);
+    }
+    openEntranceAndExit(grid);
+}
+
+void MazeGenerator::carveBacktracker(MazeGrid& grid, MazeRandom& random) {
+    const int columns = grid.width() / 2, rows = grid.height() / 2;
+    auto carved = [&](int x, int y) { return !grid.isWall(2 * x + 1, 2 * y + 1); };
+    auto index = [&](int x, int y) { return static_cast<std::uint32_t>(y) * columns + x; };
+
+    // Instead of a stack, every cell remembers the way back to the cell it was entered from
+    int x = 0, y = 0;
+    grid.setWall(1, 1, false);
+    while (true) {
+        int options[4];
+        int count = 0;
+        for (int dir = 0; dir < 4; dir++) {
+            int nx = x + DX[dir], ny = y + DY[dir];
+            if (nx >= 0 && ny >= 0 && nx < columns && ny < rows && !carved(nx, ny)) options[count++] = dir;
+        }
+
+        if (count > 0) {
+            int dir = options[random.below(count)];
+            grid.setWall(2 * x + 1 + DX[dir], 2 * y + 1 + DY[dir], false);
+            x += DX[dir];
+            y += DY[dir];
+            grid.setWall(2 * x + 1, 2 * y + 1, false);
+            setDirection(index(x, y), dir ^ 2);
+        } else {
+            if (x == 0 && y == 0) break;
+            std::uint32_t back = direction(index(x, y));
+            x += DX[back];
+            y += DY[back];
+        }
+    }
+}
+
+void MazeGenerator::carveWilson(MazeGrid& grid, MazeRandom& random) {
+    const int columns = grid.width() / 2, rows = grid.height() / 2;
+    const std::uint32_t cells = static_cast<std::uint32_t>(columns) * rows;
+    auto carved = [&](int x, int y) { return !grid.isWall(2 * x + 1, 2 * y + 1); };
+    auto index = [&](int x, int y) { return static_cast<std::uint32_t>(y) * columns + x; };
+
+    std::uint32_t seed = random.below(cells);
+    grid.setWall(2 * static_cast<int>(seed % columns) + 1, 2 * static_cast<int>(seed / columns) + 1, false);
+
+    for (std::uint32_t start = 0; start < cells; start++) {
+        const int startX = static_cast<int>(start % columns), startY = static_cast<int>(start / columns);
+        if (carved(startX, startY)) continue;
+
+        // Random walk until the maze is hit. Each cell keeps only its last exit, which
+        // erases any loop the walk made.
+        int x = startX, y = startY;
+        while (!carved(x, y)) {
+            int options[4];
+            int count = 0;
+            for (int dir = 0; dir < 4; dir++) {
+                int nx = x + DX[dir], ny = y + DY[dir];
+                if (nx >= 0 && ny >= 0 && nx < columns && ny < rows) options[count++] = dir;
+            }
+            int dir = options[random.below(count)];
+            setDirection(index(x, y), dir);
+            x += DX[dir];
+            y += DY[dir];
+        }
+
+        // Carve the loop-erased path into the maze
+        x = startX;
+        y = startY;
+        while (!carved(x, y)) {
+            grid.setWall(2 * x + 1, 2 * y + 1, false);
+            std::uint32_t dir = direction(index(x, y));
+            grid.setWall(2 * x + 1 + DX[dir], 2 * y + 1 + DY[dir], false);
+            x += DX[dir];
+            y += DY[dir];
+        }
+    }
+}
+
+void MazeGenerator::streamEller(const MazeSettings& settings, const std::function<void(int, const std::uint64_t*)>& emit) {
+    const int width = normalizeSide(settings.width);
+    const int height = normalizeSide(settings.height);
+    const int columns = width / 2, rows = height / 2;
+    const size_t words = (static_cast<size_t>(width) + 63) / 64;
+
+    m_rowBits.resize(words);
+    m_sets.resize(columns);
+    m_parents.resize(columns);
+    m_counts.resize(columns);
+    m_remap.resize(columns);
+    m_hasDown.resize(columns);
+
+    auto wallRow = [&] { std::fill(m_rowBits.begin(), m_rowBits.end(), ~std::uint64_t(0)); };
+    auto open = [&](int x) { m_rowBits[x >> 6] &= ~(std::uint64_t(1) << (x & 63)); };
+    auto find = [&](std::uint32_t set) {
+        while (m_parents[set] != set) {
+            m_parents[set] = m_parents[m_parents[set]];
+            set = m_parents[set];
+        }
+        return set;
+    };
+
+    MazeRandom random(settings.seed);
+    for (int c = 0; c < columns; c++) {
+        m_sets[c] = m_parents[c] = static_cast<std::uint32_t>(c);
+    }
+
+    wallRow();
+    emit(0, m_rowBits.data());
+
+    for (int r = 0; r < rows; r++) {
+        const bool lastRow = r == rows - 1;
+        const int y = 2 * r + 1;
+
+        // Cells, joined to the right at random when they belong to different sets.
+        // The last row joins every remaining set so the maze ends up connected.
+        wallRow();
+        for (int c = 0; c < columns; c++) open(2 * c + 1);
+        for (int c = 0; c + 1 < columns; c++) {
+            std::uint32_t left = find(m_sets[c]), right = find(m_sets[c + 1]);
+            if (left != right && (lastRow || random.coin())) {
+                open(2 * c + 2);
+                m_parents[right] = left;
+            }
+        }
+        if (r == 0) open(0);
+        if (lastRow) open(width - 1);
+        emit(y, m_rowBits.data());
+
+        wallRow();
+        if (lastRow) {
+            emit(y + 1, m_rowBits.data());
+            break;
+        }
+
+        // Passages down: at random, but at least one per set so no set is cut off
+        for (int c = 0; c < columns; c++) {
+            m_sets[c] = find(m_sets[c]);
+            m_counts[m_sets[c]] = 0;
+            m_hasDown[m_sets[c]] = 0;
+        }
+        for (int c = 0; c < columns; c++) m_counts[m_sets[c]]++;
+        for (int c = 0; c < columns; c++) {
+            std::uint32_t set = m_sets[c];
+            bool lastOfSet = --m_counts[set] == 0;
+            if (random.coin() || (lastOfSet && !m_hasDown[set])) {
+                open(2 * c + 1);
+                m_hasDown[set] = 1;
+            } else {
+                m_sets[c] = NONE;
+            }
+        }
+        emit(y + 1, m_rowBits.data());
+
+        // Next row: cells below a passage keep their set, the rest start new ones.
+        // Labels are renumbered to stay below the column count.
+        std::fill(m_remap.begin(), m_remap.end(), NONE);
+        std::uint32_t next = 0;
+        for (int c = 0; c < columns; c++) {
+            if (m_sets[c] == NONE) continue;
+            if (m_remap[m_sets[c]] == NONE) m_remap[m_sets[c]] = next++;
+            m_sets[c] = m_remap[m_sets[c]];
+        }
+        for (int c = 0; c < columns; c++) {
+            if (m_sets[c] == NONE) m_sets[c] = next++;
+        }
+        for (int c = 0; c < columns; c++) m_parents[c] = static_cast<std::uint32_t>(c);
+    }
+}
+
+size_t MazeGenerator::scratchBytes() const {
+    return m_directions.capacity() +
+           (m_sets.capacity() + m_parents.capacity() + m_counts.capacity() + m_remap.capacity()) * sizeof(std::uint32_t) +
+           m_hasDown.capacity() + m_rowBits.capacity() * sizeof(std::uint64_t);
+}
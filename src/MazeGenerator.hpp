@@ -0,0 +1,116 @@
+// MazeGenerator.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Maze as one bit per grid position (1 = wall), 64 positions per word, rows padded to
+// whole words. Cells sit at odd coordinates, the even ones between them are walls or
+// passages, so a width x height grid holds (width-1)/2 x (height-1)/2 cells.
+class MazeGrid {
+public:
+    MazeGrid() = default;
+    MazeGrid(int width, int height, bool wall = true) { reset(width, height, wall); }
+
+    void reset(int width, int height, bool wall = true);
+
+    // Outside the grid counts as open
+    bool isWall(int x, int y) const {
+        if (x < 0 || y < 0 || x >= m_width || y >= m_height) return false;
+        return (m_words[static_cast<size_t>(y) * m_wordsPerRow + (x >> 6)] >> (x & 63)) & 1u;
+    }
+    void setWall(int x, int y, bool wall) {
+        std::uint64_t& word = m_words[static_cast<size_t>(y) * m_wordsPerRow + (x >> 6)];
+        const std::uint64_t mask = std::uint64_t(1) << (x & 63);
+        word = wall ? (word | mask) : (word & ~mask);
+    }
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    size_t wordsPerRow() const { return m_wordsPerRow; }
+    std::uint64_t* row(int y) { return m_words.data() + static_cast<size_t>(y) * m_wordsPerRow; }
+    const std::uint64_t* row(int y) const { return m_words.data() + static_cast<size_t>(y) * m_wordsPerRow; }
+    size_t bytes() const { return m_words.size() * sizeof(std::uint64_t); }
+
+private:
+    int m_width = 0;
+    int m_height = 0;
+    size_t m_wordsPerRow = 0;
+    std::vector<std::uint64_t> m_words;
+};
+
+enum class MazeAlgorithm {
+    Backtracker, // depth first, long winding corridors
+    Wilson,      // loop-erased random walks, uniform over all mazes
+    Eller        // row by row, only one row of state
+};
+
+// "backtracker", "wilson" or "eller"; unknown names give Backtracker
+MazeAlgorithm mazeAlgorithmFromName(const std::string& name);
+const char* mazeAlgorithmName(MazeAlgorithm algorithm);
+
+struct MazeSettings {
+    int width = 19;  // grid size, rounded up to odd
+    int height = 19;
+    MazeAlgorithm algorithm = MazeAlgorithm::Backtracker;
+    std::uint64_t seed = 0; // same seed and size, same maze
+};
+
+// SplitMix64: tiny, fast and good enough for carving; seeded explicitly so mazes replay
+class MazeRandom {
+public:
+    explicit MazeRandom(std::uint64_t seed = 0) : m_state(seed) {}
+
+    std::uint64_t next() {
+        std::uint64_t z = (m_state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    // Uniform in [0, bound), bound > 0
+    std::uint32_t below(std::uint32_t bound) {
+        return static_cast<std::uint32_t>(((next() >> 32) * bound) >> 32);
+    }
+    bool coin() { return next() >> 63; }
+
+private:
+    std::uint64_t m_state;
+};
+
+// Carves perfect mazes (one path between any two cells) into a MazeGrid, with an entrance
+// at (0, 1) and an exit at (width-1, height-2). The carve is iterative and keeps its
+// bookkeeping in scratch buffers owned by the generator (2 bits per cell for the
+// backtracker and Wilson, O(width) for Eller), so reusing a generator doesn't allocate
+// unless the maze grows. Sizes are limited to 65535 per side.
+class MazeGenerator {
+public:
+    void generate(MazeGrid& grid, const MazeSettings& settings);
+
+    // Eller's algorithm one grid row at a time, top to bottom, without ever holding the
+    // whole maze: emit(y, row) gets each row as wordsPerRow words of wall bits.
+    void streamEller(const MazeSettings& settings, const std::function<void(int, const std::uint64_t*)>& emit);
+
+    // Scratch memory currently held, for reporting
+    size_t scratchBytes() const;
+
+private:
+    void carveBacktracker(MazeGrid& grid, MazeRandom& random);
+    void carveWilson(MazeGrid& grid, MazeRandom& random);
+
+    // 2 bits per cell: direction to the parent (backtracker) or of the walk (Wilson)
+    std::uint32_t direction(std::uint32_t cell) const { return (m_directions[cell >> 2] >> ((cell & 3) * 2)) & 3u; }
+    void setDirection(std::uint32_t cell, std::uint32_t dir) {
+        std::uint8_t& byte = m_directions[cell >> 2];
+        const int shift = (cell & 3) * 2;
+        byte = static_cast<std::uint8_t>((byte & ~(3u << shift)) | (dir << shift));
+    }
+
+    std::vector<std::uint8_t> m_directions;
+    // Eller state, one entry per cell column
+    std::vector<std::uint32_t> m_sets, m_parents, m_counts, m_remap;
+    std::vector<std::uint8_t> m_hasDown;
+    std::vector<std::uint64_t> m_rowBits;
+};
@@ -0,0 +1,242 @@
+// MazeStreamer.cpp
+#include "MazeStreamer.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+    constexpr int MAX_CHUNK_CELLS = 4096;
+
+    int floorDiv(int value, int divisor) {
+        return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+    }
+
+    int chebyshev(const glm::ivec2& a, const glm::ivec2& b) {
+        return std::max(std::abs(a.x - b.x), std::abs(a.y - b.y));
+    }
+
+    // Independent stream per chunk and purpose, from the maze seed
+    std::uint64_t chunkSeed(std::uint64_t seed, const glm::ivec2& chunk, std::uint64_t purpose) {
+        MazeRandom random(seed ^ (static_cast<std::uint64_t>(static_cast<std::uint32_t>(chunk.x)) * 0xD6E8FEB86659FD93ull)
+                               ^ (static_cast<std::uint64_t>(static_cast<std::uint32_t>(chunk.y)) * 0xA0761D6478BD642Full)
+                               ^ (purpose * 0xE7037ED1A0B428DBull));
+        return random.next();
+    }
+}
+
+MazeStreamer::MazeStreamer(const MazeStreamSettings& settings) : m_settings(settings) {
+    m_settings.chunkCells = std::clamp(m_settings.chunkCells, 1, MAX_CHUNK_CELLS);
+    m_settings.viewRadius = std::max(m_settings.viewRadius, 0);
+    m_settings.workers = std::max(m_settings.workers, 1);
+
+    // Everything is allocated up front, streaming only reuses it
+    const int wanted = 2 * m_settings.viewRadius + 1;
+    const int capacity = m_settings.cacheChunks > 0 ? std::max(m_settings.cacheChunks, wanted * wanted)
+                                                    : (wanted + 2) * (wanted + 2);
+    m_slots.resize(capacity);
+    for (Slot slot = 0; slot < m_slots.size(); slot++) {
+        m_slots[slot].grid.reset(chunkSide(), chunkSide());
+        m_free.push_back(static_cast<Slot>(m_slots.size()) - 1 - slot);
+    }
+    m_coords.reserve(m_slots.size());
+    m_loaded.reserve(m_slots.size());
+    m_evicted.reserve(m_slots.size());
+    m_done.reserve(m_slots.size());
+
+    for (int i = 0; i < m_settings.workers; i++) {
+        m_threads.emplace_back(&MazeStreamer::work, this);
+    }
+}
+
+MazeStreamer::~MazeStreamer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void MazeStreamer::buildChunk(const MazeStreamSettings& settings, const glm::ivec2& chunk,
+                              MazeGenerator& generator, MazeGrid& scratch, MazeGrid& out) {
+    const int cells = std::clamp(settings.chunkCells, 1, MAX_CHUNK_CELLS);
+    const int side = 2 * cells;
+
+    // Carve a standalone maze one position wider, then keep everything but its east and
+    // south borders, which belong to the neighbours
+    generator.generate(scratch, {side + 1, side + 1, settings.algorithm, chunkSeed(settings.seed, chunk, 0)});
+    out.reset(side, side, true);
+    for (int y = 1; y < side; y++) {
+        for (int x = 1; x < side; x++) {
+            if (!scratch.isWall(x, y)) out.setWall(x, y, false);
+        }
+    }
+
+    // One passage through each owned border, so every chunk connects to all four neighbours
+    MazeRandom west(chunkSeed(settings.seed, chunk, 1));
+    MazeRandom north(chunkSeed(settings.seed, chunk, 2));
+    out.setWall(0, 2 * static_cast<int>(west.below(cells)) + 1, false);
+    out.setWall(2 * static_cast<int>(north.below(cells)) + 1, 0, false);
+}
+
+void MazeStreamer::update(const glm::ivec2& focus) {
+    m_updates++;
+    m_loaded.clear();
+    m_evicted.clear();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    for (Slot slot : m_done) {
+        if (m_slots[slot].state != State::Building) continue;
+        m_slots[slot].state = State::Resident;
+        m_pending--;
+        m_loaded.push_back(slot);
+    }
+    m_done.clear();
+
+    // Chunks queued for a focus that has since moved away aren't worth building any more
+    auto stale = [&](const Job& job) {
+        if (chebyshev(m_slots[job.slot].coord, focus) <= m_settings.viewRadius) return false;
+        release(job.slot);
+        return true;
+    };
+    m_jobs.erase(std::remove_if(m_jobs.begin(), m_jobs.end(), stale), m_jobs.end());
+
+    // Mark everything still wanted first, so eviction never takes one of them
+    const int radius = m_settings.viewRadius;
+    m_missing.clear();
+    for (int dy = -radius; dy <= radius; dy++) {
+        for (int dx = -radius; dx <= radius; dx++) {
+            glm::ivec2 chunk = focus + glm::ivec2(dx, dy);
+            auto found = m_coords.find(key(chunk));
+            if (found != m_coords.end()) {
+                m_slots[found->second].lastWanted = m_updates;
+            } else {
+                m_missing.push_back(chunk);
+            }
+        }
+    }
+
+    for (const glm::ivec2& chunk : m_missing) {
+        Slot slot;
+        if (!acquireSlot(focus, &slot)) break;
+        ChunkSlot& target = m_slots[slot];
+        target.state = State::Building;
+        target.coord = chunk;
+        target.lastWanted = m_updates;
+        m_coords.emplace(key(chunk), slot);
+        m_pending++;
+        m_jobs.push_back({slot, 0});
+    }
+
+    // Nearest first, by where the focus is now
+    for (Job& job : m_jobs) {
+        glm::ivec2 offset = m_slots[job.slot].coord - focus;
+        job.distance = offset.x * offset.x + offset.y * offset.y;
+    }
+    std::sort(m_jobs.begin(), m_jobs.end(), [](const Job& a, const Job& b) { return a.distance < b.distance; });
+
+    lock.unlock();
+    m_wake.notify_all();
+}
+
+void MazeStreamer::finish() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_jobs.empty() && m_busy == 0; });
+}
+
+bool MazeStreamer::find(const glm::ivec2& chunk, Slot* slot) const {
+    auto found = m_coords.find(key(chunk));
+    if (found == m_coords.end() || m_slots[found->second].state != State::Resident) return false;
+    if (slot) *slot = found->second;
+    return true;
+}
+
+bool MazeStreamer::isWall(const glm::ivec2& position) const {
+    glm::ivec2 chunk = chunkOf(position);
+    Slot slot;
+    if (!find(chunk, &slot)) return false;
+    glm::ivec2 local = position - chunk * chunkSide();
+    return m_slots[slot].grid.isWall(local.x, local.y);
+}
+
+glm::ivec2 MazeStreamer::chunkOf(const glm::ivec2& position) const {
+    return glm::ivec2(floorDiv(position.x, chunkSide()), floorDiv(position.y, chunkSide()));
+}
+
+size_t MazeStreamer::bytes() const {
+    // From the sizes rather than the grids, workers may be writing to those
+    const size_t gridBytes = static_cast<size_t>(chunkSide()) * ((chunkSide() + 63) / 64) * sizeof(std::uint64_t);
+    return m_slots.capacity() * (sizeof(ChunkSlot) + gridBytes);
+}
+
+bool MazeStreamer::acquireSlot(const glm::ivec2& focus, Slot* slot) {
+    if (!m_free.empty()) {
+        *slot = m_free.back();
+        m_free.pop_back();
+        return true;
+    }
+
+    // Farthest resident chunk that isn't wanted, the one wanted longest ago among equals.
+    // Chunks just loaded are still being handed to the caller, they stay.
+    bool found = false;
+    Slot victim = 0;
+    int victimDistance = -1;
+    for (Slot candidate = 0; candidate < m_slots.size(); candidate++) {
+        const ChunkSlot& chunk = m_slots[candidate];
+        if (chunk.state != State::Resident || chunk.lastWanted == m_updates) continue;
+        if (std::find(m_loaded.begin(), m_loaded.end(), candidate) != m_loaded.end()) continue;
+        int distance = chebyshev(chunk.coord, focus);
+        if (distance > victimDistance ||
+            (distance == victimDistance && chunk.lastWanted < m_slots[victim].lastWanted)) {
+            victim = candidate;
+            victimDistance = distance;
+            found = true;
+        }
+    }
+    if (!found) return false;
+
+    m_coords.erase(key(m_slots[victim].coord));
+    m_slots[victim].state = State::Free;
+    m_evicted.push_back(victim);
+    *slot = victim;
+    return true;
+}
+
+void MazeStreamer::release(Slot slot) {
+    m_coords.erase(key(m_slots[slot].coord));
+    m_slots[slot].state = State::Free;
+    m_pending--;
+    m_free.push_back(slot);
+}
+
+void MazeStreamer::work() {
+    TRACE_THREAD_NAME("Maze streamer");
+    // Per worker scratch, reused for every chunk
+    MazeGenerator generator;
+    MazeGrid scratch;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+        if (m_stop) return;
+
+        Job job = m_jobs.front();
+        m_jobs.pop_front();
+        const glm::ivec2 coord = m_slots[job.slot].coord;
+        m_busy++;
+        lock.unlock();
+
+        {
+            TRACE_SCOPE("Maze chunk");
+            buildChunk(m_settings, coord, generator, scratch, m_slots[job.slot].grid);
+        }
+
+        lock.lock();
+        m_busy--;
+        m_done.push_back(job.slot);
+        if (m_jobs.empty() && m_busy == 0) m_idle.notify_all();
+    }
+}
@@ -0,0 +1,120 @@
+// MazeStreamer.hpp
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "MazeGenerator.hpp"
+
+struct MazeStreamSettings {
+    MazeAlgorithm algorithm = MazeAlgorithm::Backtracker;
+    std::uint64_t seed = 1;
+    int chunkCells = 16; // maze cells per chunk side, a chunk is 2 * chunkCells grid positions wide
+    int viewRadius = 2;  // chunks kept loaded around the focus in every direction
+    int cacheChunks = 0; // slots in the pool, 0 = (2 * viewRadius + 3)^2
+    int workers = 2;
+};
+
+// Unbounded maze, split into square chunks that are built on worker threads around a
+// moving focus and evicted when it moves away.
+//
+// Every chunk owns its north row and west column of grid positions; its east and south
+// neighbours own the rest of its border. Chunks are generated from the seed and their
+// coordinates only: the interior is a perfect maze carved with its own seed, and every
+// border has one passage at a position hashed from the chunk, so any chunk comes out the
+// same whenever it's rebuilt and borders always line up.
+//
+// Chunks live in a fixed pool of slots, so memory doesn't grow however far the focus
+// travels. When a slot is needed and none is free, the resident chunk farthest from the
+// focus is evicted, the one left behind longest among equals.
+//
+// Threading: update() and every query are for one thread. Workers only ever write to the
+// slot they were handed, which that thread doesn't read until update() reports it loaded.
+class MazeStreamer {
+public:
+    using Slot = std::uint32_t;
+
+    explicit MazeStreamer(const MazeStreamSettings& settings);
+    ~MazeStreamer();
+
+    MazeStreamer(const MazeStreamer&) = delete;
+    MazeStreamer& operator=(const MazeStreamer&) = delete;
+
+    // Deterministic contents of one chunk, chunkSide() x chunkSide() grid positions
+    static void buildChunk(const MazeStreamSettings& settings, const glm::ivec2& chunk,
+                           MazeGenerator& generator, MazeGrid& scratch, MazeGrid& out);
+
+    // Collects finished chunks into loaded(), then queues the chunks within viewRadius of
+    // focus that are missing, nearest first. Slots taken from resident chunks for that are
+    // listed in evicted() and must be let go of before the next update().
+    void update(const glm::ivec2& focus);
+    // Blocks until every queued chunk is built; the next update() reports them
+    void finish();
+
+    const std::vector<Slot>& loaded() const { return m_loaded; }
+    const std::vector<Slot>& evicted() const { return m_evicted; }
+
+    // Resident chunk data
+    const MazeGrid& grid(Slot slot) const { return m_slots[slot].grid; }
+    const glm::ivec2& coord(Slot slot) const { return m_slots[slot].coord; }
+    bool find(const glm::ivec2& chunk, Slot* slot = nullptr) const;
+    // Global grid position; positions in chunks that aren't resident are open
+    bool isWall(const glm::ivec2& position) const;
+
+    int chunkSide() const { return 2 * m_settings.chunkCells; }
+    glm::ivec2 chunkOf(const glm::ivec2& position) const;
+    const MazeStreamSettings& settings() const { return m_settings; }
+
+    size_t capacity() const { return m_slots.size(); }
+    size_t residentCount() const { return m_coords.size() - m_pending; }
+    size_t pendingCount() const { return m_pending; }
+    size_t bytes() const;
+
+private:
+    enum class State : std::uint8_t { Free, Building, Resident };
+
+    struct ChunkSlot {
+        State state = State::Free;
+        glm::ivec2 coord = glm::ivec2(0);
+        std::uint64_t lastWanted = 0; // update() that last had it within viewRadius
+        MazeGrid grid;
+    };
+
+    struct Job {
+        Slot slot;
+        int distance;
+    };
+
+    static std::uint64_t key(const glm::ivec2& chunk) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(chunk.x)) << 32) | static_cast<std::uint32_t>(chunk.y);
+    }
+    bool acquireSlot(const glm::ivec2& focus, Slot* slot);
+    void release(Slot slot);
+    void work();
+
+    MazeStreamSettings m_settings;
+    std::vector<ChunkSlot> m_slots;
+    std::vector<Slot> m_free;
+    std::unordered_map<std::uint64_t, Slot> m_coords; // resident or building chunks
+    size_t m_pending = 0;
+    std::uint64_t m_updates = 0;
+    std::vector<Slot> m_loaded;
+    std::vector<Slot> m_evicted;
+    std::vector<glm::ivec2> m_missing;
+
+    // Shared with the workers
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::deque<Job> m_jobs;
+    std::vector<Slot> m_done;
+    int m_busy = 0;
+    bool m_stop = false;
+    std::vector<std::thread> m_threads;
+};
@@ -1,9 +1,10 @@
 #include "Mesh.hpp"
 #include <iostream>
+#include <stdexcept>
 
-Mesh::Mesh(GLenum primitiveType, std::shared_ptr<ShaderProgram> shader, const std::vector<vertex>& vertices,
+Mesh::Mesh(GLenum primitiveType, const std::vector<vertex>& vertices,
     const std::vector<GLuint>& indices, glm::vec3 origin, glm::vec3 orientation) : primitiveType(primitiveType),
-    shader(std::move(shader)), vertices(vertices), indices(indices), origin(origin), orientation(orientation) {
+    vertices(vertices), indices(indices), origin(origin), orientation(orientation) {
     
     glCreateVertexArrays(1, &VAO);
     glCreateBuffers(1, &VBO);
@@ -48,11 +49,8 @@ Mesh::Mesh(GLenum primitiveType, std::shared_ptr<ShaderProgram> shader, const st
 }
 
 void Mesh::draw() {
-    if (shader) {
-        shader->activate();
-        glBindVertexArray(VAO);
-        // glDrawElements(primitiveType, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
-        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-    }
+    glBindVertexArray(VAO);
+    // glDrawElements(primitiveType, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
 }
\ No newline at end of file
@@ -2,7 +2,6 @@
 
 #include <vector>
 #include "assets.hpp"
-#include "ShaderProgram.hpp"
 
 class Mesh {
 public:
@@ -34,19 +33,20 @@ public:
         return maxY;
     }
     Mesh(GLenum primitiveType,
-        std::shared_ptr<ShaderProgram> shader,
         const std::vector<vertex>& vertices,
         const std::vector<GLuint>& indices,
         glm::vec3 origin = glm::vec3(0.0f),
         glm::vec3 orientation = glm::vec3(0.0f));
 
+    // Binds the VAO and draws, the caller activates the shader
     void draw();
 
     const std::vector<vertex>& getVertices() const { return vertices; }
+    GLuint vao() const { return VAO; }
+    GLsizei indexCount() const { return static_cast<GLsizei>(indices.size()); }
     const std::vector<GLuint>& getIndices() const { return indices; }
 
 private:
-    std::shared_ptr<ShaderProgram> shader;
     GLuint VAO, VBO, EBO;
     std::vector<vertex> vertices;
     std::vector<GLuint> indices;
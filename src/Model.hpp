@@ -1,73 +1,39 @@
 // Model.hpp
 #pragma once
 
-#include <AnimatedTexture.hpp>
 #include <filesystem>
+#include <memory>
 #include <vector>
 #include "Mesh.hpp"
-#include "ShaderProgram.hpp"
-#include "Texture.hpp"
+#include "ShaderVariants.hpp"
+#include "RenderQueue.hpp"
 
 class Model {
 
 public:
-    std::shared_ptr<Texture> texture;
     std::vector<Mesh> meshes;
     std::string name;
     glm::vec3 origin = glm::vec3(0.0f);
     glm::vec3 orientation = glm::vec3(0.0f);
-    glm::vec3 color = glm::vec3(1.0f);
-    GLuint textureID = 0;
-    glm::vec3 position = glm::vec3(0.0f);
-    glm::vec3 rotation = glm::vec3(0.0f);
-    glm::vec3 scale = glm::vec3(1.0f);
-    std::unique_ptr<AnimatedTexture> animatedTexture;
-    bool isAnimated = false;
 
-    void setColor(const glm::vec3& color) {
-        this->color = color;
-        useColor = true;
-    }
+    // Radius of a sphere around the origin containing all vertices, before scaling
+    float boundingRadius = 0.0f;
 
-    bool transparent = false;
+    // Mesh asset shared by every scene entity that draws it. Transforms, materials and
+    // per-instance light lists live in the Scene components.
+    Model(const std::filesystem::path& path, std::shared_ptr<ShaderVariants> shaders);
 
-    bool hasAnimatedTexture() const {
-        return isAnimated;
-    }
+    Model(const Model&) = delete;
+    Model& operator=(const Model&) = delete;
 
-    bool hasTransparency() const {
-        // Transparent if either:
-        // 1. The object has alpha < 1.0, OR
-        // 2. It has a texture with alpha channel
-        return alpha < 0.99f || (texture && texture->hasAlpha());
-    }
-
-    float alpha = 1.0f; // 1.0 = fully opaque, 0.0 = fully transparent
-
-    float getTransparency() const;
-
-    void setTransparency(float alphaValue) {
-        alpha = glm::clamp(alphaValue, 0.0f, 1.0f);
-        transparent = (alpha < 0.99f); // Consider slightly transparent as transparent
-    }
-
-    // Animations
-    bool setAnimatedTexture(const std::string& path);
-    void update(float deltaTime) {
-        if (animatedTexture) {
-            animatedTexture->update(deltaTime);
-        }
-    }
-
-    Model() = default;
-
-    Model(const std::filesystem::path& path, std::shared_ptr<ShaderProgram> shader);
-
-    bool setTexture(const std::string& path);
-
-    void draw();
+    // Queues one instance with the given MaterialTable entry, lit by pointLightCount lights
+    // from pointLightIndices. alphaTest picks the ALPHA_TEST variant, for materials that have
+    // the flag. The matrices and light indices are referenced, not copied, until the queue
+    // is submitted.
+    void enqueue(RenderQueue& queue, RenderPass pass, std::uint32_t material,
+                 const glm::mat4& world, const glm::mat4& normal,
+                 const int* pointLightIndices, int pointLightCount, float depth01, bool alphaTest = false);
 
 private:
-    std::shared_ptr<ShaderProgram> shader;
-    bool useColor = false;
-};
\ No newline at end of file
+    std::shared_ptr<ShaderVariants> shaders;
+};
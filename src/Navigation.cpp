@@ -0,0 +1,340 @@
+// Navigation.cpp
+#include "Navigation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NAVIGATION_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+    constexpr size_t STEER_BLOCK = 256;
+    constexpr float ARRIVE_GAIN = 4.0f; // speed per grid unit left to the target's center
+
+    bool walkable(const MazeGrid& grid, const glm::ivec2& p) {
+        return p.x >= 0 && p.y >= 0 && p.x < grid.width() && p.y < grid.height() && !grid.isWall(p.x, p.y);
+    }
+
+    std::uint32_t manhattan(const glm::ivec2& a, const glm::ivec2& b) {
+        return static_cast<std::uint32_t>(std::abs(a.x - b.x) + std::abs(a.y - b.y));
+    }
+}
+
+/////////////////// JumpPointSearch /////////////////////////////
+bool JumpPointSearch::findPath(const MazeGrid& grid, const glm::ivec2& start, const glm::ivec2& goal,
+                               std::vector<glm::ivec2>& path) {
+    path.clear();
+    m_expanded = 0;
+    if (!walkable(grid, start) || !walkable(grid, goal)) return false;
+
+    const size_t nodes = static_cast<size_t>(grid.width()) * grid.height();
+    if (m_stamp.size() != nodes || ++m_query == 0) {
+        m_stamp.assign(nodes, 0);
+        m_g.resize(nodes);
+        m_parent.resize(nodes);
+        m_closed.assign(nodes, 0);
+        m_query = 1;
+    }
+    m_width = grid.width();
+    m_open.clear();
+
+    auto positionOf = [&](std::uint32_t index) { return glm::ivec2(index % m_width, index / m_width); };
+    auto indexOf = [&](const glm::ivec2& p) { return static_cast<std::uint32_t>(p.y) * m_width + p.x; };
+    auto later = [](const OpenNode& a, const OpenNode& b) { return a.f > b.f; };
+
+    const std::uint32_t startIndex = indexOf(start), goalIndex = indexOf(goal);
+    push(startIndex, 0, startIndex, start, goal);
+
+    while (!m_open.empty()) {
+        std::pop_heap(m_open.begin(), m_open.end(), later);
+        const std::uint32_t current = m_open.back().index;
+        m_open.pop_back();
+        if (m_closed[current] == m_query) continue;
+        m_closed[current] = m_query;
+        m_expanded++;
+
+        if (current == goalIndex) {
+            // Consecutive jump points are on one line, fill in the positions between them
+            for (std::uint32_t node = goalIndex; ; node = m_parent[node]) {
+                glm::ivec2 from = positionOf(node), to = positionOf(m_parent[node]);
+                glm::ivec2 step = glm::sign(to - from);
+                for (glm::ivec2 p = from; p != to; p += step) path.push_back(p);
+                if (node == startIndex) break;
+            }
+            path.push_back(start);
+            std::reverse(path.begin(), path.end());
+            return true;
+        }
+
+        // Successors allowed by the direction the node was reached in
+        const glm::ivec2 position = positionOf(current);
+        const glm::ivec2 arrival = glm::sign(position - positionOf(m_parent[current]));
+        glm::ivec2 steps[4];
+        int count = 0;
+        if (arrival == glm::ivec2(0)) {
+            for (std::uint8_t dir = 0; dir < 4; dir++) steps[count++] = directionOffset(dir);
+        } else if (arrival.x != 0) {
+            steps[count++] = arrival;
+            for (int v = -1; v <= 1; v += 2) {
+                if (walkable(grid, position + glm::ivec2(0, v)) && !walkable(grid, position - arrival + glm::ivec2(0, v))) {
+                    steps[count++] = glm::ivec2(0, v);
+                }
+            }
+        } else {
+            steps[count++] = arrival;
+            steps[count++] = glm::ivec2(1, 0);
+            steps[count++] = glm::ivec2(-1, 0);
+        }
+
+        for (int s = 0; s < count; s++) {
+            glm::ivec2 jumpPoint;
+            if (!jump(grid, position, steps[s], goal, jumpPoint)) continue;
+            push(indexOf(jumpPoint), m_g[current] + manhattan(position, jumpPoint), current, jumpPoint, goal);
+        }
+    }
+    return false;
+}
+
+bool JumpPointSearch::jump(const MazeGrid& grid, glm::ivec2 position, const glm::ivec2& step, const glm::ivec2& goal,
+                           glm::ivec2& found) const {
+    while (true) {
+        position += step;
+        if (!walkable(grid, position)) return false;
+        if (position == goal) break;
+
+        if (step.x != 0) {
+            // A vertical passage that the position behind doesn't have
+            bool forced = false;
+            for (int v = -1; v <= 1; v += 2) {
+                forced |= walkable(grid, position + glm::ivec2(0, v)) && !walkable(grid, position - step + glm::ivec2(0, v));
+            }
+            if (forced) break;
+        } else {
+            // Horizontal runs branch off every vertical step
+            glm::ivec2 branch;
+            if (jump(grid, position, glm::ivec2(1, 0), goal, branch) || jump(grid, position, glm::ivec2(-1, 0), goal, branch)) break;
+        }
+    }
+    found = position;
+    return true;
+}
+
+void JumpPointSearch::push(std::uint32_t index, std::uint32_t g, std::uint32_t parent, const glm::ivec2& position,
+                           const glm::ivec2& goal) {
+    if (m_stamp[index] == m_query && (m_closed[index] == m_query || g >= m_g[index])) return;
+    m_stamp[index] = m_query;
+    m_g[index] = g;
+    m_parent[index] = parent;
+    m_open.push_back({g + manhattan(position, goal), index});
+    std::push_heap(m_open.begin(), m_open.end(), [](const OpenNode& a, const OpenNode& b) { return a.f > b.f; });
+}
+
+/////////////////// FlowField /////////////////////////////
+void FlowField::build(const MazeGrid& grid, const glm::ivec2& target) {
+    m_width = grid.width();
+    m_height = grid.height();
+    m_target = target;
+    const size_t nodes = static_cast<size_t>(m_width) * m_height;
+    m_distance.assign(nodes, UNREACHABLE);
+    m_direction.assign(nodes, NO_DIRECTION);
+    m_queue.clear();
+    m_settled = 0;
+    if (!open(grid, target.x, target.y)) return;
+
+    m_distance[index(target.x, target.y)] = 0;
+    m_queue.push_back(static_cast<std::uint32_t>(index(target.x, target.y)));
+    for (size_t head = 0; head < m_queue.size(); head++) {
+        const std::uint32_t current = m_queue[head];
+        const int x = static_cast<int>(current % m_width), y = static_cast<int>(current / m_width);
+        const std::uint32_t next = m_distance[current] + 1;
+        for (std::uint8_t dir = 0; dir < 4; dir++) {
+            const int nx = x + directionOffset(dir).x, ny = y + directionOffset(dir).y;
+            if (!contains(nx, ny)) continue;
+            const size_t neighbour = index(nx, ny);
+            // Distance first, it rules out most neighbours without touching the grid
+            if (m_distance[neighbour] != UNREACHABLE || grid.isWall(nx, ny)) continue;
+            m_distance[neighbour] = next;
+            m_direction[neighbour] = dir ^ 2; // back the way the search came
+            m_queue.push_back(static_cast<std::uint32_t>(neighbour));
+        }
+    }
+    m_settled = m_queue.size();
+}
+
+void FlowField::buildAll(const MazeGrid& grid, const std::vector<glm::ivec2>& targets,
+                         std::vector<FlowField>& fields, ThreadPool& pool) {
+    fields.resize(targets.size());
+    pool.run(targets.size(), [&](size_t i) {
+        fields[i].build(grid, targets[i]);
+    });
+}
+
+void FlowField::update(const MazeGrid& grid, const std::vector<glm::ivec2>& changed) {
+    if (grid.width() != m_width || grid.height() != m_height || !open(grid, m_target.x, m_target.y)) {
+        build(grid, m_target);
+        return;
+    }
+
+    // New walls lose their distance, opened positions need one
+    m_queue.clear();
+    for (const glm::ivec2& p : changed) {
+        if (!contains(p.x, p.y)) continue;
+        const size_t i = index(p.x, p.y);
+        if (grid.isWall(p.x, p.y) ? m_distance[i] != UNREACHABLE : m_distance[i] == UNREACHABLE) {
+            m_distance[i] = UNREACHABLE;
+            m_direction[i] = NO_DIRECTION;
+            m_queue.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+
+    // Everything whose first step led into an invalidated position is invalid too
+    for (size_t head = 0; head < m_queue.size(); head++) {
+        const std::uint32_t current = m_queue[head];
+        const glm::ivec2 p(current % m_width, current / m_width);
+        for (std::uint8_t dir = 0; dir < 4; dir++) {
+            const glm::ivec2 n = p + directionOffset(dir);
+            if (!contains(n.x, n.y)) continue;
+            const size_t neighbour = index(n.x, n.y);
+            if (m_distance[neighbour] == UNREACHABLE || m_direction[neighbour] != (dir ^ 2)) continue;
+            m_distance[neighbour] = UNREACHABLE;
+            m_direction[neighbour] = NO_DIRECTION;
+            m_queue.push_back(static_cast<std::uint32_t>(neighbour));
+        }
+    }
+
+    // Seed the invalidated and opened positions from their valid neighbours, then settle
+    // outwards in distance order. Any distance only ever drops towards the true one.
+    auto later = std::greater<std::uint64_t>();
+    m_heap.clear();
+    for (std::uint32_t current : m_queue) {
+        const glm::ivec2 p(current % m_width, current / m_width);
+        if (grid.isWall(p.x, p.y)) continue;
+        for (std::uint8_t dir = 0; dir < 4; dir++) {
+            const glm::ivec2 n = p + directionOffset(dir);
+            if (!open(grid, n.x, n.y)) continue;
+            const std::uint32_t d = m_distance[index(n.x, n.y)];
+            if (d != UNREACHABLE && d + 1 < m_distance[current]) {
+                m_distance[current] = d + 1;
+                m_direction[current] = dir;
+            }
+        }
+        if (m_distance[current] != UNREACHABLE) {
+            m_heap.push_back((static_cast<std::uint64_t>(m_distance[current]) << 32) | current);
+        }
+    }
+    std::make_heap(m_heap.begin(), m_heap.end(), later);
+
+    m_settled = 0;
+    while (!m_heap.empty()) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), later);
+        const std::uint64_t entry = m_heap.back();
+        m_heap.pop_back();
+        const std::uint32_t current = static_cast<std::uint32_t>(entry);
+        const std::uint32_t d = static_cast<std::uint32_t>(entry >> 32);
+        if (d != m_distance[current]) continue;
+        m_settled++;
+
+        const glm::ivec2 p(current % m_width, current / m_width);
+        for (std::uint8_t dir = 0; dir < 4; dir++) {
+            const glm::ivec2 n = p + directionOffset(dir);
+            if (!open(grid, n.x, n.y)) continue;
+            const size_t neighbour = index(n.x, n.y);
+            if (d + 1 >= m_distance[neighbour]) continue;
+            m_distance[neighbour] = d + 1;
+            m_direction[neighbour] = dir ^ 2;
+            m_heap.push_back((static_cast<std::uint64_t>(d + 1) << 32) | neighbour);
+            std::push_heap(m_heap.begin(), m_heap.end(), later);
+        }
+    }
+}
+
+/////////////////// Steering /////////////////////////////
+void NavAgents::add(const glm::vec2& position, std::uint16_t fieldIndex) {
+    x.push_back(position.x);
+    y.push_back(position.y);
+    velocityX.push_back(0.0f);
+    velocityY.push_back(0.0f);
+    field.push_back(fieldIndex);
+}
+
+void NavAgents::clear() {
+    x.clear();
+    y.clear();
+    velocityX.clear();
+    velocityY.clear();
+    field.clear();
+}
+
+void steerAgents(NavAgents& agents, const std::vector<FlowField>& fields, const SteeringSettings& settings,
+                 float dt, size_t begin, size_t end) {
+    const float blend = std::min(settings.acceleration * dt, 1.0f);
+    float aimX[STEER_BLOCK], aimY[STEER_BLOCK], cap[STEER_BLOCK];
+
+    for (size_t blockStart = begin; blockStart < end; blockStart += STEER_BLOCK) {
+        const size_t count = std::min(STEER_BLOCK, end - blockStart);
+        float* px = agents.x.data() + blockStart;
+        float* py = agents.y.data() + blockStart;
+        float* vx = agents.velocityX.data() + blockStart;
+        float* vy = agents.velocityY.data() + blockStart;
+        const std::uint16_t* field = agents.field.data() + blockStart;
+
+        // Where each agent is heading: the center of its next position. Agents at the
+        // target (or cut off from it) aim for the center of where they are and may stop.
+        for (size_t k = 0; k < count; k++) {
+            const glm::ivec2 cell(static_cast<int>(std::floor(px[k] + 0.5f)), static_cast<int>(std::floor(py[k] + 0.5f)));
+            const std::uint8_t dir = fields[field[k]].direction(cell.x, cell.y);
+            const glm::ivec2 aim = cell + directionOffset(dir);
+            aimX[k] = static_cast<float>(aim.x);
+            aimY[k] = static_cast<float>(aim.y);
+            cap[k] = dir == NO_DIRECTION ? 0.0f : settings.maxSpeed;
+        }
+
+        // desired = towards aim at full speed, or slowing down on arrival;
+        // velocity turns towards it, position integrates
+        size_t k = 0;
+#ifdef NAVIGATION_SSE
+        const __m128 maxSpeed = _mm_set1_ps(settings.maxSpeed);
+        const __m128 gain = _mm_set1_ps(ARRIVE_GAIN);
+        const __m128 epsilon = _mm_set1_ps(1e-6f);
+        const __m128 blend4 = _mm_set1_ps(blend);
+        const __m128 dt4 = _mm_set1_ps(dt);
+        for (; k + 4 <= count; k += 4) {
+            __m128 x = _mm_loadu_ps(px + k), y = _mm_loadu_ps(py + k);
+            __m128 tx = _mm_sub_ps(_mm_loadu_ps(aimX + k), x);
+            __m128 ty = _mm_sub_ps(_mm_loadu_ps(aimY + k), y);
+            __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(tx, tx), _mm_mul_ps(ty, ty)));
+            __m128 speed = _mm_max_ps(_mm_loadu_ps(cap + k), _mm_min_ps(maxSpeed, _mm_mul_ps(length, gain)));
+            __m128 scale = _mm_div_ps(speed, _mm_max_ps(length, epsilon));
+
+            __m128 velX = _mm_loadu_ps(vx + k), velY = _mm_loadu_ps(vy + k);
+            velX = _mm_add_ps(velX, _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(tx, scale), velX), blend4));
+            velY = _mm_add_ps(velY, _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(ty, scale), velY), blend4));
+            _mm_storeu_ps(vx + k, velX);
+            _mm_storeu_ps(vy + k, velY);
+            _mm_storeu_ps(px + k, _mm_add_ps(x, _mm_mul_ps(velX, dt4)));
+            _mm_storeu_ps(py + k, _mm_add_ps(y, _mm_mul_ps(velY, dt4)));
+        }
+#endif
+        // Remainder (or everything without SSE)
+        for (; k < count; k++) {
+            const float tx = aimX[k] - px[k], ty = aimY[k] - py[k];
+            const float length = std::sqrt(tx * tx + ty * ty);
+            const float speed = std::max(cap[k], std::min(settings.maxSpeed, length * ARRIVE_GAIN));
+            const float scale = speed / std::max(length, 1e-6f);
+            vx[k] += (tx * scale - vx[k]) * blend;
+            vy[k] += (ty * scale - vy[k]) * blend;
+            px[k] += vx[k] * dt;
+            py[k] += vy[k] * dt;
+        }
+    }
+}
+
+void steerAgentsParallel(NavAgents& agents, const std::vector<FlowField>& fields, const SteeringSettings& settings,
+                         float dt, ThreadPool& pool) {
+    // Below a few blocks per thread, handing out ranges costs more than it saves
+    pool.parallelFor(agents.size(), 4 * STEER_BLOCK, [&](size_t begin, size_t end) {
+        steerAgents(agents, fields, settings, dt, begin, end);
+    });
+}
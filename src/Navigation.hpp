@@ -0,0 +1,129 @@
+// Navigation.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "MazeGenerator.hpp"
+#include "ThreadPool.hpp"
+
+// Navigation over a MazeGrid: every open grid position is a node, linked to its four
+// neighbours. Positions outside the grid are blocked.
+
+// Directions: up, right, down, left (same order as the maze carving); NO_DIRECTION at a
+// field's target or where it can't be reached
+constexpr std::uint8_t NO_DIRECTION = 4;
+inline const glm::ivec2& directionOffset(std::uint8_t direction) {
+    static const glm::ivec2 offsets[5] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}, {0, 0}};
+    return offsets[direction];
+}
+
+// Single shortest path queries with jump point search. Straight runs without branches
+// are skipped over in one jump, so only corridor ends and junctions go through the open
+// list. Moves are ordered horizontal first: a horizontal run only stops where a vertical
+// passage opens up next to it, a vertical run stops wherever a horizontal run from it would.
+// Scratch grows to the grid once and is reused between queries.
+class JumpPointSearch {
+public:
+    // Every position of a shortest path from start to goal, both included.
+    // False (and path empty) if either end is blocked or goal can't be reached.
+    bool findPath(const MazeGrid& grid, const glm::ivec2& start, const glm::ivec2& goal, std::vector<glm::ivec2>& path);
+
+    // Jump points taken off the open list by the last query
+    size_t lastExpanded() const { return m_expanded; }
+
+private:
+    struct OpenNode {
+        std::uint32_t f;
+        std::uint32_t index;
+    };
+
+    bool jump(const MazeGrid& grid, glm::ivec2 position, const glm::ivec2& step, const glm::ivec2& goal, glm::ivec2& found) const;
+    void push(std::uint32_t index, std::uint32_t g, std::uint32_t parent, const glm::ivec2& position, const glm::ivec2& goal);
+
+    int m_width = 0;
+    std::vector<std::uint32_t> m_stamp;  // query that last gave the node a g
+    std::vector<std::uint32_t> m_g;
+    std::vector<std::uint32_t> m_parent;
+    std::vector<std::uint32_t> m_closed; // query that took the node off the open list
+    std::vector<OpenNode> m_open;        // binary heap on f
+    std::uint32_t m_query = 0;
+    size_t m_expanded = 0;
+};
+
+// Distance to one target from every open position, by breadth first search, with the
+// direction of the first step towards it. Any number of agents heading for the same
+// target share one field and look their next step up in O(1).
+//
+// When walls change, update() repairs only what the change affects: positions whose
+// route ran through a new wall are invalidated (the subtree behind it in the field) and
+// re-settled from their still valid surroundings, and opened positions spread their
+// shorter distances outwards.
+class FlowField {
+public:
+    static constexpr std::uint32_t UNREACHABLE = UINT32_MAX;
+
+    void build(const MazeGrid& grid, const glm::ivec2& target);
+    // Builds one field per target, spread over the pool's threads. Each search walks a
+    // maze's narrow frontier one step at a time, so fields are what runs in parallel.
+    static void buildAll(const MazeGrid& grid, const std::vector<glm::ivec2>& targets,
+                         std::vector<FlowField>& fields, ThreadPool& pool);
+
+    // Repairs the field after the given positions of grid switched between wall and open
+    void update(const MazeGrid& grid, const std::vector<glm::ivec2>& changed);
+
+    std::uint32_t distance(int x, int y) const {
+        return contains(x, y) ? m_distance[index(x, y)] : UNREACHABLE;
+    }
+    std::uint8_t direction(int x, int y) const {
+        return contains(x, y) ? m_direction[index(x, y)] : NO_DIRECTION;
+    }
+
+    const glm::ivec2& target() const { return m_target; }
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    size_t lastSettled() const { return m_settled; } // positions the last build/update assigned
+    size_t bytes() const { return m_distance.capacity() * sizeof(std::uint32_t) + m_direction.capacity(); }
+
+private:
+    bool contains(int x, int y) const { return x >= 0 && y >= 0 && x < m_width && y < m_height; }
+    size_t index(int x, int y) const { return static_cast<size_t>(y) * m_width + x; }
+    bool open(const MazeGrid& grid, int x, int y) const { return contains(x, y) && !grid.isWall(x, y); }
+
+    int m_width = 0;
+    int m_height = 0;
+    glm::ivec2 m_target = glm::ivec2(0);
+    std::vector<std::uint32_t> m_distance;
+    std::vector<std::uint8_t> m_direction;
+    std::vector<std::uint32_t> m_queue;   // BFS order, then invalidated positions on update
+    std::vector<std::uint64_t> m_heap;    // (distance << 32 | index) while repairing
+    size_t m_settled = 0;
+};
+
+// Agents as parallel arrays, positions in grid units (position (x, y) of the maze is the
+// point (x, y)). Each follows one flow field.
+struct NavAgents {
+    std::vector<float> x, y;
+    std::vector<float> velocityX, velocityY;
+    std::vector<std::uint16_t> field;
+
+    size_t size() const { return x.size(); }
+    void add(const glm::vec2& position, std::uint16_t fieldIndex);
+    void clear();
+};
+
+struct SteeringSettings {
+    float maxSpeed = 4.0f;     // grid units per second
+    float acceleration = 12.0f; // how quickly velocity turns towards the desired one, per second
+};
+
+// Moves agents [begin, end) for one step. Each agent heads for the center of the next
+// position its field points to, which keeps it in the middle of the corridors; at the
+// target it slows down and settles. Agents go in blocks: the field lookups run per agent,
+// then steering and integration four agents at a time with SSE.
+void steerAgents(NavAgents& agents, const std::vector<FlowField>& fields, const SteeringSettings& settings,
+                 float dt, size_t begin, size_t end);
+// Same over all agents, split over the pool's threads
+void steerAgentsParallel(NavAgents& agents, const std::vector<FlowField>& fields, const SteeringSettings& settings,
+                         float dt, ThreadPool& pool);
@@ -1,4 +1,5 @@
 #include "OBJloader.hpp"
+#include "Trace.hpp"
 #include <fstream>
 #include <sstream>
 #include <unordered_map>
@@ -22,6 +23,7 @@ struct VertexHash {
 bool loadOBJ(const std::string& path,
             std::vector<vertex>& out_vertices,
             std::vector<GLuint>& out_indices) {
+    TRACE_SCOPE_DETAIL("loadOBJ", path);
 
     // Clear output containers
     out_vertices.clear();
@@ -0,0 +1,57 @@
+// OffscreenTarget.cpp
+#include "OffscreenTarget.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+OffscreenTarget::OffscreenTarget(int width, int height, int samples)
+    : m_width(std::max(width, 1)), m_height(std::max(height, 1)), m_samples(samples > 1 ? samples : 0) {
+    glCreateRenderbuffers(1, &m_color);
+    glCreateRenderbuffers(1, &m_depth);
+    glNamedRenderbufferStorageMultisample(m_color, m_samples, GL_RGBA8, m_width, m_height);
+    glNamedRenderbufferStorageMultisample(m_depth, m_samples, GL_DEPTH24_STENCIL8, m_width, m_height);
+
+    glCreateFramebuffers(1, &m_framebuffer);
+    glNamedFramebufferRenderbuffer(m_framebuffer, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_color);
+    glNamedFramebufferRenderbuffer(m_framebuffer, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depth);
+    if (glCheckNamedFramebufferStatus(m_framebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        throw std::runtime_error("Offscreen framebuffer is incomplete");
+    }
+
+    if (m_samples > 0) {
+        glCreateRenderbuffers(1, &m_resolveColor);
+        glNamedRenderbufferStorage(m_resolveColor, GL_RGBA8, m_width, m_height);
+        glCreateFramebuffers(1, &m_resolveFramebuffer);
+        glNamedFramebufferRenderbuffer(m_resolveFramebuffer, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_resolveColor);
+        if (glCheckNamedFramebufferStatus(m_resolveFramebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            throw std::runtime_error("Offscreen resolve framebuffer is incomplete");
+        }
+    }
+}
+
+OffscreenTarget::~OffscreenTarget() {
+    glDeleteFramebuffers(1, &m_framebuffer);
+    glDeleteRenderbuffers(1, &m_color);
+    glDeleteRenderbuffers(1, &m_depth);
+    if (m_resolveFramebuffer) glDeleteFramebuffers(1, &m_resolveFramebuffer);
+    if (m_resolveColor) glDeleteRenderbuffers(1, &m_resolveColor);
+}
+
+void OffscreenTarget::bind() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+}
+
+std::vector<std::uint8_t> OffscreenTarget::readPixels() const {
+    GLuint source = m_framebuffer;
+    if (m_samples > 0) {
+        glBlitNamedFramebuffer(m_framebuffer, m_resolveFramebuffer, 0, 0, m_width, m_height,
+                               0, 0, m_width, m_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        source = m_resolveFramebuffer;
+    }
+
+    std::vector<std::uint8_t> pixels(static_cast<size_t>(m_width) * m_height * 4);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, source);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    bind();
+    return pixels;
+}
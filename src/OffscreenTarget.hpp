@@ -0,0 +1,40 @@
+// OffscreenTarget.hpp
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <GL/glew.h>
+
+// Framebuffer object with an RGBA8 color and a depth/stencil renderbuffer, multisampled
+// when samples > 1. Headless contexts have no window to draw to, so rendering goes here
+// instead of the default framebuffer.
+class OffscreenTarget {
+public:
+    // Throws std::runtime_error if the framebuffer isn't complete
+    OffscreenTarget(int width, int height, int samples = 0);
+    ~OffscreenTarget();
+
+    OffscreenTarget(const OffscreenTarget&) = delete;
+    OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+
+    // Binds it for drawing and reading, in place of the default framebuffer
+    void bind() const;
+    // Color of the last frame as RGBA rows, bottom row first like glReadPixels. Multisampled
+    // targets are resolved first. Leaves the target bound.
+    std::vector<std::uint8_t> readPixels() const;
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    int samples() const { return m_samples; }
+
+private:
+    int m_width = 0;
+    int m_height = 0;
+    int m_samples = 0;
+    GLuint m_framebuffer = 0;
+    GLuint m_color = 0;
+    GLuint m_depth = 0;
+    // Single sampled copy a multisampled target resolves into before reading
+    GLuint m_resolveFramebuffer = 0;
+    GLuint m_resolveColor = 0;
+};
@@ -0,0 +1,129 @@
+// Profiler.cpp
+#include "Profiler.hpp"
+#include <algorithm>
+#include <iostream>
+
+float TimingHistory::average() const {
+    if (m_count == 0) return 0.0f;
+    float sum = 0.0f;
+    for (int i = 0; i < m_count; i++) sum += m_values[i];
+    return sum / m_count;
+}
+
+float TimingHistory::max() const {
+    if (m_count == 0) return 0.0f;
+    return *std::max_element(m_values.begin(), m_values.begin() + m_count);
+}
+
+Profiler::~Profiler() {
+    for (Scope& scope : m_scopes) {
+        if (scope.queries[0]) glDeleteQueries(static_cast<GLsizei>(scope.queries.size()), scope.queries.data());
+    }
+}
+
+std::uint32_t Profiler::find(const char* name) {
+    for (size_t i = 0; i < m_scopes.size(); i++) {
+        if (m_scopes[i].name == name) return static_cast<std::uint32_t>(i);
+    }
+    Scope& scope = m_scopes.emplace_back();
+    scope.name = name;
+    scope.depth = static_cast<int>(m_cpuStack.size());
+    return static_cast<std::uint32_t>(m_scopes.size() - 1);
+}
+
+void Profiler::beginFrame() {
+    if (m_enabled != m_enableNext) {
+        m_enabled = m_enableNext;
+        m_frame = 0; // the pause isn't a frame
+    }
+    if (!m_enabled) return;
+    if (!m_cpuStack.empty() || m_gpuDepth != 0) {
+        std::cerr << "Warning: profiler scopes left open across frames\n";
+        m_cpuStack.clear();
+        if (m_gpuTiming) glEndQuery(GL_TIME_ELAPSED);
+        m_gpuDepth = 0;
+        m_gpuTiming = false;
+    }
+
+    const Clock::time_point now = Clock::now();
+    if (m_frame > 0) {
+        m_frameCpuMs.push(static_cast<float>(std::chrono::duration<double, std::milli>(now - m_frameStart).count()));
+    }
+    m_frameStart = now;
+    m_frame++;
+
+    // This frame's query slot was last used two frames ago
+    const size_t slot = m_frame & 1;
+    float gpuTotal = 0.0f;
+    bool gpuCollected = false;
+    for (Scope& scope : m_scopes) {
+        if (scope.cpu) {
+            scope.cpuMs.push(static_cast<float>(scope.cpuFrameMs));
+            scope.calls = scope.cpuFrameCalls;
+            scope.cpuFrameMs = 0.0;
+            scope.cpuFrameCalls = 0;
+        }
+        if (!scope.pending[slot]) continue;
+
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(scope.queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue;
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(scope.queries[slot], GL_QUERY_RESULT, &elapsed);
+        scope.pending[slot] = false;
+        const float ms = static_cast<float>(elapsed / 1.0e6);
+        scope.gpuMs.push(ms);
+        gpuTotal += ms;
+        gpuCollected = true;
+    }
+    if (gpuCollected) m_frameGpuMs.push(gpuTotal);
+}
+
+void Profiler::beginCpu(const char* name) {
+    if (!m_enabled) return;
+    const std::uint32_t index = find(name);
+    m_scopes[index].cpu = true;
+    m_cpuStack.push_back({index, Clock::now()});
+}
+
+void Profiler::endCpu() {
+    if (!m_enabled || m_cpuStack.empty()) return;
+    const OpenScope open = m_cpuStack.back();
+    m_cpuStack.pop_back();
+    Scope& scope = m_scopes[open.scope];
+    scope.cpuFrameMs += std::chrono::duration<double, std::milli>(Clock::now() - open.start).count();
+    scope.cpuFrameCalls++;
+}
+
+void Profiler::beginGpu(const char* name) {
+    if (!m_enabled) return;
+    if (m_gpuDepth++ > 0) {
+        if (!m_nestingWarned) {
+            std::cerr << "Warning: GPU scope " << name << " is nested in another, only the outer one is timed\n";
+            m_nestingWarned = true;
+        }
+        return;
+    }
+
+    const std::uint32_t index = find(name);
+    Scope& scope = m_scopes[index];
+    scope.gpu = true;
+    const size_t slot = m_frame & 1;
+    if (scope.pending[slot]) {
+        // Still in flight from two frames ago, or entered twice this frame
+        m_gpuSkipped++;
+        return;
+    }
+    if (!scope.queries[0]) {
+        glCreateQueries(GL_TIME_ELAPSED, static_cast<GLsizei>(scope.queries.size()), scope.queries.data());
+    }
+    glBeginQuery(GL_TIME_ELAPSED, scope.queries[slot]);
+    scope.pending[slot] = true;
+    m_gpuTiming = true;
+}
+
+void Profiler::endGpu() {
+    if (!m_enabled || m_gpuDepth == 0 || --m_gpuDepth > 0) return;
+    if (m_gpuTiming) glEndQuery(GL_TIME_ELAPSED);
+    m_gpuTiming = false;
+}
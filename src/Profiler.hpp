@@ -0,0 +1,137 @@
+// Profiler.hpp
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <GL/glew.h>
+
+// Last HISTORY per-frame values of one measurement, as a ring
+class TimingHistory {
+public:
+    static constexpr int SIZE = 240;
+
+    void push(float ms) {
+        m_values[m_next] = ms;
+        m_next = (m_next + 1) % SIZE;
+        m_count = std::min(m_count + 1, SIZE);
+    }
+
+    // For ImGui::PlotLines: SIZE values starting at offset(), oldest first
+    const float* values() const { return m_values.data(); }
+    int offset() const { return m_count < SIZE ? 0 : m_next; }
+    int count() const { return m_count; }
+
+    float latest() const { return m_count ? m_values[(m_next + SIZE - 1) % SIZE] : 0.0f; }
+    float average() const;
+    float max() const;
+
+private:
+    std::array<float, SIZE> m_values{};
+    int m_next = 0;
+    int m_count = 0;
+};
+
+// Where each frame's milliseconds go, on the main thread: named CPU scopes timed with
+// steady_clock and GPU scopes timed with GL_TIME_ELAPSED queries, each keeping a rolling
+// history of its per-frame total.
+//
+// CPU scopes nest. GPU scopes can't, GL has one GL_TIME_ELAPSED query active at a time,
+// so they cover the top-level stretches of the frame's GPU work (the render passes).
+// Every GPU scope has two queries used on alternating frames, and beginFrame() reads a
+// query back two frames after it was issued, only once its result is available, so the
+// profiler never waits on the GPU. A scope whose query isn't back yet sits that frame out.
+//
+// Scopes are told apart by name pointer, so names should be string literals.
+class Profiler {
+public:
+    struct Scope {
+        const char* name = nullptr;
+        int depth = 0; // CPU scopes open when first entered, for indenting
+        bool cpu = false, gpu = false; // kinds it has been used as
+        TimingHistory cpuMs;
+        TimingHistory gpuMs; // lags the CPU timings by two frames
+        int calls = 0;       // CPU entries last frame
+
+        // This frame
+        double cpuFrameMs = 0.0;
+        int cpuFrameCalls = 0;
+        std::array<GLuint, 2> queries{};
+        std::array<bool, 2> pending{};
+    };
+
+    Profiler() = default;
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // Closes the last frame into the histories and collects finished GPU queries
+    void beginFrame();
+
+    void beginCpu(const char* name);
+    void endCpu();
+    void beginGpu(const char* name);
+    void endGpu();
+
+    // Disabled, begin/end return right away and histories stop. Takes effect at the next
+    // beginFrame(), so no scope is left open.
+    void setEnabled(bool enabled) { m_enableNext = enabled; }
+    bool enabled() const { return m_enableNext; }
+
+    const std::vector<Scope>& scopes() const { return m_scopes; }
+    const TimingHistory& frameCpuMs() const { return m_frameCpuMs; }
+    // Sum of the GPU scopes collected each frame
+    const TimingHistory& frameGpuMs() const { return m_frameGpuMs; }
+    // GPU scopes skipped because their query from two frames ago wasn't back
+    size_t gpuSkipped() const { return m_gpuSkipped; }
+
+    // Scoped markers: profile the enclosing block
+    class CpuScope {
+    public:
+        CpuScope(Profiler& profiler, const char* name) : m_profiler(profiler) { m_profiler.beginCpu(name); }
+        ~CpuScope() { m_profiler.endCpu(); }
+        CpuScope(const CpuScope&) = delete;
+        CpuScope& operator=(const CpuScope&) = delete;
+
+    private:
+        Profiler& m_profiler;
+    };
+
+    class GpuScope {
+    public:
+        GpuScope(Profiler& profiler, const char* name) : m_profiler(profiler) { m_profiler.beginGpu(name); }
+        ~GpuScope() { m_profiler.endGpu(); }
+        GpuScope(const GpuScope&) = delete;
+        GpuScope& operator=(const GpuScope&) = delete;
+
+    private:
+        Profiler& m_profiler;
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct OpenScope {
+        std::uint32_t scope;
+        Clock::time_point start;
+    };
+
+    std::uint32_t find(const char* name);
+
+    std::vector<Scope> m_scopes;
+    std::vector<OpenScope> m_cpuStack;
+    int m_gpuDepth = 0;      // GPU scopes open, only the outermost is timed
+    bool m_gpuTiming = false; // outermost one has its query active
+    bool m_nestingWarned = false;
+    std::uint64_t m_frame = 0;
+    Clock::time_point m_frameStart{};
+    TimingHistory m_frameCpuMs;
+    TimingHistory m_frameGpuMs;
+    size_t m_gpuSkipped = 0;
+    bool m_enabled = true;
+    bool m_enableNext = true;
+};
@@ -0,0 +1,211 @@
+// RenderQueue.cpp
+#include "RenderQueue.hpp"
+#include "ShaderProgram.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    constexpr std::uint64_t DEPTH_MAX = (1ull << 24) - 1;
+    constexpr std::uint64_t PROGRAM_MASK = (1ull << 12) - 1;
+    constexpr std::uint64_t MATERIAL_MASK = (1ull << 16) - 1;
+    constexpr std::uint64_t MESH_MASK = (1ull << 10) - 1;
+    constexpr const char* PASS_NAMES[] = {"Background pass", "Opaque pass", "Transparent pass"};
+}
+
+std::uint64_t RenderQueue::makeKey(RenderPass pass, std::uint32_t program, std::uint32_t material,
+                                   std::uint32_t mesh, float depth01) {
+    std::uint64_t depth = static_cast<std::uint64_t>(std::clamp(depth01, 0.0f, 1.0f) * DEPTH_MAX);
+    std::uint64_t key = static_cast<std::uint64_t>(pass) << 62;
+
+    if (pass == RenderPass::Transparent) {
+        // Blending needs back to front order, state only breaks ties
+        key |= (DEPTH_MAX - depth) << 38;
+        key |= (program & PROGRAM_MASK) << 26;
+        key |= (material & MATERIAL_MASK) << 10;
+        key |= mesh & MESH_MASK;
+    } else {
+        // Group by state, front to back inside a group for early-z
+        key |= (program & PROGRAM_MASK) << 50;
+        key |= (material & MATERIAL_MASK) << 34;
+        key |= (mesh & MESH_MASK) << 24;
+        key |= depth;
+    }
+    return key;
+}
+
+RenderQueue::RenderQueue(std::pmr::memory_resource* frameMemory)
+    : m_packets(frameMemory), m_order(frameMemory), m_scratch(frameMemory) {}
+
+void RenderQueue::clear() {
+    // The old storage went with the arena reset, so it's dropped rather than reused.
+    // Reserving last frame's count keeps the vectors from growing (and leaving dead
+    // copies in the arena) on the way up.
+    const size_t expected = m_packets.size();
+    m_packets = std::pmr::vector<DrawPacket>(m_packets.get_allocator());
+    m_order = std::pmr::vector<SortEntry>(m_order.get_allocator());
+    m_scratch = std::pmr::vector<SortEntry>(m_scratch.get_allocator());
+    m_packets.reserve(expected);
+    m_order.reserve(expected);
+    m_scratch.reserve(expected);
+}
+
+void RenderQueue::sort() {
+    const size_t count = m_packets.size();
+    m_order.resize(count);
+    m_scratch.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        m_order[i] = {m_packets[i].key, static_cast<std::uint32_t>(i)};
+    }
+
+    // LSD radix sort, one byte per pass. Stable, so equal keys keep submission order.
+    // A byte every key shares (common for the unused high bits of small ids) is skipped.
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t histogram[256] = {};
+        for (const SortEntry& entry : m_order) {
+            histogram[(entry.key >> shift) & 0xFF]++;
+        }
+        if (count == 0 || histogram[(m_order[0].key >> shift) & 0xFF] == count) continue;
+
+        size_t offset = 0;
+        for (size_t& bucket : histogram) {
+            size_t size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+        for (const SortEntry& entry : m_order) {
+            m_scratch[histogram[(entry.key >> shift) & 0xFF]++] = entry;
+        }
+        m_order.swap(m_scratch);
+    }
+}
+
+void RenderQueue::applyPass(RenderPass pass) {
+    switch (pass) {
+        case RenderPass::Background:
+            glDisable(GL_DEPTH_TEST);
+            glDisable(GL_BLEND);
+            glDepthMask(GL_TRUE);
+            break;
+        case RenderPass::Opaque:
+            glEnable(GL_DEPTH_TEST);
+            glDisable(GL_BLEND);
+            glDepthMask(GL_TRUE);
+            break;
+        case RenderPass::Transparent:
+            glEnable(GL_DEPTH_TEST);
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glDepthMask(GL_FALSE);
+            break;
+    }
+}
+
+RenderQueue::UniformCache& RenderQueue::uniformCache(const ShaderProgram* program) {
+    for (UniformCache& cache : m_uniformCaches) {
+        if (cache.program == program) return cache;
+    }
+    m_uniformCaches.push_back({});
+    m_uniformCaches.back().program = program;
+    return m_uniformCaches.back();
+}
+
+void RenderQueue::submit(Profiler* profiler) {
+    m_stats = {};
+    m_stats.packets = m_packets.size();
+
+    // Other code (ImGui) touches GL between frames, so nothing carries over
+    m_uniformCaches.clear();
+    const ShaderProgram* boundProgram = nullptr;
+    GLuint boundVao = 0;
+    int currentPass = -1;
+
+    for (const SortEntry& entry : m_order) {
+        const DrawPacket& packet = m_packets[entry.index];
+        if (!packet.program) continue;
+
+        int pass = static_cast<int>(packet.key >> 62);
+        if (pass != currentPass) {
+            if (profiler) {
+                if (currentPass >= 0) profiler->endGpu();
+                profiler->beginGpu(PASS_NAMES[pass]);
+            }
+            applyPass(static_cast<RenderPass>(pass));
+            currentPass = pass;
+            m_stats.passChanges++;
+        }
+
+        if (packet.program != boundProgram) {
+            packet.program->activate();
+            boundProgram = packet.program;
+            m_stats.programBinds++;
+        } else {
+            m_stats.programSkipped++;
+        }
+
+        if (packet.vao != boundVao) {
+            glBindVertexArray(packet.vao);
+            boundVao = packet.vao;
+            m_stats.vaoBinds++;
+        } else {
+            m_stats.vaoSkipped++;
+        }
+
+        // Uniform values belong to the program, so they are compared per program
+        UniformCache& cache = uniformCache(packet.program);
+        auto upload = [this](bool changed, auto&& set) {
+            if (changed) {
+                set();
+                m_stats.uniformUploads++;
+            } else {
+                m_stats.uniformSkipped++;
+            }
+        };
+
+        upload(cache.world != packet.world, [&] {
+            packet.program->setUniform("model", *packet.world);
+            cache.world = packet.world;
+        });
+        upload(cache.normal != packet.normal, [&] {
+            packet.program->setUniform("normalMatrix", glm::mat3(*packet.normal));
+            cache.normal = packet.normal;
+        });
+        upload(cache.material != packet.material, [&] {
+            packet.program->setUniform("materialId", static_cast<int>(packet.material));
+            cache.material = packet.material;
+        });
+
+        int lightCount = std::min(packet.lightCount, MAX_POINT_LIGHTS);
+        if (lightCount > 0) {
+            bool sameLights = cache.lightCount == lightCount &&
+                std::memcmp(cache.lightIndices.data(), packet.lightIndices, lightCount * sizeof(int)) == 0;
+            upload(!sameLights, [&] {
+                packet.program->setUniform("pointLightIndices", packet.lightIndices, lightCount);
+                std::copy_n(packet.lightIndices, lightCount, cache.lightIndices.begin());
+                cache.lightCount = lightCount;
+            });
+        }
+
+        if (packet.instanceBuffer) {
+            glBindBufferRange(GL_SHADER_STORAGE_BUFFER, INSTANCES_SSBO_BINDING, packet.instanceBuffer,
+                              packet.instanceOffset, packet.instanceSize);
+        }
+        if (packet.timestamps[0]) glQueryCounter(packet.timestamps[0], GL_TIMESTAMP);
+        const std::uintptr_t indexSize = packet.indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+        const void* indices = reinterpret_cast<const void*>(static_cast<std::uintptr_t>(packet.firstIndex) * indexSize);
+        if (packet.instanceCount != 1) {
+            glDrawElementsInstancedBaseVertex(packet.primitive, packet.indexCount, packet.indexType, indices,
+                                              packet.instanceCount, packet.baseVertex);
+        } else {
+            glDrawElementsBaseVertex(packet.primitive, packet.indexCount, packet.indexType, indices, packet.baseVertex);
+        }
+        if (packet.timestamps[1]) glQueryCounter(packet.timestamps[1], GL_TIMESTAMP);
+    }
+    if (profiler && currentPass >= 0) profiler->endGpu();
+
+    // Leave the default state the rest of the frame expects
+    glBindVertexArray(0);
+    glEnable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glDepthMask(GL_TRUE);
+}
@@ -0,0 +1,115 @@
+// RenderQueue.hpp
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include "FrameUniforms.hpp"
+
+class ShaderProgram;
+class Profiler;
+
+// Passes in submission order, each sets its own depth/blend state
+enum class RenderPass : std::uint8_t {
+    Background = 0, // depth test off (the sun)
+    Opaque = 1,
+    Transparent = 2 // blended, no depth writes
+};
+
+// Everything one draw needs. Pointers must stay valid until submit().
+struct DrawPacket {
+    std::uint64_t key = 0;
+    ShaderProgram* program = nullptr;
+    GLuint vao = 0;
+    GLsizei indexCount = 0;
+    GLsizei firstIndex = 0;     // into the VAO's element buffer
+    GLint baseVertex = 0;       // added to every index
+    GLenum indexType = GL_UNSIGNED_INT; // or GL_UNSIGNED_SHORT
+    GLenum primitive = GL_TRIANGLES; // GL_PATCHES for tessellated draws, patch size set by the caller
+    std::uint32_t material = 0; // MaterialTable entry, the table and its textures are bound once per frame
+    const glm::mat4* world = nullptr;
+    const glm::mat4* normal = nullptr; // Upper 3x3 is uploaded as normalMatrix
+    const int* lightIndices = nullptr;
+    int lightCount = 0;
+    // Instanced draws: any instanceCount but 1 draws with glDrawElementsInstanced, and a non-zero
+    // instanceBuffer range is bound to INSTANCES_SSBO_BINDING first (world/normal still set
+    // the uniforms, the INSTANCED shader variant ignores them)
+    GLsizei instanceCount = 1;
+    GLuint instanceBuffer = 0;
+    GLintptr instanceOffset = 0;
+    GLsizeiptr instanceSize = 0;
+    // GL_TIMESTAMP queries written right before and after just this draw, 0 = none. Timestamps
+    // rather than GL_TIME_ELAPSED, which can't nest in the profiler's per-pass queries.
+    std::array<GLuint, 2> timestamps{};
+};
+
+// Collects draw packets for a frame, orders them by a 64-bit sort key with a radix sort
+// and submits them, skipping every program, VAO and uniform change that would set what
+// is already bound. Materials are table rows, so switching one is a single integer uniform.
+//
+// Key layout, most significant bits first:
+//   opaque/background:  pass:2 | program:12 | material:16 | mesh:10 | depth:24 (front to back)
+//   transparent:        pass:2 | depth:24 (back to front) | program:12 | material:16 | mesh:10
+// Ids wider than their field are truncated, which only affects grouping, never correctness.
+//
+// Packets and sort entries live in frameMemory, normally the app's FrameArena, which must be
+// reset between one frame's submit() and the next frame's clear().
+class RenderQueue {
+public:
+    struct Stats {
+        size_t packets = 0;
+        size_t programBinds = 0, programSkipped = 0;
+        size_t vaoBinds = 0, vaoSkipped = 0;
+        size_t uniformUploads = 0, uniformSkipped = 0;
+        size_t passChanges = 0;
+
+        size_t saved() const { return programSkipped + vaoSkipped + uniformSkipped; }
+    };
+
+    // program is ShaderProgram::sortId(), depth01 the view distance divided by the far plane
+    static std::uint64_t makeKey(RenderPass pass, std::uint32_t program, std::uint32_t material,
+                                 std::uint32_t mesh, float depth01);
+
+    explicit RenderQueue(std::pmr::memory_resource* frameMemory = std::pmr::get_default_resource());
+
+    // Drops last frame's packets and their storage, reserving as many on fresh frame memory
+    void clear();
+    void push(const DrawPacket& packet) { m_packets.push_back(packet); }
+
+    void sort();
+    // Issues the sorted packets; GL bindings are assumed unknown at the start. With a
+    // profiler, every pass is a GPU scope of its own.
+    void submit(Profiler* profiler = nullptr);
+
+    size_t size() const { return m_packets.size(); }
+    const Stats& stats() const { return m_stats; }
+
+private:
+    struct SortEntry {
+        std::uint64_t key;
+        std::uint32_t index;
+    };
+
+    // Last values uploaded to one program's uniforms this frame
+    struct UniformCache {
+        const ShaderProgram* program = nullptr;
+        const glm::mat4* world = nullptr;
+        const glm::mat4* normal = nullptr;
+        std::array<int, MAX_POINT_LIGHTS> lightIndices{};
+        int lightCount = -1;
+        std::int64_t material = -1;
+    };
+
+    void applyPass(RenderPass pass);
+    UniformCache& uniformCache(const ShaderProgram* program);
+
+    std::pmr::vector<DrawPacket> m_packets;
+    std::pmr::vector<SortEntry> m_order;
+    std::pmr::vector<SortEntry> m_scratch;
+    std::vector<UniformCache> m_uniformCaches;
+    Stats m_stats;
+};
@@ -0,0 +1,273 @@
+// Scene.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Handle to an entity in an EntityStore. The generation is bumped every time a slot is
+// reused, so a handle to a destroyed entity is detected instead of aliasing a new one.
+struct Entity {
+    std::uint32_t index = UINT32_MAX;
+    std::uint32_t generation = 0;
+
+    bool valid() const { return index != UINT32_MAX; }
+    bool operator==(const Entity&) const = default;
+};
+
+// Archetype based entity/component storage over a fixed list of component types.
+// Entities with the same set of components share an archetype, which keeps one dense
+// array per component. A query walks the matching archetypes and streams through their
+// arrays linearly, never touching entities that lack one of the requested components.
+// Adding or removing a component moves the entity's row to another archetype.
+// Creating, destroying or changing components invalidates rows, so don't do it inside each().
+template <typename... Components>
+class EntityStore {
+    static_assert(sizeof...(Components) <= 32, "component mask is 32 bits wide");
+
+public:
+    using Mask = std::uint32_t;
+
+    template <typename C>
+    static constexpr Mask bit() {
+        static_assert((std::is_same_v<C, Components> || ...), "type is not a component of this store");
+        return Mask(1) << indexOf<C>();
+    }
+
+    template <typename... Cs>
+    static constexpr Mask maskOf() { return (Mask(0) | ... | bit<Cs>()); }
+
+    template <typename... Cs>
+    Entity create(Cs... components) {
+        Entity entity = allocateSlot();
+        std::uint32_t archetypeIndex = findOrCreateArchetype(maskOf<Cs...>());
+        Archetype& archetype = m_archetypes[archetypeIndex];
+
+        (column<Cs>(archetype).push_back(std::move(components)), ...);
+        archetype.entities.push_back(entity);
+
+        Slot& slot = m_slots[entity.index];
+        slot.archetype = archetypeIndex;
+        slot.row = static_cast<std::uint32_t>(archetype.entities.size() - 1);
+        m_alive++;
+        return entity;
+    }
+
+    bool destroy(Entity entity) {
+        if (!alive(entity)) return false;
+
+        Slot& slot = m_slots[entity.index];
+        removeRow(m_archetypes[slot.archetype], slot.row);
+        slot.archetype = NO_ARCHETYPE;
+        slot.generation++;
+        m_free.push_back(entity.index);
+        m_alive--;
+        return true;
+    }
+
+    bool alive(Entity entity) const {
+        return entity.index < m_slots.size() &&
+               m_slots[entity.index].generation == entity.generation &&
+               m_slots[entity.index].archetype != NO_ARCHETYPE;
+    }
+
+    template <typename C>
+    bool has(Entity entity) const {
+        return alive(entity) && (m_archetypes[m_slots[entity.index].archetype].mask & bit<C>());
+    }
+
+    // nullptr if the entity is dead or doesn't have the component
+    template <typename C>
+    C* get(Entity entity) {
+        if (!has<C>(entity)) return nullptr;
+        const Slot& slot = m_slots[entity.index];
+        return &column<C>(m_archetypes[slot.archetype])[slot.row];
+    }
+
+    template <typename C>
+    const C* get(Entity entity) const {
+        return const_cast<EntityStore*>(this)->template get<C>(entity);
+    }
+
+    // Adds the component, or overwrites it if the entity already has one
+    template <typename C>
+    void add(Entity entity, C component) {
+        if (!alive(entity)) return;
+        if (C* existing = get<C>(entity)) {
+            *existing = std::move(component);
+            return;
+        }
+        Archetype& target = moveToArchetype(entity, m_archetypes[m_slots[entity.index].archetype].mask | bit<C>());
+        column<C>(target).push_back(std::move(component));
+    }
+
+    template <typename C>
+    void remove(Entity entity) {
+        if (!has<C>(entity)) return;
+        moveToArchetype(entity, m_archetypes[m_slots[entity.index].archetype].mask & ~bit<C>());
+    }
+
+    // Calls fn(Cs&...) or fn(Entity, Cs&...) for every entity that has all of Cs
+    template <typename... Cs, typename Fn>
+    void each(Fn&& fn) {
+        constexpr Mask required = maskOf<Cs...>();
+        for (Archetype& archetype : m_archetypes) {
+            if ((archetype.mask & required) != required || archetype.entities.empty()) continue;
+
+            // Resolve the columns once per archetype, then stream through them
+            const Entity* entities = archetype.entities.data();
+            std::size_t rows = archetype.entities.size();
+            [&](Cs*... columns) {
+                for (std::size_t i = 0; i < rows; i++) {
+                    if constexpr (std::is_invocable_v<Fn&, Entity, Cs&...>) {
+                        fn(entities[i], columns[i]...);
+                    } else {
+                        fn(columns[i]...);
+                    }
+                }
+            }(column<Cs>(archetype).data()...);
+        }
+    }
+
+    template <typename... Cs, typename Fn>
+    void each(Fn&& fn) const {
+        constexpr Mask required = maskOf<Cs...>();
+        for (const Archetype& archetype : m_archetypes) {
+            if ((archetype.mask & required) != required || archetype.entities.empty()) continue;
+
+            const Entity* entities = archetype.entities.data();
+            std::size_t rows = archetype.entities.size();
+            [&](const Cs*... columns) {
+                for (std::size_t i = 0; i < rows; i++) {
+                    if constexpr (std::is_invocable_v<Fn&, Entity, const Cs&...>) {
+                        fn(entities[i], columns[i]...);
+                    } else {
+                        fn(columns[i]...);
+                    }
+                }
+            }(column<Cs>(archetype).data()...);
+        }
+    }
+
+    // Number of entities that have all of Cs
+    template <typename... Cs>
+    std::size_t count() const {
+        constexpr Mask required = maskOf<Cs...>();
+        std::size_t total = 0;
+        for (const Archetype& archetype : m_archetypes) {
+            if ((archetype.mask & required) == required) total += archetype.entities.size();
+        }
+        return total;
+    }
+
+    void clear() {
+        for (Archetype& archetype : m_archetypes) {
+            for (Entity entity : archetype.entities) {
+                m_slots[entity.index].archetype = NO_ARCHETYPE;
+                m_slots[entity.index].generation++;
+                m_free.push_back(entity.index);
+            }
+            archetype.entities.clear();
+            std::apply([](auto&... columns) { (columns.clear(), ...); }, archetype.columns);
+        }
+        m_alive = 0;
+    }
+
+    std::size_t size() const { return m_alive; }
+    std::size_t archetypeCount() const { return m_archetypes.size(); }
+
+private:
+    static constexpr std::uint32_t NO_ARCHETYPE = UINT32_MAX;
+
+    template <typename C>
+    static constexpr std::size_t indexOf() {
+        constexpr bool matches[] = {std::is_same_v<C, Components>...};
+        for (std::size_t i = 0; i < sizeof...(Components); i++) {
+            if (matches[i]) return i;
+        }
+        return sizeof...(Components);
+    }
+
+    struct Slot {
+        std::uint32_t generation = 0;
+        std::uint32_t archetype = NO_ARCHETYPE;
+        std::uint32_t row = 0;
+    };
+
+    // Columns of components outside the mask stay empty
+    struct Archetype {
+        Mask mask = 0;
+        std::vector<Entity> entities;
+        std::tuple<std::vector<Components>...> columns;
+    };
+
+    template <typename C>
+    static std::vector<C>& column(Archetype& archetype) { return std::get<std::vector<C>>(archetype.columns); }
+    template <typename C>
+    static const std::vector<C>& column(const Archetype& archetype) { return std::get<std::vector<C>>(archetype.columns); }
+
+    // Calls fn(column) for every column the archetype's mask includes
+    template <typename Fn>
+    static void forEachColumn(Archetype& archetype, Fn&& fn) {
+        (((archetype.mask & bit<Components>()) ? fn(column<Components>(archetype)) : void()), ...);
+    }
+
+    Entity allocateSlot() {
+        if (!m_free.empty()) {
+            std::uint32_t index = m_free.back();
+            m_free.pop_back();
+            return {index, m_slots[index].generation};
+        }
+        m_slots.emplace_back();
+        return {static_cast<std::uint32_t>(m_slots.size() - 1), 0};
+    }
+
+    std::uint32_t findOrCreateArchetype(Mask mask) {
+        for (std::uint32_t i = 0; i < m_archetypes.size(); i++) {
+            if (m_archetypes[i].mask == mask) return i;
+        }
+        m_archetypes.emplace_back();
+        m_archetypes.back().mask = mask;
+        return static_cast<std::uint32_t>(m_archetypes.size() - 1);
+    }
+
+    // Swap-remove: the last row fills the hole
+    void removeRow(Archetype& archetype, std::uint32_t row) {
+        std::uint32_t last = static_cast<std::uint32_t>(archetype.entities.size() - 1);
+        if (row != last) {
+            Entity moved = archetype.entities[last];
+            archetype.entities[row] = moved;
+            m_slots[moved.index].row = row;
+            forEachColumn(archetype, [row, last](auto& column) { column[row] = std::move(column[last]); });
+        }
+        archetype.entities.pop_back();
+        forEachColumn(archetype, [](auto& column) { column.pop_back(); });
+    }
+
+    // Moves the components the two masks share; the caller pushes any newly added component
+    Archetype& moveToArchetype(Entity entity, Mask mask) {
+        std::uint32_t targetIndex = findOrCreateArchetype(mask); // may reallocate m_archetypes
+        Slot& slot = m_slots[entity.index];
+        Archetype& source = m_archetypes[slot.archetype];
+        Archetype& target = m_archetypes[targetIndex];
+
+        std::uint32_t row = slot.row;
+        (((source.mask & target.mask & bit<Components>())
+              ? column<Components>(target).push_back(std::move(column<Components>(source)[row]))
+              : void()), ...);
+        target.entities.push_back(entity);
+
+        removeRow(source, row);
+        slot.archetype = targetIndex;
+        slot.row = static_cast<std::uint32_t>(target.entities.size() - 1);
+        return target;
+    }
+
+    std::vector<Archetype> m_archetypes;
+    std::vector<Slot> m_slots;
+    std::vector<std::uint32_t> m_free;
+    std::size_t m_alive = 0;
+};
@@ -0,0 +1,67 @@
+// SceneComponents.hpp
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "Scene.hpp"
+#include "TransformStore.hpp"
+#include "CollisionWorld.hpp"
+#include "FrameUniforms.hpp"
+
+class Model;
+
+// Slot in the App's TransformStore, which keeps the actual SoA transform data and matrices
+struct Transform {
+    TransformStore::Id id = TransformStore::INVALID;
+};
+
+// Shared mesh asset, MaterialTable entry and a world space bounding sphere radius for culling
+struct Renderable {
+    Model* model = nullptr;
+    std::uint32_t material = 0;
+    float radius = 0.0f;
+    bool hidden = false; // skipped by rendering, e.g. a maze whose walls are still being spawned
+};
+
+// Point lights reaching the entity, refreshed while building the render list
+struct LightSet {
+    std::array<int, MAX_POINT_LIGHTS> indices{};
+    int count = 0;
+};
+
+// Placement of a moving entity at the last two fixed simulation steps. The simulation
+// writes position/rotation, and before rendering the Transform is set to a blend of the
+// two, so motion looks smooth at any frame rate. Static entities don't need one.
+struct Interpolated {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 rotation = glm::vec3(0.0f);
+    glm::vec3 previousPosition = glm::vec3(0.0f);
+    glm::vec3 previousRotation = glm::vec3(0.0f);
+
+    static Interpolated at(const glm::vec3& position, const glm::vec3& rotation = glm::vec3(0.0f)) {
+        return {position, rotation, position, rotation};
+    }
+};
+
+// Constant rotation in degrees per second, applied to the entity's Interpolated state
+struct Spin {
+    glm::vec3 degreesPerSecond = glm::vec3(0.0f);
+};
+
+// Blocks player movement; the box lives in the CollisionWorld's spatial hash.
+// Maze walls don't need one, the collision grid already covers their cells.
+struct Collider {
+    SpatialHash::Id body = SpatialHash::INVALID;
+};
+
+// Wall of the maze with this number. While a new maze is staged, its walls exist hidden
+// next to the shown ones; on the swap they're shown and the old ones are retired.
+struct MazeWall {
+    std::uint32_t maze = 0;
+};
+
+// Tags
+struct Background {}; // Drawn first with depth testing off, never culled (the sun)
+
+using Scene = EntityStore<Transform, Renderable, LightSet, Interpolated, Spin, Collider, MazeWall, Background>;
@@ -0,0 +1,111 @@
+// ShaderCache.cpp
+#include "ShaderCache.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    constexpr std::uint32_t CACHE_MAGIC = 0x42324750; // "PG2B"
+    constexpr std::uint32_t CACHE_VERSION = 1;
+
+    struct CacheHeader {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint64_t key;
+        std::uint32_t format;
+        std::uint32_t size;
+    };
+
+    // FNV-1a, good enough to tell sources apart and stable across runs
+    std::uint64_t fnv1a(std::uint64_t hash, std::string_view data) {
+        for (unsigned char c : data) {
+            hash ^= c;
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    std::string_view glString(GLenum name) {
+        const char* str = reinterpret_cast<const char*>(glGetString(name));
+        return str ? std::string_view(str) : std::string_view();
+    }
+}
+
+std::uint64_t ShaderCache::key(const std::vector<std::string_view>& sources) {
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    hash = fnv1a(hash, glString(GL_VENDOR));
+    hash = fnv1a(hash, glString(GL_RENDERER));
+    hash = fnv1a(hash, glString(GL_VERSION));
+    for (std::string_view source : sources) {
+        // Separator so moving text between stages changes the key
+        hash = fnv1a(hash, std::string_view("\0", 1));
+        hash = fnv1a(hash, source);
+    }
+    return hash;
+}
+
+bool ShaderCache::available() {
+    static const bool supported = [] {
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0;
+    }();
+    return supported;
+}
+
+std::filesystem::path ShaderCache::entryPath(std::uint64_t key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return s_directory / name;
+}
+
+std::optional<ShaderCache::Binary> ShaderCache::load(std::uint64_t key) {
+    if (!available()) return std::nullopt;
+
+    std::ifstream file(entryPath(key), std::ios::binary);
+    if (!file.is_open()) return std::nullopt;
+
+    CacheHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.key != key) {
+        return std::nullopt;
+    }
+
+    Binary binary;
+    binary.format = header.format;
+    binary.data.resize(header.size);
+    if (!file.read(binary.data.data(), header.size)) {
+        return std::nullopt;
+    }
+    return binary;
+}
+
+void ShaderCache::store(std::uint64_t key, GLenum format, const std::vector<char>& data) {
+    if (data.empty()) return;
+
+    std::error_code ec;
+    std::filesystem::create_directories(s_directory, ec);
+    if (ec) {
+        std::cerr << "Shader cache: cannot create " << s_directory << ": " << ec.message() << std::endl;
+        return;
+    }
+
+    // Write to a temporary file first so a crash never leaves a truncated entry behind
+    auto path = entryPath(key);
+    auto tmpPath = path;
+    tmpPath += ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Shader cache: cannot write " << tmpPath << std::endl;
+            return;
+        }
+        CacheHeader header{CACHE_MAGIC, CACHE_VERSION, key, format, static_cast<std::uint32_t>(data.size())};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmpPath, ec);
+    }
+}
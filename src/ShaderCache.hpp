@@ -0,0 +1,38 @@
+// ShaderCache.hpp
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// On-disk cache of linked program binaries (glGetProgramBinary output).
+// Entries are keyed by a hash of the preprocessed shader sources (so included
+// files and injected defines are part of the key) and the driver's vendor,
+// renderer and version strings, so a driver update invalidates the cache.
+class ShaderCache {
+public:
+    struct Binary {
+        GLenum format = 0;
+        std::vector<char> data;
+    };
+
+    // 64-bit key from the preprocessed source of every stage plus the driver identity
+    static std::uint64_t key(const std::vector<std::string_view>& sources);
+
+    static std::optional<Binary> load(std::uint64_t key);
+    static void store(std::uint64_t key, GLenum format, const std::vector<char>& data);
+
+    // Whether the driver supports program binaries at all
+    static bool available();
+
+    static void setDirectory(const std::filesystem::path& dir) { s_directory = dir; }
+    static const std::filesystem::path& directory() { return s_directory; }
+
+private:
+    static std::filesystem::path entryPath(std::uint64_t key);
+
+    static inline std::filesystem::path s_directory = "shader_cache";
+};
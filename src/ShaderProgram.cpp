@@ -1,19 +1,135 @@
 #include "ShaderProgram.hpp"
+#include "ShaderCache.hpp"
+#include "Trace.hpp"
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
 
 std::shared_ptr<ShaderProgram> ShaderProgram::create(const std::filesystem::path& vsPath, const std::filesystem::path& fsPath) {
-    return std::shared_ptr<ShaderProgram>(new ShaderProgram(vsPath, fsPath));
+    return createMany({{vsPath, fsPath}}).front();
 }
 
-ShaderProgram::ShaderProgram(const std::filesystem::path& vsPath,
-                           const std::filesystem::path& fsPath) {
-    GLuint vertexShader = compileShader(vsPath, GL_VERTEX_SHADER);
-    GLuint fragmentShader = compileShader(fsPath, GL_FRAGMENT_SHADER);
-    ID = linkProgram(vertexShader, fragmentShader);
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+std::vector<std::shared_ptr<ShaderProgram>> ShaderProgram::createMany(const std::vector<Source>& sources) {
+    TRACE_SCOPE("ShaderProgram::createMany");
+    std::vector<std::shared_ptr<ShaderProgram>> programs;
+    programs.reserve(sources.size());
+
+    // Kick off everything first...
+    for (const auto& source : sources) {
+        auto program = std::make_shared<ShaderProgram>();
+        program->beginBuild(source);
+        programs.push_back(std::move(program));
+    }
+
+    // ...then collect the results
+    for (auto& program : programs) {
+        program->finishBuild();
+        if (program->ID == 0) {
+            program.reset();
+        }
+    }
+    return programs;
+}
+
+void ShaderProgram::enableParallelCompile() {
+    // 0xFFFFFFFF lets the implementation pick the thread count
+    if (GLEW_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        parallelCompile = true;
+    } else if (GLEW_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+        parallelCompile = true;
+    }
+    std::cout << "Parallel shader compile: " << (parallelCompile ? "enabled" : "not supported") << '\n';
+}
+
+void ShaderProgram::beginBuild(const Source& src) {
+    TRACE_SCOPE_DETAIL("ShaderProgram compile", src.fragment.filename().string());
+    source = src;
+    std::vector<std::filesystem::path> includeStack;
+    std::string vertexSource = preprocess(source.vertex, includeStack);
+    std::string fragmentSource = preprocess(source.fragment, includeStack);
+    injectDefines(vertexSource, source.defines);
+    injectDefines(fragmentSource, source.defines);
+    const bool tessellated = !source.tessControl.empty() && !source.tessEvaluation.empty();
+    std::string tessControlSource, tessEvaluationSource;
+    if (tessellated) {
+        tessControlSource = preprocess(source.tessControl, includeStack);
+        tessEvaluationSource = preprocess(source.tessEvaluation, includeStack);
+        injectDefines(tessControlSource, source.defines);
+        injectDefines(tessEvaluationSource, source.defines);
+    }
+    cacheKey = tessellated ? ShaderCache::key({vertexSource, tessControlSource, tessEvaluationSource, fragmentSource})
+                           : ShaderCache::key({vertexSource, fragmentSource});
+
+    if (auto binary = ShaderCache::load(cacheKey)) {
+        ID = glCreateProgram();
+        glProgramBinary(ID, binary->format, binary->data.data(), static_cast<GLsizei>(binary->data.size()));
+        GLint success = GL_FALSE;
+        glGetProgramiv(ID, GL_LINK_STATUS, &success);
+        if (success) {
+            fromCache = true;
+            return;
+        }
+        // Stale entry (e.g. driver changed in a way the key didn't catch), rebuild from source
+        glDeleteProgram(ID);
+        ID = 0;
+    }
+
+    // No status queries here, they would wait for the compile to finish
+    vertexShader = compileShader(vertexSource, GL_VERTEX_SHADER);
+    fragmentShader = compileShader(fragmentSource, GL_FRAGMENT_SHADER);
+    if (tessellated) {
+        tessControlShader = compileShader(tessControlSource, GL_TESS_CONTROL_SHADER);
+        tessEvaluationShader = compileShader(tessEvaluationSource, GL_TESS_EVALUATION_SHADER);
+    }
+
+    ID = glCreateProgram();
+    glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(ID, vertexShader);
+    glAttachShader(ID, fragmentShader);
+    if (tessellated) {
+        glAttachShader(ID, tessControlShader);
+        glAttachShader(ID, tessEvaluationShader);
+    }
+    glLinkProgram(ID);
+}
+
+void ShaderProgram::finishBuild() {
+    if (fromCache) return;
+    // Status queries wait for the (possibly parallel) compile and link to finish
+    TRACE_SCOPE_DETAIL("ShaderProgram link", source.fragment.filename().string());
+
+    bool success = checkShader(vertexShader, source.vertex) &&
+                   checkShader(fragmentShader, source.fragment) &&
+                   (!tessControlShader || checkShader(tessControlShader, source.tessControl)) &&
+                   (!tessEvaluationShader || checkShader(tessEvaluationShader, source.tessEvaluation)) &&
+                   checkProgram(ID);
+
+    for (GLuint shader : {vertexShader, fragmentShader, tessControlShader, tessEvaluationShader}) {
+        if (!shader) continue;
+        glDetachShader(ID, shader);
+        glDeleteShader(shader);
+    }
+    vertexShader = fragmentShader = tessControlShader = tessEvaluationShader = 0;
+
+    if (!success) {
+        glDeleteProgram(ID);
+        ID = 0;
+        return;
+    }
+
+    if (ShaderCache::available()) {
+        GLint length = 0;
+        glGetProgramiv(ID, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length > 0) {
+            std::vector<char> binary(length);
+            GLenum format = 0;
+            glGetProgramBinary(ID, length, nullptr, &format, binary.data());
+            ShaderCache::store(cacheKey, format, binary);
+        }
+    }
 }
 
 void ShaderProgram::activate() const {
@@ -30,105 +146,91 @@ void ShaderProgram::clear() {
 }
 
 // Uniform setters (one implementation per type)
-void ShaderProgram::setUniform(const std::string& name, bool value) const {
+void ShaderProgram::setUniform(const char* name, bool value) const {
     if (ID != 0) {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        glUniform1i(glGetUniformLocation(ID, name), (int)value);
     }
 }
 
-void ShaderProgram::setUniform(const std::string& name, int value) const {
+void ShaderProgram::setUniform(const char* name, int value) const {
     if (ID != 0) {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1i(glGetUniformLocation(ID, name), value);
     }
 }
 
-void ShaderProgram::setUniform(const std::string& name, float value) const {
+void ShaderProgram::setUniform(const char* name, float value) const {
     if (ID != 0) {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1f(glGetUniformLocation(ID, name), value);
     }
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::vec2& value) const {
+void ShaderProgram::setUniform(const char* name, const glm::vec2& value) const {
     if (ID != 0) {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform2fv(glGetUniformLocation(ID, name), 1, &value[0]);
     }
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::vec3& value) const {
+void ShaderProgram::setUniform(const char* name, const glm::vec3& value) const {
     if (ID != 0) {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform3fv(glGetUniformLocation(ID, name), 1, &value[0]);
     }
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::vec4& value) const {
+void ShaderProgram::setUniform(const char* name, const glm::vec4& value) const {
     if (ID != 0) {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform4fv(glGetUniformLocation(ID, name), 1, &value[0]);
     }
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::mat3& value) const {
+void ShaderProgram::setUniform(const char* name, const glm::mat3& value) const {
     if (ID != 0) {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &value[0][0]);
+        glUniformMatrix3fv(glGetUniformLocation(ID, name), 1, GL_FALSE, &value[0][0]);
     }
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::mat4& value) const {
+void ShaderProgram::setUniform(const char* name, const glm::mat4& value) const {
     if (ID != 0) {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &value[0][0]);
+        glUniformMatrix4fv(glGetUniformLocation(ID, name), 1, GL_FALSE, &value[0][0]);
     }
 }
 
-GLuint ShaderProgram::compileShader(const std::filesystem::path& path, GLenum type) {
-    std::string source = readFile(path);
+void ShaderProgram::setUniform(const char* name, const int* values, GLsizei count) const {
+    if (ID != 0 && count > 0) {
+        glUniform1iv(glGetUniformLocation(ID, name), count, values);
+    }
+}
+
+GLuint ShaderProgram::compileShader(const std::string& source, GLenum type) {
     const char* src = source.c_str();
 
     GLuint shader = glCreateShader(type);
     glShaderSource(shader, 1, &src, nullptr);
     glCompileShader(shader);
+    return shader;
+}
 
-    // Error checking
+bool ShaderProgram::checkShader(GLuint shader, const std::filesystem::path& path) {
     GLint success;
     glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
     if (!success) {
         char infoLog[512];
         glGetShaderInfoLog(shader, 512, nullptr, infoLog);
         std::cerr << "Shader compilation failed (" << path << "):\n" << infoLog << std::endl;
-        glDeleteShader(shader);
-        return 0;
+        return false;
     }
-    return shader;
+    return true;
 }
 
-GLuint ShaderProgram::linkProgram(GLuint vertexShader, GLuint fragmentShader) {
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
-    glLinkProgram(program);
-
-    // Error checking
+bool ShaderProgram::checkProgram(GLuint program) {
     GLint success;
     glGetProgramiv(program, GL_LINK_STATUS, &success);
     if (!success) {
         char infoLog[512];
         glGetProgramInfoLog(program, 512, nullptr, infoLog);
         std::cerr << "Shader program linking failed:\n" << infoLog << std::endl;
-        glDeleteProgram(program);
-        return 0;
+        return false;
     }
-
-    // Validation
-    glValidateProgram(program);
-    GLint valid;
-    glGetProgramiv(program, GL_VALIDATE_STATUS, &valid);
-    if (!valid) {
-        char log[512];
-        glGetProgramInfoLog(program, 512, nullptr, log);
-        std::cerr << "Shader program validation failed:\n" << log << std::endl;
-        glDeleteProgram(program);
-        return 0;
-    }
-
-    return program;
+    return true;
 }
 
 std::string ShaderProgram::readFile(const std::filesystem::path& path) {
@@ -143,8 +245,58 @@ std::string ShaderProgram::readFile(const std::filesystem::path& path) {
     return buffer.str();
 }
 
+// Resolves #include "file" (relative to the including file) so shared blocks live in one place
+std::string ShaderProgram::preprocess(const std::filesystem::path& path, std::vector<std::filesystem::path>& includeStack) {
+    auto canonical = std::filesystem::weakly_canonical(path);
+    if (std::find(includeStack.begin(), includeStack.end(), canonical) != includeStack.end()) {
+        throw std::runtime_error("Recursive shader include: " + path.string());
+    }
+    includeStack.push_back(canonical);
+
+    std::istringstream input(readFile(path));
+    std::string output;
+    std::string line;
+    while (std::getline(input, line)) {
+        auto first = line.find_first_not_of(" \t");
+        if (first != std::string::npos && line.compare(first, 8, "#include") == 0) {
+            auto open = line.find('"', first + 8);
+            auto close = open == std::string::npos ? open : line.find('"', open + 1);
+            if (close == std::string::npos) {
+                throw std::runtime_error("Malformed #include in " + path.string() + ": " + line);
+            }
+            output += preprocess(path.parent_path() / line.substr(open + 1, close - open - 1), includeStack);
+        } else {
+            output += line;
+            output += '\n';
+        }
+    }
+
+    includeStack.pop_back();
+    return output;
+}
+
+// Defines have to follow the #version line, which must stay first
+void ShaderProgram::injectDefines(std::string& source, const std::string& defines) {
+    if (defines.empty()) return;
+
+    size_t insertAt = 0;
+    size_t version = source.find("#version");
+    if (version != std::string::npos) {
+        size_t lineEnd = source.find('\n', version);
+        insertAt = lineEnd == std::string::npos ? source.size() : lineEnd + 1;
+    }
+    source.insert(insertAt, defines);
+}
+
+std::uint32_t ShaderProgram::nextSequence() {
+    // Programs are only ever created on the GL thread
+    static std::uint32_t next = 1;
+    return next++;
+}
+
 ShaderProgram::ShaderProgram(ShaderProgram&& other) noexcept
-    : ID(other.ID) {
+    : ID(other.ID), source(std::move(other.source)), cacheKey(other.cacheKey), fromCache(other.fromCache),
+      sequence(other.sequence) {
     other.ID = 0;  // Prevent double deletion
 }
 
@@ -152,6 +304,7 @@ ShaderProgram& ShaderProgram::operator=(ShaderProgram&& other) noexcept {
     if (this != &other) {
         clear();
         ID = other.ID;
+        sequence = other.sequence;
         other.ID = 0;
     }
     return *this;
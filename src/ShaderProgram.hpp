@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 #include <filesystem>
 #include <glm/glm.hpp>
 #include <GL/glew.h>
@@ -11,25 +13,50 @@ public:
 	GLuint ID = 0;
 	ShaderProgram() = default;
 
+	// Shader stages that make up one program
+	struct Source {
+		std::filesystem::path vertex;
+		std::filesystem::path fragment;
+		std::string defines; // "#define ..." lines injected after #version in every stage
+		// Optional tessellation stages, both or neither
+		std::filesystem::path tessControl;
+		std::filesystem::path tessEvaluation;
+	};
+
+	// Loads the linked program from the binary cache, or compiles it and fills the cache.
+	// Returns nullptr if the program fails to compile or link.
 	static std::shared_ptr<ShaderProgram> create(const std::filesystem::path& vsPath,
 											   const std::filesystem::path& fsPath);
 
+	// Same as create() for many programs. Every compile and link is issued before any
+	// status is queried, so with parallel compile the driver builds them concurrently.
+	static std::vector<std::shared_ptr<ShaderProgram>> createMany(const std::vector<Source>& sources);
+
+	// Hand shader compilation to driver threads (GL_KHR_parallel_shader_compile), call after GLEW init
+	static void enableParallelCompile();
+
 	int getID() {
 		return ID;
 	}
 
+	bool loadedFromCache() const { return fromCache; }
+
+	// Distinct per program, in creation order; RenderQueue groups draws by it
+	std::uint32_t sortId() const { return sequence; }
+
 	void activate() const;
 	void clear();
 
-	// Uniform setters
-	void setUniform(const std::string& name, bool value) const;
-	void setUniform(const std::string& name, int value) const;
-	void setUniform(const std::string& name, float value) const;
-	void setUniform(const std::string& name, const glm::vec2& value) const;
-	void setUniform(const std::string& name, const glm::vec3& value) const;
-	void setUniform(const std::string& name, const glm::vec4& value) const;
-	void setUniform(const std::string& name, const glm::mat3& value) const;
-	void setUniform(const std::string& name, const glm::mat4& value) const;
+	// Uniform setters, names are C strings so literals don't build a temporary std::string
+	void setUniform(const char* name, bool value) const;
+	void setUniform(const char* name, int value) const;
+	void setUniform(const char* name, float value) const;
+	void setUniform(const char* name, const glm::vec2& value) const;
+	void setUniform(const char* name, const glm::vec3& value) const;
+	void setUniform(const char* name, const glm::vec4& value) const;
+	void setUniform(const char* name, const glm::mat3& value) const;
+	void setUniform(const char* name, const glm::mat4& value) const;
+	void setUniform(const char* name, const int* values, GLsizei count) const;
 
 	ShaderProgram(const ShaderProgram&) = delete;
 	ShaderProgram& operator=(const ShaderProgram&) = delete;
@@ -38,8 +65,27 @@ public:
 	~ShaderProgram();
 
 private:
-	ShaderProgram(const std::filesystem::path& vsPath, const std::filesystem::path& fsPath);
-	GLuint compileShader(const std::filesystem::path& path, GLenum type);
-	GLuint linkProgram(GLuint vertexShader, GLuint fragmentShader);
+	// Build is split in two so several programs can be in flight at once
+	void beginBuild(const Source& source);
+	void finishBuild();
+
+	GLuint compileShader(const std::string& source, GLenum type);
+	bool checkShader(GLuint shader, const std::filesystem::path& path);
+	bool checkProgram(GLuint program);
 	std::string readFile(const std::filesystem::path& path);
+	std::string preprocess(const std::filesystem::path& path, std::vector<std::filesystem::path>& includeStack);
+	static void injectDefines(std::string& source, const std::string& defines);
+
+	Source source;
+	GLuint vertexShader = 0;
+	GLuint fragmentShader = 0;
+	GLuint tessControlShader = 0;
+	GLuint tessEvaluationShader = 0;
+	std::uint64_t cacheKey = 0;
+	bool fromCache = false;
+	std::uint32_t sequence = nextSequence();
+
+	static std::uint32_t nextSequence();
+
+	static inline bool parallelCompile = false;
 };
\ No newline at end of file
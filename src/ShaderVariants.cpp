@@ -0,0 +1,56 @@
+// ShaderVariants.cpp
+#include "ShaderVariants.hpp"
+#include <chrono>
+#include <iostream>
+
+ShaderVariants::ShaderVariants(std::filesystem::path vsPath, std::filesystem::path fsPath,
+                               std::filesystem::path tcsPath, std::filesystem::path tesPath)
+    : m_vsPath(std::move(vsPath)), m_fsPath(std::move(fsPath)),
+      m_tcsPath(std::move(tcsPath)), m_tesPath(std::move(tesPath)) {
+}
+
+std::string ShaderVariants::defines(std::uint32_t key) {
+    std::string result = "#define NUM_POINT_LIGHTS " + std::to_string((key & LIGHT_TIER_MASK) >> LIGHT_TIER_SHIFT) + "\n";
+    if (key & INSTANCED) result += "#define INSTANCED 1\n";
+    if (key & ALPHA_TEST) result += "#define ALPHA_TEST 1\n";
+    return result;
+}
+
+ShaderProgram* ShaderVariants::get(std::uint32_t key) {
+    auto it = m_variants.find(key);
+    if (it == m_variants.end()) {
+        precompile({key});
+        it = m_variants.find(key);
+    }
+    return it->second.get();
+}
+
+void ShaderVariants::precompile(const std::vector<std::uint32_t>& keys) {
+    std::vector<std::uint32_t> missing;
+    std::vector<ShaderProgram::Source> sources;
+    for (std::uint32_t key : keys) {
+        if (m_variants.count(key)) continue;
+        // Guard against duplicates in the request
+        m_variants[key] = nullptr;
+        missing.push_back(key);
+        sources.push_back({m_vsPath, m_fsPath, defines(key), m_tcsPath, m_tesPath});
+    }
+    if (sources.empty()) return;
+
+    auto start = std::chrono::steady_clock::now();
+    auto programs = ShaderProgram::createMany(sources);
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+    int cached = 0;
+    for (size_t i = 0; i < missing.size(); i++) {
+        if (!programs[i]) {
+            std::cerr << "Shader variant 0x" << std::hex << missing[i] << std::dec << " failed to build:\n"
+                      << sources[i].defines;
+        } else if (programs[i]->loadedFromCache()) {
+            cached++;
+        }
+        m_variants[missing[i]] = std::move(programs[i]);
+    }
+    std::cout << "Built " << missing.size() << " shader variant(s) (" << cached << " from cache) in "
+              << elapsed.count() << " ms\n";
+}
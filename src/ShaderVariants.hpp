@@ -0,0 +1,52 @@
+// ShaderVariants.hpp
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ShaderProgram.hpp"
+
+// Compile-time specialised permutations of one vertex/fragment shader pair, injected
+// as #defines. Materials are data (MaterialTable), so the axes left are the number of
+// point lights a draw evaluates, whether it is instanced and whether it alpha tests.
+// Variants are compiled on first use and cached; precompile() builds a known set up front
+// in one parallel batch.
+class ShaderVariants {
+public:
+    // Bits 0-1 hold the number of point lights evaluated (NUM_POINT_LIGHTS)
+    static constexpr std::uint32_t LIGHT_TIER_SHIFT = 0;
+    static constexpr std::uint32_t LIGHT_TIER_MASK = 0x3u << LIGHT_TIER_SHIFT;
+    // Bit 2: placement comes per instance from the instance buffer (INSTANCED)
+    static constexpr std::uint32_t INSTANCED = 1u << 2;
+    // Bit 3: discard (nearly) transparent fragments (ALPHA_TEST). Only for materials that
+    // need it, a reachable discard can turn off early depth testing for the whole program.
+    static constexpr std::uint32_t ALPHA_TEST = 1u << 3;
+
+    static std::uint32_t key(int pointLights, bool instanced = false, bool alphaTest = false) {
+        return (static_cast<std::uint32_t>(pointLights) << LIGHT_TIER_SHIFT) | (instanced ? INSTANCED : 0u) |
+               (alphaTest ? ALPHA_TEST : 0u);
+    }
+    static std::string defines(std::uint32_t key);
+
+    // tcsPath/tesPath add tessellation stages to every variant, both or neither
+    ShaderVariants(std::filesystem::path vsPath, std::filesystem::path fsPath,
+                   std::filesystem::path tcsPath = {}, std::filesystem::path tesPath = {});
+
+    // Variant for the key, compiled on first request. nullptr if it failed to build.
+    ShaderProgram* get(std::uint32_t key);
+
+    // Compile all missing keys in one batch (parallel if the driver supports it)
+    void precompile(const std::vector<std::uint32_t>& keys);
+
+    size_t compiledCount() const { return m_variants.size(); }
+
+private:
+    std::filesystem::path m_vsPath;
+    std::filesystem::path m_fsPath;
+    std::filesystem::path m_tcsPath;
+    std::filesystem::path m_tesPath;
+    std::unordered_map<std::uint32_t, std::shared_ptr<ShaderProgram>> m_variants;
+};
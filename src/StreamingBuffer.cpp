@@ -0,0 +1,104 @@
+// StreamingBuffer.cpp
+#include "StreamingBuffer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+StreamingBuffer::StreamingBuffer(GLsizeiptr regionSize, int regionCount)
+    : m_fences(std::max(regionCount, 1), nullptr) {
+    GLint uboAlign = 256, ssboAlign = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uboAlign);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &ssboAlign);
+    m_alignment = std::max<GLsizeiptr>({uboAlign, ssboAlign, 16});
+
+    // Keep every region start aligned
+    m_regionSize = (regionSize + m_alignment - 1) / m_alignment * m_alignment;
+    const GLsizeiptr totalSize = m_regionSize * static_cast<GLsizeiptr>(m_fences.size());
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glCreateBuffers(1, &m_buffer);
+    glNamedBufferStorage(m_buffer, totalSize, nullptr, flags);
+    m_mapped = static_cast<std::byte*>(glMapNamedBufferRange(m_buffer, 0, totalSize, flags));
+    if (!m_mapped) {
+        glDeleteBuffers(1, &m_buffer);
+        throw std::runtime_error("StreamingBuffer: failed to persistently map buffer");
+    }
+}
+
+StreamingBuffer::~StreamingBuffer() {
+    for (GLsync fence : m_fences) {
+        if (fence) glDeleteSync(fence);
+    }
+    if (m_buffer) {
+        glUnmapNamedBuffer(m_buffer);
+        glDeleteBuffers(1, &m_buffer);
+    }
+}
+
+void StreamingBuffer::beginFrame() {
+    m_region = (m_region + 1) % static_cast<int>(m_fences.size());
+    m_head = 0;
+    m_stats.bytesThisFrame = 0;
+    m_stats.stallsThisFrame = 0;
+
+    GLsync& fence = m_fences[m_region];
+    if (!fence) return;
+
+    // Fast path: the GPU finished with this region long ago
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+        // CPU is a full ring ahead of the GPU, block until the region is free
+        auto start = std::chrono::steady_clock::now();
+        do {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000); // 1 ms
+        } while (result == GL_TIMEOUT_EXPIRED);
+        auto end = std::chrono::steady_clock::now();
+
+        m_stats.stallsThisFrame++;
+        m_stats.totalStalls++;
+        m_stats.lastStallMs = std::chrono::duration<double, std::milli>(end - start).count();
+        if (result == GL_WAIT_FAILED) {
+            std::cerr << "StreamingBuffer: glClientWaitSync failed\n";
+        }
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void StreamingBuffer::endFrame() {
+    GLsync& fence = m_fences[m_region];
+    if (fence) glDeleteSync(fence);
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+StreamingBuffer::Allocation StreamingBuffer::allocate(GLsizeiptr size, GLsizeiptr alignment) {
+    if (alignment <= 0) alignment = m_alignment;
+    GLsizeiptr offset = (m_head + alignment - 1) / alignment * alignment;
+
+    if (offset + size > m_regionSize) {
+        if (m_stats.overflows++ == 0) {
+            std::cerr << "StreamingBuffer: frame region of " << m_regionSize
+                      << " bytes exhausted (requested " << size << ")\n";
+        }
+        return {};
+    }
+
+    m_head = offset + size;
+    m_stats.bytesThisFrame = m_head;
+    m_stats.peakBytes = std::max(m_stats.peakBytes, m_head);
+
+    Allocation alloc;
+    alloc.buffer = m_buffer;
+    alloc.offset = m_regionSize * m_region + offset;
+    alloc.size = size;
+    alloc.data = m_mapped + alloc.offset;
+    return alloc;
+}
+
+void StreamingBuffer::bind(GLenum target, GLuint index, const Allocation& alloc) {
+    if (alloc) {
+        glBindBufferRange(target, index, alloc.buffer, alloc.offset, alloc.size);
+    }
+}
@@ -0,0 +1,81 @@
+// StreamingBuffer.hpp
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+// Persistently mapped, coherent ring buffer for data that changes every frame.
+// The buffer is split into regionCount frame regions; each frame bump-allocates
+// from its own region and the region is fenced when the frame ends. A region is
+// only written again once its fence has signalled, so the CPU never overwrites
+// data the GPU is still reading. If the CPU gets that far ahead it has to wait,
+// which is counted as a stall.
+class StreamingBuffer {
+public:
+    struct Allocation {
+        void* data = nullptr;   // CPU write pointer (persistently mapped)
+        GLuint buffer = 0;
+        GLintptr offset = 0;    // offset into buffer, use for glBindBufferRange
+        GLsizeiptr size = 0;
+
+        explicit operator bool() const { return data != nullptr; }
+    };
+
+    struct Stats {
+        GLsizeiptr bytesThisFrame = 0;
+        GLsizeiptr peakBytes = 0;
+        unsigned int stallsThisFrame = 0;
+        unsigned long long totalStalls = 0;
+        double lastStallMs = 0.0;
+        unsigned long long overflows = 0;
+    };
+
+    StreamingBuffer(GLsizeiptr regionSize, int regionCount = 3);
+    ~StreamingBuffer();
+
+    StreamingBuffer(const StreamingBuffer&) = delete;
+    StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+
+    // Waits (and records a stall) if the GPU still uses the next region
+    void beginFrame();
+    // Fences the current region, call after the frame's draws were submitted
+    void endFrame();
+
+    // Bump allocation inside the current frame region; alignment 0 uses the
+    // buffer offset alignment required for uniform/storage binding
+    Allocation allocate(GLsizeiptr size, GLsizeiptr alignment = 0);
+
+    template <typename T>
+    Allocation push(const T& value) {
+        Allocation alloc = allocate(sizeof(T));
+        if (alloc) std::memcpy(alloc.data, &value, sizeof(T));
+        return alloc;
+    }
+
+    template <typename T>
+    Allocation push(const T* values, std::size_t count) {
+        Allocation alloc = allocate(static_cast<GLsizeiptr>(sizeof(T) * count));
+        if (alloc) std::memcpy(alloc.data, values, sizeof(T) * count);
+        return alloc;
+    }
+
+    // glBindBufferRange for an allocation (GL_UNIFORM_BUFFER, GL_SHADER_STORAGE_BUFFER...)
+    static void bind(GLenum target, GLuint index, const Allocation& alloc);
+
+    GLuint id() const { return m_buffer; }
+    GLsizeiptr regionSize() const { return m_regionSize; }
+    int regionCount() const { return static_cast<int>(m_fences.size()); }
+    const Stats& stats() const { return m_stats; }
+
+private:
+    GLuint m_buffer = 0;
+    std::byte* m_mapped = nullptr;
+    GLsizeiptr m_regionSize = 0;
+    GLsizeiptr m_alignment = 1;
+    int m_region = 0;
+    GLsizeiptr m_head = 0;
+    std::vector<GLsync> m_fences;
+    Stats m_stats;
+};
@@ -0,0 +1,249 @@
+// TerrainLod.cpp
+#include "TerrainLod.hpp"
+#include <algorithm>
+
+namespace {
+    // Morph distances of the top level, which has no coarser level to morph to
+    constexpr float NEVER = 1e30f;
+
+    bool withinRange(const glm::vec3& min, const glm::vec3& max, const glm::vec3& point, float range) {
+        glm::vec3 closest = glm::clamp(point, min, max);
+        glm::vec3 offset = closest - point;
+        return glm::dot(offset, offset) < range * range;
+    }
+}
+
+TerrainLodHeader makeTerrainHeader(const TerrainLayout& layout, int columns, int rows, float textureTiling,
+                                   float sampleRange) {
+    return {glm::vec4(layout.origin, layout.worldScale, layout.heightScale * sampleRange),
+            glm::vec4(columns, rows, layout.baseY, textureTiling)};
+}
+
+TerrainLodHeader makeTerrainHeader(const TerrainQuery& terrain, float textureTiling) {
+    return makeTerrainHeader(terrain.layout(), terrain.columns(), terrain.rows(), textureTiling);
+}
+
+void TerrainLod::build(const TerrainQuery& terrain, const TerrainLodSettings& settings) {
+    buildLevels(terrain.columns(), terrain.rows(), terrain.layout(), settings, [&](int x0, int z0, int x1, int z1) {
+        glm::vec2 bounds(1e30f, -1e30f);
+        for (int tz = z0; tz <= z1; tz++) {
+            for (int tx = x0; tx <= x1; tx++) {
+                const float h = terrain.texelHeight(tx, tz);
+                bounds = glm::vec2(std::min(bounds.x, h), std::max(bounds.y, h));
+            }
+        }
+        return bounds;
+    });
+    m_header = makeTerrainHeader(terrain, settings.textureTiling);
+}
+
+TerrainLod::TerrainLod(std::pmr::memory_resource* selectionMemory)
+    : m_selection{std::pmr::vector<TerrainLodNode>(selectionMemory), std::pmr::vector<TerrainLodNode>(selectionMemory),
+                  std::pmr::vector<TerrainLodNode>(selectionMemory), std::pmr::vector<TerrainLodNode>(selectionMemory),
+                  std::pmr::vector<TerrainLodNode>(selectionMemory)} {
+    static_assert(PART_COUNT == 5, "One selection list per part");
+}
+
+void TerrainLod::build(const TerrainTiles& tiles, const TerrainLodSettings& settings) {
+    buildLevels(tiles.columns(), tiles.rows(), tiles.layout(), settings, [&](int x0, int z0, int x1, int z1) {
+        return tiles.rangeBounds(x0, z0, x1, z1);
+    });
+    m_header = makeTerrainHeader(tiles.layout(), tiles.columns(), tiles.rows(), settings.textureTiling, 65535.0f);
+}
+
+void TerrainLod::buildLevels(int columns, int rows, const TerrainLayout& layout, const TerrainLodSettings& settings,
+                             const std::function<glm::vec2(int, int, int, int)>& leafBounds) {
+    m_settings = settings;
+    m_settings.patchQuads = std::clamp(settings.patchQuads, 2, 254) & ~1;
+    m_levels.clear();
+    for (auto& nodes : m_selection) nodes.clear();
+    if (columns < 2 || rows < 2) return;
+
+    m_layout = layout;
+    m_cellsX = columns - 1;
+    m_cellsZ = rows - 1;
+    const int quads = m_settings.patchQuads;
+
+    // Enough levels for the top one to cover the heightmap in a single node, if allowed
+    int levelCount = 1;
+    while ((quads << (levelCount - 1)) < std::max(m_cellsX, m_cellsZ) && levelCount < std::max(settings.maxLevels, 1)) {
+        levelCount++;
+    }
+    m_levels.resize(levelCount);
+
+    // Height bounds bottom up: leaves from the texels they span, each level above from its children
+    for (int l = 0; l < levelCount; l++) {
+        Level& level = m_levels[l];
+        level.cells = quads << l;
+        level.width = (m_cellsX + level.cells - 1) / level.cells;
+        level.height = (m_cellsZ + level.cells - 1) / level.cells;
+        level.bounds.assign(static_cast<size_t>(level.width) * level.height, glm::vec2(1e30f, -1e30f));
+
+        for (int z = 0; z < level.height; z++) {
+            for (int x = 0; x < level.width; x++) {
+                glm::vec2& bounds = level.bounds[static_cast<size_t>(z) * level.width + x];
+                if (l == 0) {
+                    bounds = leafBounds(x * quads, z * quads, std::min((x + 1) * quads, m_cellsX),
+                                        std::min((z + 1) * quads, m_cellsZ));
+                    continue;
+                }
+                const Level& below = m_levels[l - 1];
+                for (int c = 0; c < 4; c++) {
+                    const int cx = 2 * x + (c & 1), cz = 2 * z + (c >> 1);
+                    if (cx >= below.width || cz >= below.height) continue;
+                    const glm::vec2& child = below.bounds[static_cast<size_t>(cz) * below.width + cx];
+                    bounds = glm::vec2(std::min(bounds.x, child.x), std::max(bounds.y, child.y));
+                }
+            }
+        }
+    }
+
+    // Ranges double per level; a leaf node must fit in its own range for the morph to finish
+    const float leafSize = quads * m_layout.worldScale;
+    float range = std::max(settings.lodDistance > 0.0f ? settings.lodDistance : 2.0f * leafSize, leafSize);
+    const float morphRatio = std::clamp(settings.morphRatio, 0.01f, 1.0f);
+    float previous = 0.0f;
+    for (int l = 0; l < levelCount; l++) {
+        m_levels[l].range = range;
+        m_levels[l].morphStart = previous + (range - previous) * (1.0f - morphRatio);
+        previous = range;
+        range *= 2.0f;
+    }
+}
+
+bool TerrainLod::nodeBounds(int level, int x, int z, glm::vec3& min, glm::vec3& max) const {
+    const Level& lvl = m_levels[level];
+    if (x >= lvl.width || z >= lvl.height) return false;
+    const glm::vec2& heights = lvl.bounds[static_cast<size_t>(z) * lvl.width + x];
+    const float scale = m_layout.worldScale;
+    min = glm::vec3(m_layout.origin.x + x * lvl.cells * scale, heights.x, m_layout.origin.y + z * lvl.cells * scale);
+    max = glm::vec3(m_layout.origin.x + std::min((x + 1) * lvl.cells, m_cellsX) * scale, heights.y,
+                    m_layout.origin.y + std::min((z + 1) * lvl.cells, m_cellsZ) * scale);
+    return true;
+}
+
+void TerrainLod::select(const glm::vec3& camera, const Frustum& frustum) {
+    // Last select()'s lists may sit in memory that has been reset since, start on fresh memory
+    for (auto& nodes : m_selection) {
+        const size_t expected = nodes.size();
+        nodes = std::pmr::vector<TerrainLodNode>(nodes.get_allocator());
+        nodes.reserve(expected);
+    }
+    m_culled = 0;
+    if (m_levels.empty()) return;
+    m_camera = camera;
+    m_frustum = &frustum;
+
+    // Top level nodes beyond every range are still drawn, at the coarsest level
+    const int top = levelCount() - 1;
+    for (int z = 0; z < m_levels[top].height; z++) {
+        for (int x = 0; x < m_levels[top].width; x++) {
+            if (selectNode(top, x, z)) continue;
+            glm::vec3 min, max;
+            nodeBounds(top, x, z, min, max);
+            if (frustum.intersectsBox(min, max)) {
+                add(Whole, top, x, z);
+            } else {
+                m_culled++;
+            }
+        }
+    }
+    m_frustum = nullptr;
+}
+
+// False if the node is out of its level's range and the parent has to cover it
+bool TerrainLod::selectNode(int level, int x, int z) {
+    glm::vec3 min, max;
+    if (!nodeBounds(level, x, z, min, max)) return true; // past the heightmap's edge, nothing to draw
+    if (!withinRange(min, max, m_camera, m_levels[level].range)) return false;
+    if (!m_frustum->intersectsBox(min, max)) {
+        m_culled++;
+        return true;
+    }
+    if (level == 0 || !withinRange(min, max, m_camera, m_levels[level - 1].range)) {
+        add(Whole, level, x, z);
+        return true;
+    }
+
+    // Children within their range draw themselves, the rest is covered by this level
+    bool covered[4];
+    for (int c = 0; c < 4; c++) {
+        covered[c] = selectNode(level - 1, 2 * x + (c & 1), 2 * z + (c >> 1));
+    }
+    if (covered[0] && covered[1] && covered[2] && covered[3]) return true;
+    for (int c = 0; c < 4; c++) {
+        if (covered[c]) continue;
+        glm::vec3 childMin, childMax;
+        nodeBounds(level - 1, 2 * x + (c & 1), 2 * z + (c >> 1), childMin, childMax);
+        if (m_frustum->intersectsBox(childMin, childMax)) {
+            add(static_cast<Part>(Quadrant0 + c), level, x, z);
+        } else {
+            m_culled++;
+        }
+    }
+    return true;
+}
+
+void TerrainLod::add(Part part, int level, int x, int z) {
+    const Level& lvl = m_levels[level];
+    const float size = lvl.cells * m_layout.worldScale;
+    const bool top = level == levelCount() - 1;
+    m_selection[part].push_back({
+        glm::vec4(m_layout.origin.x + x * size, m_layout.origin.y + z * size, size, static_cast<float>(level)),
+        glm::vec4(top ? NEVER : lvl.morphStart, top ? 2.0f * NEVER : lvl.range, static_cast<float>(m_settings.patchQuads), 0.0f)});
+}
+
+void TerrainLod::buildPatch(int quads, std::vector<glm::vec2>& positions, std::vector<std::uint32_t>& indices) {
+    positions.clear();
+    indices.clear();
+    for (int z = 0; z <= quads; z++) {
+        for (int x = 0; x <= quads; x++) {
+            positions.emplace_back(static_cast<float>(x) / quads, static_cast<float>(z) / quads);
+        }
+    }
+
+    // Quadrant by quadrant (same order as a node's children), so every part is one range
+    const int half = quads / 2;
+    for (int quadrant = 0; quadrant < 4; quadrant++) {
+        const int startX = (quadrant & 1) * half, startZ = (quadrant >> 1) * half;
+        for (int z = startZ; z < startZ + half; z++) {
+            for (int x = startX; x < startX + half; x++) {
+                const std::uint32_t v0 = static_cast<std::uint32_t>(z * (quads + 1) + x);
+                const std::uint32_t v1 = v0 + 1;
+                const std::uint32_t v2 = v0 + quads + 2;
+                const std::uint32_t v3 = v0 + quads + 1;
+                indices.insert(indices.end(), {v0, v1, v2, v0, v2, v3});
+            }
+        }
+    }
+}
+
+size_t TerrainLod::firstIndex(Part part) const {
+    return part == Whole ? 0 : (part - Quadrant0) * indexCount(Quadrant0);
+}
+
+size_t TerrainLod::indexCount(Part part) const {
+    const size_t half = static_cast<size_t>(m_settings.patchQuads / 2);
+    return (part == Whole ? 4 : 1) * half * half * 6;
+}
+
+size_t TerrainLod::selectedCount() const {
+    size_t count = 0;
+    for (const auto& nodes : m_selection) count += nodes.size();
+    return count;
+}
+
+size_t TerrainLod::triangleCount() const {
+    size_t triangles = 0;
+    for (int part = 0; part < PART_COUNT; part++) {
+        triangles += m_selection[part].size() * indexCount(static_cast<Part>(part)) / 3;
+    }
+    return triangles;
+}
+
+size_t TerrainLod::bytes() const {
+    size_t total = 0;
+    for (const Level& level : m_levels) total += level.bounds.capacity() * sizeof(glm::vec2);
+    for (const auto& nodes : m_selection) total += nodes.capacity() * sizeof(TerrainLodNode);
+    return total;
+}
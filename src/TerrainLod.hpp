@@ -0,0 +1,111 @@
+// TerrainLod.hpp
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Frustum.hpp"
+#include "TerrainQuery.hpp"
+#include "TerrainTiles.hpp"
+
+struct TerrainLodSettings {
+    int patchQuads = 32;        // quads per side of the patch mesh, even
+    int maxLevels = 12;
+    float lodDistance = 0.0f;   // range of level 0 in world units, each level doubles it; 0 = two leaf nodes
+    float morphRatio = 0.3f;    // outer part of each range over which vertices morph to the next level
+    float textureTiling = 15.0f; // surface texture repeats across the heightmap
+};
+
+// std430 mirror of the TerrainNodes buffer in terrain.vert: a header, then the nodes of one draw
+struct TerrainLodHeader {
+    glm::vec4 layout; // world XZ of texel (0, 0), world units per texel, world units per unit of the normalized height texture
+    glm::vec4 extent; // columns, rows, base height, texture tiling
+};
+struct TerrainLodNode {
+    glm::vec4 placement; // world XZ of the node's corner, world size, level
+    glm::vec4 morph;     // camera distances where morphing starts and ends, patch quads per side
+};
+static_assert(sizeof(TerrainLodHeader) == 32 && sizeof(TerrainLodNode) == 32, "Terrain LOD data must match std430 layout");
+
+// Header describing where the heightmap and its texture sit, as the terrain shaders expect it.
+// sampleRange is the largest sample value, 255 for R8 textures and 65535 for R16.
+TerrainLodHeader makeTerrainHeader(const TerrainLayout& layout, int columns, int rows, float textureTiling,
+                                   float sampleRange = 255.0f);
+TerrainLodHeader makeTerrainHeader(const TerrainQuery& terrain, float textureTiling);
+
+// Continuous distance-dependent LOD (CDLOD) selection over a heightmap. A quadtree of
+// nodes, each drawn with the same small patch mesh scaled to its size and displaced on
+// the GPU from the height texture, so the draw cost depends on the view, not on the
+// heightmap's resolution. Every level covers twice the distance of the one below; within
+// the outer morphRatio of its range a node's vertices slide onto the grid of the next
+// coarser level, so switching levels doesn't pop. Nodes are culled with their min/max
+// height bounds against the frustum.
+//
+// A node only partly within the finer level's range draws its remaining quadrants itself.
+// The patch's indices are ordered by quadrant, so each part is a contiguous index range:
+// selection() lists the nodes drawn whole and those drawn per quadrant, one instanced draw each.
+// The lists live in selectionMemory, typically a frame arena, and are valid until it's reset.
+class TerrainLod {
+public:
+    enum Part { Whole = 0, Quadrant0, Quadrant1, Quadrant2, Quadrant3, PART_COUNT };
+
+    explicit TerrainLod(std::pmr::memory_resource* selectionMemory = std::pmr::get_default_resource());
+
+    void build(const TerrainQuery& terrain, const TerrainLodSettings& settings);
+    // Over a tiled heightfield, with the leaves' height bounds taken from its tile pyramid.
+    // Those are conservative (a tile's range), so only culling gets a little less tight.
+    void build(const TerrainTiles& tiles, const TerrainLodSettings& settings);
+    void select(const glm::vec3& camera, const Frustum& frustum);
+
+    const std::pmr::vector<TerrainLodNode>& selection(Part part) const { return m_selection[part]; }
+    const TerrainLodHeader& header() const { return m_header; }
+
+    // Patch mesh: (patchQuads + 1)^2 positions in [0, 1] and indices grouped by quadrant
+    static void buildPatch(int quads, std::vector<glm::vec2>& positions, std::vector<std::uint32_t>& indices);
+    // Index range of a part in the patch
+    size_t firstIndex(Part part) const;
+    size_t indexCount(Part part) const;
+
+    bool empty() const { return m_levels.empty(); }
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+    int patchQuads() const { return m_settings.patchQuads; }
+    size_t selectedCount() const;
+    size_t culledCount() const { return m_culled; }
+    size_t triangleCount() const;
+    size_t bytes() const;
+
+private:
+    // Min/max height of every node of one level
+    struct Level {
+        int width = 0;
+        int height = 0;
+        int cells = 0;   // heightmap cells per node side
+        float range = 0.0f;
+        float morphStart = 0.0f;
+        std::vector<glm::vec2> bounds;
+    };
+
+    // Quadtree over columns x rows samples; leafBounds(x0, z0, x1, z1) gives the height
+    // range of the samples in [x0, x1] x [z0, z1]
+    void buildLevels(int columns, int rows, const TerrainLayout& layout, const TerrainLodSettings& settings,
+                     const std::function<glm::vec2(int, int, int, int)>& leafBounds);
+    bool nodeBounds(int level, int x, int z, glm::vec3& min, glm::vec3& max) const;
+    bool selectNode(int level, int x, int z);
+    void add(Part part, int level, int x, int z);
+
+    TerrainLodSettings m_settings;
+    TerrainLayout m_layout;
+    int m_cellsX = 0, m_cellsZ = 0;
+    TerrainLodHeader m_header{};
+    std::vector<Level> m_levels;
+
+    // Per select()
+    glm::vec3 m_camera = glm::vec3(0.0f);
+    const Frustum* m_frustum = nullptr;
+    std::array<std::pmr::vector<TerrainLodNode>, PART_COUNT> m_selection;
+    size_t m_culled = 0;
+};
@@ -0,0 +1,38 @@
+// TerrainMesh.cpp
+#include "TerrainMesh.hpp"
+#include <stdexcept>
+
+TerrainMesh::TerrainMesh(const TerrainMeshData& data) : m_chunks(data.chunks), m_bytes(data.bytes()) {
+    if (data.vertices.empty() || data.indices.empty()) {
+        throw std::runtime_error("Terrain mesh created without vertices or indices");
+    }
+    for (const TerrainChunk& chunk : m_chunks) m_triangles += chunk.indexCount / 3;
+
+    glCreateVertexArrays(1, &m_vao);
+    glCreateBuffers(1, &m_vertexBuffer);
+    glCreateBuffers(1, &m_indexBuffer);
+    glNamedBufferStorage(m_vertexBuffer, data.vertices.size() * sizeof(TerrainVertex), data.vertices.data(), 0);
+    glNamedBufferStorage(m_indexBuffer, data.indices.size() * sizeof(std::uint16_t), data.indices.data(), 0);
+
+    glVertexArrayVertexBuffer(m_vao, 0, m_vertexBuffer, 0, sizeof(TerrainVertex));
+    glVertexArrayElementBuffer(m_vao, m_indexBuffer);
+
+    glEnableVertexArrayAttrib(m_vao, 0);
+    glVertexArrayAttribFormat(m_vao, 0, 3, GL_FLOAT, GL_FALSE, offsetof(TerrainVertex, position));
+    glVertexArrayAttribBinding(m_vao, 0, 0);
+
+    // Normalized 10:10:10:2, the shader's vec3 reads xyz
+    glEnableVertexArrayAttrib(m_vao, 1);
+    glVertexArrayAttribFormat(m_vao, 1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(TerrainVertex, normal));
+    glVertexArrayAttribBinding(m_vao, 1, 0);
+
+    glEnableVertexArrayAttrib(m_vao, 2);
+    glVertexArrayAttribFormat(m_vao, 2, 2, GL_FLOAT, GL_FALSE, offsetof(TerrainVertex, texcoord));
+    glVertexArrayAttribBinding(m_vao, 2, 0);
+}
+
+TerrainMesh::~TerrainMesh() {
+    glDeleteVertexArrays(1, &m_vao);
+    glDeleteBuffers(1, &m_vertexBuffer);
+    glDeleteBuffers(1, &m_indexBuffer);
+}
@@ -0,0 +1,33 @@
+// TerrainMesh.hpp
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <GL/glew.h>
+#include "TerrainMeshBuilder.hpp"
+
+// GPU copy of a TerrainMeshData: one vertex buffer and one 16-bit index buffer behind a
+// VAO with the usual attribute locations (0 position, 1 normal, 2 texture coordinates).
+// Only the chunk table stays on the CPU, for culling; vertices and indices are dropped
+// once uploaded.
+class TerrainMesh {
+public:
+    explicit TerrainMesh(const TerrainMeshData& data);
+    ~TerrainMesh();
+
+    TerrainMesh(const TerrainMesh&) = delete;
+    TerrainMesh& operator=(const TerrainMesh&) = delete;
+
+    GLuint vao() const { return m_vao; }
+    const std::vector<TerrainChunk>& chunks() const { return m_chunks; }
+    size_t triangleCount() const { return m_triangles; }
+    size_t bytes() const { return m_bytes; } // GPU buffers
+
+private:
+    GLuint m_vao = 0;
+    GLuint m_vertexBuffer = 0;
+    GLuint m_indexBuffer = 0;
+    std::vector<TerrainChunk> m_chunks;
+    size_t m_triangles = 0;
+    size_t m_bytes = 0;
+};
@@ -0,0 +1,114 @@
+// TerrainMeshBuilder.cpp
+#include "TerrainMeshBuilder.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+#include "ThreadPool.hpp"
+
+namespace {
+    std::uint32_t packNormal(const glm::vec3& normal) {
+        auto component = [](float value, int shift) {
+            const int scaled = static_cast<int>(std::lround(std::clamp(value, -1.0f, 1.0f) * 511.0f));
+            return (static_cast<std::uint32_t>(scaled) & 0x3FFu) << shift;
+        };
+        return component(normal.x, 0) | component(normal.y, 10) | component(normal.z, 20);
+    }
+
+    // Two triangles per quad of a columns x rows quad grid, vertices row major
+    void appendPattern(int columns, int rows, std::vector<std::uint16_t>& indices) {
+        for (int z = 0; z < rows; z++) {
+            for (int x = 0; x < columns; x++) {
+                const auto v0 = static_cast<std::uint16_t>(z * (columns + 1) + x);
+                const auto v1 = static_cast<std::uint16_t>(v0 + 1);
+                const auto v2 = static_cast<std::uint16_t>(v0 + columns + 2);
+                const auto v3 = static_cast<std::uint16_t>(v0 + columns + 1);
+                indices.insert(indices.end(), {v0, v1, v2, v0, v2, v3});
+            }
+        }
+    }
+}
+
+TerrainMeshData buildTerrainMesh(const TerrainQuery& terrain, const TerrainMeshSettings& settings) {
+    TerrainMeshData mesh;
+    const int step = std::max(settings.step, 1);
+    const int chunkQuads = std::clamp(settings.chunkQuads, 1, 254);
+    // Vertex grid over the texels at the step, the last vertex on the last texel
+    const int quadsX = (terrain.columns() - 1) / step, quadsZ = (terrain.rows() - 1) / step;
+    if (quadsX < 1 || quadsZ < 1) return mesh;
+
+    const int chunksX = (quadsX + chunkQuads - 1) / chunkQuads, chunksZ = (quadsZ + chunkQuads - 1) / chunkQuads;
+    const TerrainLayout& layout = terrain.layout();
+
+    // Chunk placement and the index pattern for each distinct chunk size
+    std::map<std::pair<int, int>, std::pair<std::uint32_t, std::uint32_t>> patterns;
+    size_t vertexCount = 0;
+    mesh.chunks.resize(static_cast<size_t>(chunksX) * chunksZ);
+    for (int cz = 0; cz < chunksZ; cz++) {
+        for (int cx = 0; cx < chunksX; cx++) {
+            const int columns = std::min(chunkQuads, quadsX - cx * chunkQuads);
+            const int rows = std::min(chunkQuads, quadsZ - cz * chunkQuads);
+            auto [it, added] = patterns.try_emplace({columns, rows});
+            if (added) {
+                it->second.first = static_cast<std::uint32_t>(mesh.indices.size());
+                appendPattern(columns, rows, mesh.indices);
+                it->second.second = static_cast<std::uint32_t>(mesh.indices.size()) - it->second.first;
+            }
+            TerrainChunk& chunk = mesh.chunks[static_cast<size_t>(cz) * chunksX + cx];
+            chunk.baseVertex = static_cast<std::int32_t>(vertexCount);
+            chunk.firstIndex = it->second.first;
+            chunk.indexCount = it->second.second;
+            vertexCount += static_cast<size_t>(columns + 1) * (rows + 1);
+        }
+    }
+    mesh.vertices.resize(vertexCount);
+
+    // Each task fills one row of chunks; chunks own disjoint vertex ranges
+    ThreadPool pool(settings.threads);
+    pool.run(static_cast<size_t>(chunksZ), [&](size_t task) {
+        const int cz = static_cast<int>(task);
+        for (int cx = 0; cx < chunksX; cx++) {
+            TerrainChunk& chunk = mesh.chunks[static_cast<size_t>(cz) * chunksX + cx];
+            const int columns = std::min(chunkQuads, quadsX - cx * chunkQuads);
+            const int rows = std::min(chunkQuads, quadsZ - cz * chunkQuads);
+            TerrainVertex* out = mesh.vertices.data() + chunk.baseVertex;
+            float low = 1e30f, high = -1e30f;
+
+            for (int z = 0; z <= rows; z++) {
+                const int tz = (cz * chunkQuads + z) * step;
+                for (int x = 0; x <= columns; x++) {
+                    const int tx = (cx * chunkQuads + x) * step;
+                    const float height = terrain.texelHeight(tx, tz);
+                    // Central differences one step apart, the edges extend outwards
+                    const float dx = terrain.texelHeight(tx + step, tz) - terrain.texelHeight(tx - step, tz);
+                    const float dz = terrain.texelHeight(tx, tz + step) - terrain.texelHeight(tx, tz - step);
+                    const glm::vec3 normal = glm::normalize(glm::vec3(-dx, 2.0f * step * layout.worldScale, -dz));
+
+                    out->position = glm::vec3(layout.origin.x + tx * layout.worldScale, height,
+                                              layout.origin.y + tz * layout.worldScale);
+                    out->normal = packNormal(normal);
+                    out->texcoord = glm::vec2(static_cast<float>(tx) / terrain.columns(),
+                                              static_cast<float>(tz) / terrain.rows()) * settings.textureTiling;
+                    out++;
+                    low = std::min(low, height);
+                    high = std::max(high, height);
+                }
+            }
+
+            const int firstX = cx * chunkQuads * step, firstZ = cz * chunkQuads * step;
+            chunk.boundsMin = glm::vec3(layout.origin.x + firstX * layout.worldScale, low,
+                                        layout.origin.y + firstZ * layout.worldScale);
+            chunk.boundsMax = glm::vec3(layout.origin.x + (firstX + columns * step) * layout.worldScale, high,
+                                        layout.origin.y + (firstZ + rows * step) * layout.worldScale);
+        }
+    });
+    return mesh;
+}
+
+size_t legacyTerrainMeshBytes(const TerrainQuery& terrain, int step) {
+    step = std::max(step, 1);
+    const size_t quadsX = terrain.columns() > 1 ? static_cast<size_t>(terrain.columns() - 1) / step : 0;
+    const size_t quadsZ = terrain.rows() > 1 ? static_cast<size_t>(terrain.rows() - 1) / step : 0;
+    const size_t legacyVertex = 3 * sizeof(float) + 3 * sizeof(float) + 2 * sizeof(float);
+    return quadsX * quadsZ * (4 * legacyVertex + 6 * sizeof(std::uint32_t));
+}
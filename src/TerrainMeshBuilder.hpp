@@ -0,0 +1,53 @@
+// TerrainMeshBuilder.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "TerrainQuery.hpp"
+
+struct TerrainMeshSettings {
+    int step = 2;           // heightmap texels between neighbouring vertices
+    int chunkQuads = 128;   // quads per chunk side, at most 254 so a chunk's vertices fit 16-bit indices
+    int threads = 0;        // 0 = one per hardware thread
+    float textureTiling = 15.0f;
+};
+
+// 24 bytes: position, normal packed as signed normalized 10:10:10:2, texture coordinates
+struct TerrainVertex {
+    glm::vec3 position;
+    std::uint32_t normal;
+    glm::vec2 texcoord;
+};
+static_assert(sizeof(TerrainVertex) == 24, "TerrainVertex must stay tightly packed");
+
+// One square of the terrain, drawn with 16-bit indices relative to baseVertex
+struct TerrainChunk {
+    std::int32_t baseVertex = 0;
+    std::uint32_t firstIndex = 0;
+    std::uint32_t indexCount = 0;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+};
+
+struct TerrainMeshData {
+    std::vector<TerrainVertex> vertices;
+    std::vector<std::uint16_t> indices;
+    std::vector<TerrainChunk> chunks;
+
+    size_t bytes() const {
+        return vertices.size() * sizeof(TerrainVertex) + indices.size() * sizeof(std::uint16_t);
+    }
+};
+
+// Builds the terrain mesh as chunks of shared vertices, one per sample, with smooth normals
+// from central differences. A chunk stores its own (quads + 1)^2 vertices (only the shared
+// border rows are duplicated), so all chunks of one size share a single 16-bit index pattern
+// and the index buffer holds just the few distinct sizes at the heightmap's edges. Rows of
+// chunks are generated in parallel.
+TerrainMeshData buildTerrainMesh(const TerrainQuery& terrain, const TerrainMeshSettings& settings);
+
+// Size the same heightmap took in the original layout: four vertices (position, normal and
+// texture coordinates as floats) with a flat normal per quad and six 32-bit indices
+size_t legacyTerrainMeshBytes(const TerrainQuery& terrain, int step);
@@ -0,0 +1,312 @@
+// TerrainQuery.cpp
+#include "TerrainQuery.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TERRAIN_QUERY_SSE 1
+#include <emmintrin.h>
+#endif
+
+void TerrainQuery::build(const std::uint8_t* heights, int columns, int rows, size_t stride, const TerrainLayout& layout) {
+    reset(heights != nullptr, columns, rows, layout);
+    for (int z = 0; z < rows; z++) {
+        const std::uint8_t* row = heights + z * stride;
+        for (int x = 0; x < columns; x++) {
+            m_heights[static_cast<size_t>(z) * columns + x] = layout.baseY + row[x] * layout.heightScale;
+        }
+    }
+    buildLevels();
+}
+
+void TerrainQuery::build(const std::uint16_t* heights, int columns, int rows, size_t stride, const TerrainLayout& layout) {
+    reset(heights != nullptr, columns, rows, layout);
+    for (int z = 0; z < rows; z++) {
+        const std::uint16_t* row = reinterpret_cast<const std::uint16_t*>(reinterpret_cast<const std::uint8_t*>(heights) + z * stride);
+        for (int x = 0; x < columns; x++) {
+            m_heights[static_cast<size_t>(z) * columns + x] = layout.baseY + row[x] * layout.heightScale;
+        }
+    }
+    buildLevels();
+}
+
+void TerrainQuery::reset(bool valid, int columns, int rows, const TerrainLayout& layout) {
+    if (!valid || columns < 2 || rows < 2) {
+        throw std::runtime_error("Terrain heightmap must be at least 2x2 texels");
+    }
+    m_columns = columns;
+    m_rows = rows;
+    m_layout = layout;
+    m_heights.resize(static_cast<size_t>(columns) * rows);
+}
+
+void TerrainQuery::buildLevels() {
+    const int columns = m_columns, rows = m_rows;
+
+    // Level 0: highest corner of every cell, then halve until a single node is left
+    m_levels.clear();
+    Level base{columns - 1, rows - 1};
+    base.maxHeight.resize(static_cast<size_t>(base.width) * base.height);
+    for (int z = 0; z < base.height; z++) {
+        for (int x = 0; x < base.width; x++) {
+            base.maxHeight[static_cast<size_t>(z) * base.width + x] =
+                std::max({texel(x, z), texel(x + 1, z), texel(x, z + 1), texel(x + 1, z + 1)});
+        }
+    }
+    m_levels.push_back(std::move(base));
+
+    while (m_levels.back().width > 1 || m_levels.back().height > 1) {
+        const Level& below = m_levels.back();
+        Level level{(below.width + 1) / 2, (below.height + 1) / 2};
+        level.maxHeight.assign(static_cast<size_t>(level.width) * level.height, -std::numeric_limits<float>::infinity());
+        for (int z = 0; z < below.height; z++) {
+            for (int x = 0; x < below.width; x++) {
+                float& node = level.maxHeight[static_cast<size_t>(z / 2) * level.width + x / 2];
+                node = std::max(node, below.maxHeight[static_cast<size_t>(z) * below.width + x]);
+            }
+        }
+        m_levels.push_back(std::move(level));
+    }
+}
+
+void TerrainQuery::locate(float worldX, float worldZ, int& cellX, int& cellZ, float& fx, float& fz) const {
+    float u = std::clamp((worldX - m_layout.origin.x) / m_layout.worldScale, 0.0f, static_cast<float>(m_columns - 1));
+    float v = std::clamp((worldZ - m_layout.origin.y) / m_layout.worldScale, 0.0f, static_cast<float>(m_rows - 1));
+    cellX = std::min(static_cast<int>(u), m_columns - 2);
+    cellZ = std::min(static_cast<int>(v), m_rows - 2);
+    fx = u - cellX;
+    fz = v - cellZ;
+}
+
+float TerrainQuery::height(float worldX, float worldZ) const {
+    if (empty()) return m_layout.baseY;
+
+    int x, z;
+    float fx, fz;
+    locate(worldX, worldZ, x, z, fx, fz);
+    float top = texel(x, z) + (texel(x + 1, z) - texel(x, z)) * fx;
+    float bottom = texel(x, z + 1) + (texel(x + 1, z + 1) - texel(x, z + 1)) * fx;
+    return top + (bottom - top) * fz;
+}
+
+glm::vec3 TerrainQuery::normal(float worldX, float worldZ) const {
+    if (empty()) return glm::vec3(0.0f, 1.0f, 0.0f);
+
+    int x, z;
+    float fx, fz;
+    locate(worldX, worldZ, x, z, fx, fz);
+    float h00 = texel(x, z), h10 = texel(x + 1, z);
+    float h01 = texel(x, z + 1), h11 = texel(x + 1, z + 1);
+
+    // Partial derivatives of the bilinear patch, per texel, then per world unit
+    float dhdx = ((h10 - h00) * (1.0f - fz) + (h11 - h01) * fz) / m_layout.worldScale;
+    float dhdz = ((h01 - h00) * (1.0f - fx) + (h11 - h10) * fx) / m_layout.worldScale;
+    return glm::normalize(glm::vec3(-dhdx, 1.0f, -dhdz));
+}
+
+void TerrainQuery::heights(const float* worldX, const float* worldZ, float* out, size_t count) const {
+    if (empty()) {
+        std::fill(out, out + count, m_layout.baseY);
+        return;
+    }
+
+    size_t i = 0;
+#ifdef TERRAIN_QUERY_SSE
+    const __m128 invScale = _mm_set1_ps(1.0f / m_layout.worldScale);
+    const __m128 originX = _mm_set1_ps(m_layout.origin.x);
+    const __m128 originZ = _mm_set1_ps(m_layout.origin.y);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 maxU = _mm_set1_ps(static_cast<float>(m_columns - 1));
+    const __m128 maxV = _mm_set1_ps(static_cast<float>(m_rows - 1));
+    const __m128 lastCellX = _mm_set1_ps(static_cast<float>(m_columns - 2));
+    const __m128 lastCellZ = _mm_set1_ps(static_cast<float>(m_rows - 2));
+    const __m128 rowStride = _mm_set1_ps(static_cast<float>(m_columns));
+    const float* texels = m_heights.data();
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 u = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(worldX + i), originX), invScale);
+        __m128 v = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(worldZ + i), originZ), invScale);
+        u = _mm_min_ps(_mm_max_ps(u, zero), maxU);
+        v = _mm_min_ps(_mm_max_ps(v, zero), maxV);
+
+        // u, v are >= 0 here, so truncation is floor
+        __m128 cellX = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(u)), lastCellX);
+        __m128 cellZ = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(v)), lastCellZ);
+        __m128 fx = _mm_sub_ps(u, cellX);
+        __m128 fz = _mm_sub_ps(v, cellZ);
+
+        // Heightmaps stay far below 2^24 texels, so the index is exact in float
+        alignas(16) std::int32_t index[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(index),
+                        _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(cellZ, rowStride), cellX)));
+
+        // No gather in SSE2, the four corners are loaded one lane at a time
+        const float* p0 = texels + index[0];
+        const float* p1 = texels + index[1];
+        const float* p2 = texels + index[2];
+        const float* p3 = texels + index[3];
+        const size_t below = m_columns;
+        __m128 h00 = _mm_setr_ps(p0[0], p1[0], p2[0], p3[0]);
+        __m128 h10 = _mm_setr_ps(p0[1], p1[1], p2[1], p3[1]);
+        __m128 h01 = _mm_setr_ps(p0[below], p1[below], p2[below], p3[below]);
+        __m128 h11 = _mm_setr_ps(p0[below + 1], p1[below + 1], p2[below + 1], p3[below + 1]);
+
+        __m128 top = _mm_add_ps(h00, _mm_mul_ps(_mm_sub_ps(h10, h00), fx));
+        __m128 bottom = _mm_add_ps(h01, _mm_mul_ps(_mm_sub_ps(h11, h01), fx));
+        _mm_storeu_ps(out + i, _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), fz)));
+    }
+#endif
+
+    // Remainder (or everything without SSE)
+    for (; i < count; i++) {
+        out[i] = height(worldX[i], worldZ[i]);
+    }
+}
+
+bool TerrainQuery::intersectCell(int cellX, int cellZ, const glm::vec3& origin, const glm::vec3& direction,
+                                 float t0, float t1, float& t) const {
+    float h00 = texel(cellX, cellZ), h10 = texel(cellX + 1, cellZ);
+    float h01 = texel(cellX, cellZ + 1), h11 = texel(cellX + 1, cellZ + 1);
+
+    // Along the ray the patch height is quadratic in t: h(fx(t), fz(t)) - y(t) = a t^2 + b t + c
+    float fx0 = origin.x - cellX, fz0 = origin.z - cellZ;
+    float bx = h10 - h00, bz = h01 - h00, bxz = h00 - h10 - h01 + h11;
+    float a = bxz * direction.x * direction.z;
+    float b = bx * direction.x + bz * direction.z + bxz * (fx0 * direction.z + fz0 * direction.x) - direction.y;
+    float c = h00 + bx * fx0 + bz * fz0 + bxz * fx0 * fz0 - origin.y;
+
+    auto above = [&](float s) { return (a * s + b) * s + c; }; // surface minus ray height
+    if (above(t0) >= 0.0f) {
+        t = t0; // already at or under the surface where the ray enters the cell
+        return true;
+    }
+
+    float roots[2];
+    int rootCount = 0;
+    if (std::abs(a) < 1e-12f) {
+        if (b != 0.0f) roots[rootCount++] = -c / b;
+    } else {
+        float discriminant = b * b - 4.0f * a * c;
+        if (discriminant < 0.0f) return false;
+        // Numerically stable pair of roots
+        float q = -0.5f * (b + std::copysign(std::sqrt(discriminant), b));
+        if (q != 0.0f) roots[rootCount++] = c / q;
+        roots[rootCount++] = q / a;
+    }
+
+    float best = std::numeric_limits<float>::infinity();
+    for (int i = 0; i < rootCount; i++) {
+        if (roots[i] >= t0 && roots[i] <= t1) best = std::min(best, roots[i]);
+    }
+    if (best == std::numeric_limits<float>::infinity()) return false;
+    t = best;
+    return true;
+}
+
+bool TerrainQuery::raycast(const glm::vec3& worldOrigin, const glm::vec3& worldDirection, float maxT, float* t) const {
+    if (empty() || maxT < 0.0f) return false;
+
+    // Work in texel units on XZ; t is unchanged by the affine map
+    const glm::vec3 origin((worldOrigin.x - m_layout.origin.x) / m_layout.worldScale, worldOrigin.y,
+                           (worldOrigin.z - m_layout.origin.y) / m_layout.worldScale);
+    const glm::vec3 direction(worldDirection.x / m_layout.worldScale, worldDirection.y,
+                              worldDirection.z / m_layout.worldScale);
+    const glm::vec3 inverse = 1.0f / direction;
+
+    // Ray interval inside a node's box, the box reaching from -inf up to the node's max height
+    auto clip = [&](float minX, float maxX, float minZ, float maxZ, float top, float limit, float& enter, float& exit) {
+        enter = 0.0f;
+        exit = limit;
+        auto slab = [&](float start, float inv, float dir, float low, float high) {
+            if (dir == 0.0f) return start >= low && start <= high;
+            float a = (low - start) * inv, b = (high - start) * inv;
+            if (a > b) std::swap(a, b);
+            enter = std::max(enter, a);
+            exit = std::min(exit, b);
+            return enter <= exit;
+        };
+        if (!slab(origin.x, inverse.x, direction.x, minX, maxX)) return false;
+        if (!slab(origin.z, inverse.z, direction.z, minZ, maxZ)) return false;
+        return slab(origin.y, inverse.y, direction.y, -std::numeric_limits<float>::infinity(), top);
+    };
+
+    struct Node {
+        int level, x, z;
+    };
+    // Depth first, nearer children first, so the first leaf hit is usually the answer;
+    // later nodes are still clipped against it so a closer hit can't be missed
+    Node stack[4 * 32];
+    int top = 0;
+    stack[top++] = {static_cast<int>(m_levels.size()) - 1, 0, 0};
+    float best = maxT;
+    bool found = false;
+
+    while (top > 0) {
+        Node node = stack[--top];
+        const Level& level = m_levels[node.level];
+        const int span = 1 << node.level;
+        const float minX = static_cast<float>(node.x * span);
+        const float minZ = static_cast<float>(node.z * span);
+        const float maxX = static_cast<float>(std::min((node.x + 1) * span, m_columns - 1));
+        const float maxZ = static_cast<float>(std::min((node.z + 1) * span, m_rows - 1));
+        const float nodeMax = level.maxHeight[static_cast<size_t>(node.z) * level.width + node.x];
+
+        float enter, exit;
+        if (!clip(minX, maxX, minZ, maxZ, nodeMax, best, enter, exit)) continue;
+
+        if (node.level == 0) {
+            float hit;
+            if (intersectCell(node.x, node.z, origin, direction, enter, exit, hit) && hit <= best) {
+                best = hit;
+                found = true;
+            }
+            continue;
+        }
+
+        // Children in this level's grid, sorted far to near so the nearest is popped first
+        const Level& below = m_levels[node.level - 1];
+        Node children[4];
+        float entries[4];
+        int childCount = 0;
+        for (int dz = 0; dz < 2; dz++) {
+            for (int dx = 0; dx < 2; dx++) {
+                int cx = node.x * 2 + dx, cz = node.z * 2 + dz;
+                if (cx >= below.width || cz >= below.height) continue;
+                const int childSpan = span / 2;
+                float childEnter, childExit;
+                float childMax = below.maxHeight[static_cast<size_t>(cz) * below.width + cx];
+                if (!clip(static_cast<float>(cx * childSpan), static_cast<float>(std::min((cx + 1) * childSpan, m_columns - 1)),
+                          static_cast<float>(cz * childSpan), static_cast<float>(std::min((cz + 1) * childSpan, m_rows - 1)),
+                          childMax, best, childEnter, childExit)) {
+                    continue;
+                }
+                children[childCount] = {node.level - 1, cx, cz};
+                entries[childCount] = childEnter;
+                childCount++;
+            }
+        }
+        for (int i = 0; i < childCount; i++) {
+            for (int j = i + 1; j < childCount; j++) {
+                if (entries[j] > entries[i]) {
+                    std::swap(entries[i], entries[j]);
+                    std::swap(children[i], children[j]);
+                }
+            }
+        }
+        for (int i = 0; i < childCount; i++) {
+            stack[top++] = children[i];
+        }
+    }
+
+    if (found && t) *t = best;
+    return found;
+}
+
+bool TerrainQuery::intersectSegment(const glm::vec3& a, const glm::vec3& b, glm::vec3* hit) const {
+    float t;
+    if (!raycast(a, b - a, 1.0f, &t)) return false;
+    if (hit) *hit = a + (b - a) * t;
+    return true;
+}
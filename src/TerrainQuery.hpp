@@ -0,0 +1,86 @@
+// TerrainQuery.hpp
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Placement of a heightmap in the world, shared by the terrain mesh and the queries so
+// both agree on where every texel ends up
+struct TerrainLayout {
+    float worldScale = 0.2f;                   // world units between neighbouring texels
+    float heightScale = 1.0f / 255.0f * 20.0f; // world units per height step
+    float baseY = 0.0f;
+    glm::vec2 origin = glm::vec2(0.0f);        // world XZ of texel (0, 0)
+
+    // Layout with the heightmap centered on the world origin
+    static TerrainLayout centered(int columns, int rows, float worldScale, float heightScale, float baseY = 0.0f) {
+        return {worldScale, heightScale, baseY, -glm::vec2(columns, rows) * worldScale * 0.5f};
+    }
+};
+
+// CPU side of the terrain: height and normal lookups for gameplay, and ray casts against
+// the surface. The surface is the bilinear interpolation of the texels (the rendered mesh
+// is a triangulation of it at the mesh's step size). Outside the heightmap the edge
+// texels extend outwards.
+//
+// Ray casts descend a max-mip quadtree: every level stores the highest point of 2x2 nodes
+// of the level below, so whole regions the ray passes above are skipped at once and only
+// the few cells near the surface are intersected exactly.
+class TerrainQuery {
+public:
+    // heights: columns x rows 8-bit samples, row major with the given stride in bytes
+    void build(const std::uint8_t* heights, int columns, int rows, size_t stride, const TerrainLayout& layout);
+    // Same from 16-bit samples, stride still in bytes
+    void build(const std::uint16_t* heights, int columns, int rows, size_t stride, const TerrainLayout& layout);
+
+    float height(float worldX, float worldZ) const;
+    // Normal of the bilinear surface, from its exact partial derivatives
+    glm::vec3 normal(float worldX, float worldZ) const;
+
+    // Heights for count points given as separate x and z arrays, four at a time with SSE
+    void heights(const float* worldX, const float* worldZ, float* out, size_t count) const;
+
+    // First hit of origin + direction * t for t in [0, maxT]. t is in units of direction.
+    // Only the heightmap's footprint is hit, and a ray starting under the surface hits at 0.
+    bool raycast(const glm::vec3& origin, const glm::vec3& direction, float maxT, float* t = nullptr) const;
+    // Whether the segment from a to b passes under the surface; hit gets the first contact
+    bool intersectSegment(const glm::vec3& a, const glm::vec3& b, glm::vec3* hit = nullptr) const;
+    bool lineOfSight(const glm::vec3& a, const glm::vec3& b) const { return !intersectSegment(a, b); }
+
+    // World height of texel (x, z), clamped to the heightmap
+    float texelHeight(int x, int z) const {
+        return texel(std::clamp(x, 0, m_columns - 1), std::clamp(z, 0, m_rows - 1));
+    }
+
+    bool empty() const { return m_heights.empty(); }
+    int columns() const { return m_columns; }
+    int rows() const { return m_rows; }
+    const TerrainLayout& layout() const { return m_layout; }
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+
+private:
+    // Max heights of one quadtree level, level 0 has one node per cell (4 texels)
+    struct Level {
+        int width = 0;
+        int height = 0;
+        std::vector<float> maxHeight;
+    };
+
+    float texel(int x, int z) const { return m_heights[static_cast<size_t>(z) * m_columns + x]; }
+    void reset(bool valid, int columns, int rows, const TerrainLayout& layout);
+    void buildLevels();
+    // Cell and position inside it of a world point, clamped to the heightmap
+    void locate(float worldX, float worldZ, int& cellX, int& cellZ, float& fx, float& fz) const;
+    // Exact hit of the ray (in texel units) with one cell's bilinear patch within [t0, t1]
+    bool intersectCell(int cellX, int cellZ, const glm::vec3& origin, const glm::vec3& direction,
+                       float t0, float t1, float& t) const;
+
+    int m_columns = 0;
+    int m_rows = 0;
+    TerrainLayout m_layout;
+    std::vector<float> m_heights; // world space heights, baseY and heightScale applied
+    std::vector<Level> m_levels;
+};
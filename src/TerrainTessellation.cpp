@@ -0,0 +1,76 @@
+// TerrainTessellation.cpp
+#include "TerrainTessellation.hpp"
+#include <algorithm>
+#include <cmath>
+
+void TerrainTessellation::build(const TerrainQuery& terrain, const TerrainTessellationSettings& settings) {
+    m_settings = settings;
+    m_settings.patchCells = std::max(settings.patchCells, 1);
+    m_settings.maxLevel = std::clamp(settings.maxLevel, 1, 64);
+    m_corners.clear();
+    m_cornerRoughness.clear();
+    m_indices.clear();
+    m_patchHeights.clear();
+    if (terrain.columns() < 2 || terrain.rows() < 2) return;
+
+    const TerrainLayout& layout = terrain.layout();
+    const int cellsX = terrain.columns() - 1, cellsZ = terrain.rows() - 1;
+    const int size = m_settings.patchCells;
+    const int patchesX = (cellsX + size - 1) / size, patchesZ = (cellsZ + size - 1) / size;
+
+    // Corners on the patch grid, the last row and column on the heightmap's edge
+    auto cornerTexel = [&](int i, int cells) { return std::min(i * size, cells); };
+    for (int z = 0; z <= patchesZ; z++) {
+        for (int x = 0; x <= patchesX; x++) {
+            m_corners.push_back(layout.origin + glm::vec2(cornerTexel(x, cellsX), cornerTexel(z, cellsZ)) * layout.worldScale);
+        }
+    }
+
+    // Height bounds and deviation from the bilinear surface through the corners
+    std::vector<float> roughness(static_cast<size_t>(patchesX) * patchesZ, 0.0f);
+    float roughest = 0.0f;
+    for (int pz = 0; pz < patchesZ; pz++) {
+        for (int px = 0; px < patchesX; px++) {
+            const int x0 = cornerTexel(px, cellsX), x1 = cornerTexel(px + 1, cellsX);
+            const int z0 = cornerTexel(pz, cellsZ), z1 = cornerTexel(pz + 1, cellsZ);
+            const float h00 = terrain.texelHeight(x0, z0), h10 = terrain.texelHeight(x1, z0);
+            const float h01 = terrain.texelHeight(x0, z1), h11 = terrain.texelHeight(x1, z1);
+
+            glm::vec2 bounds(1e30f, -1e30f);
+            float deviation = 0.0f;
+            for (int z = z0; z <= z1; z++) {
+                const float fz = static_cast<float>(z - z0) / (z1 - z0);
+                for (int x = x0; x <= x1; x++) {
+                    const float fx = static_cast<float>(x - x0) / (x1 - x0);
+                    const float h = terrain.texelHeight(x, z);
+                    const float flat = (h00 * (1 - fx) + h10 * fx) * (1 - fz) + (h01 * (1 - fx) + h11 * fx) * fz;
+                    bounds = glm::vec2(std::min(bounds.x, h), std::max(bounds.y, h));
+                    deviation = std::max(deviation, std::abs(h - flat));
+                }
+            }
+            m_patchHeights.push_back(bounds);
+            roughness[static_cast<size_t>(pz) * patchesX + px] = deviation;
+            roughest = std::max(roughest, deviation);
+
+            const std::uint32_t corner = static_cast<std::uint32_t>(pz * (patchesX + 1) + px);
+            m_indices.insert(m_indices.end(), {corner, corner + 1, corner + patchesX + 2, corner + patchesX + 1});
+        }
+    }
+
+    // Every corner takes the roughest patch around it
+    m_cornerRoughness.assign(m_corners.size(), 0.0f);
+    for (int pz = 0; pz < patchesZ; pz++) {
+        for (int px = 0; px < patchesX; px++) {
+            const float value = roughest > 0.0f ? roughness[static_cast<size_t>(pz) * patchesX + px] / roughest : 0.0f;
+            for (int c = 0; c < 4; c++) {
+                float& corner = m_cornerRoughness[static_cast<size_t>(pz + (c >> 1)) * (patchesX + 1) + px + (c & 1)];
+                corner = std::max(corner, value);
+            }
+        }
+    }
+}
+
+TerrainTessellationHeader TerrainTessellation::header(const TerrainLodHeader& terrain, float viewportHeight) const {
+    return {terrain, glm::vec4(std::max(m_settings.edgePixels, 1.0f), viewportHeight,
+                               static_cast<float>(m_settings.maxLevel), std::clamp(m_settings.flatDetail, 0.0f, 1.0f))};
+}
@@ -0,0 +1,56 @@
+// TerrainTessellation.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "TerrainLod.hpp"
+#include "TerrainQuery.hpp"
+
+struct TerrainTessellationSettings {
+    int patchCells = 64;      // heightmap cells per patch side
+    float edgePixels = 12.0f; // target screen length of a tessellated edge
+    int maxLevel = 64;        // at most 64 by the GL minimum
+    float flatDetail = 0.25f; // share of the screen-based detail kept on perfectly flat patches
+};
+
+// std430 mirror of the TerrainPatches header in terrain_patches.glsl; patch height bounds follow
+struct TerrainTessellationHeader {
+    TerrainLodHeader terrain;
+    glm::vec4 tessellation; // edge pixels, viewport height, max level, flat detail
+};
+static_assert(sizeof(TerrainTessellationHeader) == 48, "TerrainTessellationHeader must match std430 layout");
+
+// Coarse patches for the hardware tessellated terrain. The heightmap is cut into a grid of
+// square patches of shared corners; the GPU subdivides every patch edge by its projected
+// length, so triangle density follows the screen instead of the source data, and displaces
+// the points from the height texture.
+//
+// Roughness is the height variance metric: how far a patch's texels stray from the flat
+// surface through its corners, relative to the roughest patch. A corner carries the most
+// of its patches, and an edge uses the larger of its corners, so both patches along an
+// edge agree on its level.
+class TerrainTessellation {
+public:
+    void build(const TerrainQuery& terrain, const TerrainTessellationSettings& settings);
+
+    TerrainTessellationHeader header(const TerrainLodHeader& terrain, float viewportHeight) const;
+
+    // Corner world XZ positions and roughness [0, 1], 4 indices per patch, patch height bounds
+    const std::vector<glm::vec2>& corners() const { return m_corners; }
+    const std::vector<float>& cornerRoughness() const { return m_cornerRoughness; }
+    const std::vector<std::uint32_t>& indices() const { return m_indices; }
+    const std::vector<glm::vec2>& patchHeights() const { return m_patchHeights; } // (min, max), by gl_PrimitiveID
+
+    bool empty() const { return m_patchHeights.empty(); }
+    size_t patchCount() const { return m_patchHeights.size(); }
+    const TerrainTessellationSettings& settings() const { return m_settings; }
+
+private:
+    TerrainTessellationSettings m_settings;
+    std::vector<glm::vec2> m_corners;
+    std::vector<float> m_cornerRoughness;
+    std::vector<std::uint32_t> m_indices;
+    std::vector<glm::vec2> m_patchHeights;
+};
@@ -0,0 +1,171 @@
+// TerrainTileCache.cpp
+#include "TerrainTileCache.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cmath>
+
+TerrainTileCache::TerrainTileCache(const TerrainTiles& tiles, int radius) : m_tiles(tiles) {
+    // No wider than the terrain, or two tiles of the window would share a slot
+    m_side = std::min(2 * std::max(radius, 0) + 1, std::max(tiles.tilesX(), tiles.tilesZ()));
+    m_slots.resize(static_cast<size_t>(m_side) * m_side);
+    m_data.resize(m_slots.size() * tiles.tileSamples());
+    m_loaded.reserve(m_slots.size());
+    m_done.reserve(m_slots.size());
+    m_thread = std::thread(&TerrainTileCache::work, this);
+}
+
+TerrainTileCache::~TerrainTileCache() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    m_thread.join();
+}
+
+void TerrainTileCache::update(const glm::vec2& focus) {
+    m_loaded.clear();
+    const TerrainLayout& layout = m_tiles.layout();
+    const float tileWorld = m_tiles.tileSize() * layout.worldScale;
+    const glm::ivec2 center(std::clamp(static_cast<int>(std::floor((focus.x - layout.origin.x) / tileWorld)), 0, m_tiles.tilesX() - 1),
+                            std::clamp(static_cast<int>(std::floor((focus.y - layout.origin.y) / tileWorld)), 0, m_tiles.tilesZ() - 1));
+    // Window of side tiles around the center, shifted back inside the terrain at its edges
+    const int reach = (m_side - 1) / 2;
+    const glm::ivec2 first(std::clamp(center.x - reach, 0, std::max(m_tiles.tilesX() - m_side, 0)),
+                           std::clamp(center.y - reach, 0, std::max(m_tiles.tilesZ() - m_side, 0)));
+    const glm::ivec4 window(first.x, first.y, std::min(first.x + m_side, m_tiles.tilesX()) - 1,
+                            std::min(first.y + m_side, m_tiles.tilesZ()) - 1);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    for (Slot slot : m_done) {
+        m_slots[slot].state = State::Resident;
+        m_pending--;
+        m_loaded.push_back(slot);
+    }
+    m_done.clear();
+
+    for (int z = window.y; z <= window.w; z++) {
+        for (int x = window.x; x <= window.z; x++) {
+            const glm::ivec2 tile(x, z);
+            const Slot slot = slotOf(tile);
+            TileSlot& target = m_slots[slot];
+            if (target.coord == tile && target.state != State::Free) continue;
+            // The worker is filling it with the tile that's leaving, try again next update
+            if (slot == m_working) continue;
+            // Still queued for another tile, the job just picks up the new coordinate
+            if (target.state != State::Loading) {
+                target.state = State::Loading;
+                m_pending++;
+                m_jobs.push_back(slot);
+            }
+            target.coord = tile;
+        }
+    }
+
+    // A tile that came in but whose slot was just handed to another can't be reported
+    m_loaded.erase(std::remove_if(m_loaded.begin(), m_loaded.end(),
+                                  [&](Slot slot) { return m_slots[slot].state != State::Resident; }),
+                   m_loaded.end());
+
+    // Nearest first, by where the focus is now
+    std::sort(m_jobs.begin(), m_jobs.end(), [&](Slot a, Slot b) {
+        const glm::ivec2 da = m_slots[a].coord - center, db = m_slots[b].coord - center;
+        return da.x * da.x + da.y * da.y < db.x * db.x + db.y * db.y;
+    });
+
+    // Rendering moves to the new window once all of it is in; until then it keeps the part
+    // of the old one the move didn't reassign
+    if (allResident(window)) {
+        m_residentTiles = window;
+    } else {
+        m_residentTiles = glm::ivec4(std::max(m_residentTiles.x, window.x), std::max(m_residentTiles.y, window.y),
+                                     std::min(m_residentTiles.z, window.z), std::min(m_residentTiles.w, window.w));
+        if (!allResident(m_residentTiles)) m_residentTiles = glm::ivec4(0, 0, -1, -1);
+    }
+    if (m_residentTiles.z < m_residentTiles.x || m_residentTiles.w < m_residentTiles.y) {
+        m_residentRect = glm::ivec4(0, 0, -1, -1);
+    } else {
+        const int size = m_tiles.tileSize();
+        m_residentRect = glm::ivec4(m_residentTiles.x * size, m_residentTiles.y * size,
+                                    std::min((m_residentTiles.z + 1) * size, m_tiles.columns()) - 1,
+                                    std::min((m_residentTiles.w + 1) * size, m_tiles.rows()) - 1);
+    }
+
+    lock.unlock();
+    m_wake.notify_all();
+}
+
+void TerrainTileCache::finish() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_jobs.empty() && m_working == UINT32_MAX; });
+}
+
+bool TerrainTileCache::allResident(const glm::ivec4& tiles) const {
+    if (tiles.z < tiles.x || tiles.w < tiles.y) return false;
+    for (int z = tiles.y; z <= tiles.w; z++) {
+        for (int x = tiles.x; x <= tiles.z; x++) {
+            if (!resident(glm::ivec2(x, z))) return false;
+        }
+    }
+    return true;
+}
+
+std::uint16_t TerrainTileCache::sample(int x, int z, bool& hit) const {
+    x = std::clamp(x, 0, m_tiles.columns() - 1);
+    z = std::clamp(z, 0, m_tiles.rows() - 1);
+    const int size = m_tiles.tileSize();
+    const glm::ivec2 tile(x / size, z / size);
+    const size_t offset = static_cast<size_t>(z % size) * size + x % size;
+    if (resident(tile)) return data(slotOf(tile))[offset];
+    hit = false;
+    return m_tiles.tile(tile.x, tile.y)[offset];
+}
+
+float TerrainTileCache::height(float worldX, float worldZ) const {
+    const TerrainLayout& layout = m_tiles.layout();
+    const float u = std::clamp((worldX - layout.origin.x) / layout.worldScale, 0.0f, static_cast<float>(m_tiles.columns() - 1));
+    const float v = std::clamp((worldZ - layout.origin.y) / layout.worldScale, 0.0f, static_cast<float>(m_tiles.rows() - 1));
+    const int x = std::min(static_cast<int>(u), m_tiles.columns() - 2);
+    const int z = std::min(static_cast<int>(v), m_tiles.rows() - 2);
+    const float fx = u - x, fz = v - z;
+
+    bool hit = true;
+    const float h00 = sample(x, z, hit), h10 = sample(x + 1, z, hit);
+    const float h01 = sample(x, z + 1, hit), h11 = sample(x + 1, z + 1, hit);
+    (hit ? m_hits : m_misses)++;
+    const float top = h00 + (h10 - h00) * fx;
+    const float bottom = h01 + (h11 - h01) * fx;
+    return layout.baseY + (top + (bottom - top) * fz) * layout.heightScale;
+}
+
+size_t TerrainTileCache::residentCount() const {
+    return static_cast<size_t>(std::count_if(m_slots.begin(), m_slots.end(),
+                                             [](const TileSlot& slot) { return slot.state == State::Resident; }));
+}
+
+void TerrainTileCache::work() {
+    TRACE_THREAD_NAME("Terrain tiles");
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+        if (m_stop) return;
+
+        const Slot slot = m_jobs.front();
+        m_jobs.pop_front();
+        const glm::ivec2 coord = m_slots[slot].coord;
+        m_working = slot;
+        lock.unlock();
+
+        // Reading the mapping is what pages the tile in
+        {
+            TRACE_SCOPE("Tile page-in");
+            std::copy_n(m_tiles.tile(coord.x, coord.y), m_tiles.tileSamples(), m_data.data() + slot * m_tiles.tileSamples());
+        }
+
+        lock.lock();
+        m_working = UINT32_MAX;
+        m_done.push_back(slot);
+        if (m_jobs.empty()) m_idle.notify_all();
+    }
+}
@@ -0,0 +1,102 @@
+// TerrainTileCache.hpp
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+#include "TerrainTiles.hpp"
+
+// Keeps the tiles of a TerrainTiles file around a moving focus resident in memory, paging
+// them in from the mapping on a worker thread so page faults never stall the frame.
+//
+// The (2 * radius + 1)^2 tiles around the focus each have a fixed slot: tile (x, z) lives
+// in slot (x mod side, z mod side). A tile leaving the window frees exactly the slot the
+// one entering on the other side needs, so nothing is searched or evicted, and a texture
+// laid out the same way (windowOffset()) can be sampled with wrap-around at global sample
+// coordinates divided by windowSamples().
+//
+// Threading: update() and every query are for one thread. The worker only writes to the
+// slot it was handed, which that thread doesn't read until update() reports it loaded.
+class TerrainTileCache {
+public:
+    using Slot = std::uint32_t;
+
+    TerrainTileCache(const TerrainTiles& tiles, int radius);
+    ~TerrainTileCache();
+
+    TerrainTileCache(const TerrainTileCache&) = delete;
+    TerrainTileCache& operator=(const TerrainTileCache&) = delete;
+
+    // Collects paged in tiles into loaded(), then queues the window's missing tiles around
+    // the world position focus (xz), nearest first
+    void update(const glm::vec2& focus);
+    // Blocks until every queued tile is in; the next update() reports them
+    void finish();
+
+    const std::vector<Slot>& loaded() const { return m_loaded; }
+    const std::uint16_t* data(Slot slot) const { return m_data.data() + slot * m_tiles.tileSamples(); }
+    const glm::ivec2& coord(Slot slot) const { return m_slots[slot].coord; }
+    glm::ivec2 windowOffset(Slot slot) const {
+        return glm::ivec2(slot % m_side, slot / m_side) * m_tiles.tileSize();
+    }
+    int windowSamples() const { return m_side * m_tiles.tileSize(); }
+
+    // Samples (min x, min z, max x, max z) whose tiles are all resident, so a window texture
+    // with every loaded() tile uploaded is valid between them; max < min while none are
+    const glm::ivec4& residentRect() const { return m_residentRect; }
+
+    // Bilinear world height like TerrainQuery::height. Samples of tiles that aren't resident
+    // are read from the mapping directly, which may page them in on this thread.
+    float height(float worldX, float worldZ) const;
+
+    size_t hits() const { return m_hits; }
+    size_t misses() const { return m_misses; }
+    size_t residentCount() const;
+    size_t pendingCount() const { return m_pending; }
+    size_t bytes() const { return m_data.capacity() * sizeof(std::uint16_t) + m_slots.capacity() * sizeof(TileSlot); }
+
+private:
+    enum class State : std::uint8_t { Free, Loading, Resident };
+
+    struct TileSlot {
+        State state = State::Free;
+        glm::ivec2 coord = glm::ivec2(-1);
+    };
+
+    Slot slotOf(const glm::ivec2& tile) const {
+        return static_cast<Slot>((tile.y % m_side) * m_side + tile.x % m_side);
+    }
+    bool resident(const glm::ivec2& tile) const {
+        const TileSlot& slot = m_slots[slotOf(tile)];
+        return slot.state == State::Resident && slot.coord == tile;
+    }
+    bool allResident(const glm::ivec4& tiles) const;
+    std::uint16_t sample(int x, int z, bool& hit) const;
+    void work();
+
+    const TerrainTiles& m_tiles;
+    int m_side = 1;
+    std::vector<TileSlot> m_slots;
+    std::vector<std::uint16_t> m_data;
+    size_t m_pending = 0;
+    std::vector<Slot> m_loaded;
+    glm::ivec4 m_residentTiles = glm::ivec4(0, 0, -1, -1);
+    glm::ivec4 m_residentRect = glm::ivec4(0, 0, -1, -1);
+    mutable size_t m_hits = 0;
+    mutable size_t m_misses = 0;
+
+    // Shared with the worker
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::deque<Slot> m_jobs;
+    std::vector<Slot> m_done;
+    Slot m_working = UINT32_MAX;
+    bool m_stop = false;
+    std::thread m_thread;
+};
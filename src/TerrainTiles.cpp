@@ -0,0 +1,290 @@
+// TerrainTiles.cpp
+#include "TerrainTiles.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr char MAGIC[4] = {'P', 'G', '2', 'T'};
+    constexpr std::uint32_t VERSION = 1;
+    constexpr std::uint64_t TILE_ALIGNMENT = 64 * 1024;
+
+    int ceilDiv(int value, int divisor) { return (value + divisor - 1) / divisor; }
+
+    // Level sizes of the min/max pyramid over a tilesX x tilesZ grid, total nodes returned
+    size_t pyramidShape(int tilesX, int tilesZ, std::vector<glm::ivec2>* levels = nullptr) {
+        size_t nodes = 0;
+        glm::ivec2 size(tilesX, tilesZ);
+        while (true) {
+            if (levels) levels->push_back(size);
+            nodes += static_cast<size_t>(size.x) * size.y;
+            if (size.x == 1 && size.y == 1) return nodes;
+            size = glm::ivec2((size.x + 1) / 2, (size.y + 1) / 2);
+        }
+    }
+}
+
+void writeTerrainTiles(const std::string& path, int columns, int rows, const TerrainLayout& layout,
+                       const TerrainTilesWriteSettings& settings,
+                       const std::function<void(int, std::uint16_t*)>& rowSource) {
+    if (columns < 2 || rows < 2) {
+        throw std::runtime_error("Terrain heightfield must be at least 2x2 samples");
+    }
+    const int tileSize = std::clamp(settings.tileSize, 16, 4096);
+    const int overviewSize = std::max(settings.overviewSize, 2);
+    const int tilesX = ceilDiv(columns, tileSize), tilesZ = ceilDiv(rows, tileSize);
+    const int overviewStep = std::max(1, ceilDiv(std::max(columns, rows) - 1, overviewSize - 1));
+
+    TerrainTilesHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.columns = static_cast<std::uint32_t>(columns);
+    header.rows = static_cast<std::uint32_t>(rows);
+    header.tileSize = static_cast<std::uint32_t>(tileSize);
+    header.overviewStep = static_cast<std::uint32_t>(overviewStep);
+    header.overviewColumns = static_cast<std::uint32_t>((columns - 1) / overviewStep + 1);
+    header.overviewRows = static_cast<std::uint32_t>((rows - 1) / overviewStep + 1);
+    header.worldScale = layout.worldScale;
+    header.heightScale = layout.heightScale;
+    header.baseY = layout.baseY;
+    header.originX = layout.origin.x;
+    header.originZ = layout.origin.y;
+
+    std::vector<glm::ivec2> levels;
+    const size_t pyramidNodes = pyramidShape(tilesX, tilesZ, &levels);
+    const size_t overviewSamples = static_cast<size_t>(header.overviewColumns) * header.overviewRows;
+    header.pyramidLevels = static_cast<std::uint32_t>(levels.size());
+    header.pyramidOffset = sizeof(TerrainTilesHeader);
+    header.overviewOffset = header.pyramidOffset + pyramidNodes * 2 * sizeof(std::uint16_t);
+    header.tileOffset = (header.overviewOffset + overviewSamples * sizeof(std::uint16_t) + TILE_ALIGNMENT - 1)
+                        / TILE_ALIGNMENT * TILE_ALIGNMENT;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Failed to create terrain tiles file " + path);
+    }
+
+    // One band of tiles at a time, plus the band's first row of the next one for the bounds
+    const size_t tileSamples = static_cast<size_t>(tileSize) * tileSize;
+    std::vector<std::uint16_t> band(static_cast<size_t>(tileSize + 1) * columns);
+    std::vector<std::uint16_t> tiles(tileSamples * tilesX);
+    std::vector<std::uint16_t> pyramid(pyramidNodes * 2);
+    std::vector<std::uint16_t> overview(overviewSamples);
+    auto bandRow = [&](int r) { return band.data() + static_cast<size_t>(r) * columns; };
+
+    rowSource(0, bandRow(0));
+    file.seekp(static_cast<std::streamoff>(header.tileOffset));
+    for (int tz = 0; tz < tilesZ; tz++) {
+        const int z0 = tz * tileSize;
+        for (int r = 1; r <= tileSize; r++) {
+            const int z = z0 + r;
+            if (z < rows) {
+                rowSource(z, bandRow(r));
+            } else {
+                std::copy_n(bandRow(r - 1), columns, bandRow(r));
+            }
+        }
+
+        for (int r = 0; r < tileSize && z0 + r < rows; r++) {
+            const int z = z0 + r;
+            if (z % overviewStep != 0) continue;
+            std::uint16_t* out = overview.data() + static_cast<size_t>(z / overviewStep) * header.overviewColumns;
+            for (std::uint32_t x = 0; x < header.overviewColumns; x++) out[x] = bandRow(r)[x * overviewStep];
+        }
+
+        for (int tx = 0; tx < tilesX; tx++) {
+            const int x0 = tx * tileSize;
+            std::uint16_t* tile = tiles.data() + tx * tileSamples;
+            for (int r = 0; r < tileSize; r++) {
+                const std::uint16_t* row = bandRow(r);
+                for (int c = 0; c < tileSize; c++) {
+                    tile[static_cast<size_t>(r) * tileSize + c] = row[std::min(x0 + c, columns - 1)];
+                }
+            }
+
+            std::uint16_t low = UINT16_MAX, high = 0;
+            const int endX = std::min(x0 + tileSize, columns - 1), endZ = std::min(tileSize, rows - 1 - z0);
+            for (int r = 0; r <= endZ; r++) {
+                const std::uint16_t* row = bandRow(r);
+                for (int x = x0; x <= endX; x++) {
+                    low = std::min(low, row[x]);
+                    high = std::max(high, row[x]);
+                }
+            }
+            pyramid[2 * (static_cast<size_t>(tz) * tilesX + tx)] = low;
+            pyramid[2 * (static_cast<size_t>(tz) * tilesX + tx) + 1] = high;
+        }
+        file.write(reinterpret_cast<const char*>(tiles.data()), static_cast<std::streamsize>(tiles.size() * sizeof(std::uint16_t)));
+        std::copy_n(bandRow(tileSize), columns, bandRow(0));
+    }
+
+    // Upper pyramid levels from the ones below
+    size_t below = 0, offset = static_cast<size_t>(tilesX) * tilesZ;
+    for (size_t l = 1; l < levels.size(); l++) {
+        const glm::ivec2 size = levels[l], belowSize = levels[l - 1];
+        for (int z = 0; z < size.y; z++) {
+            for (int x = 0; x < size.x; x++) {
+                std::uint16_t low = UINT16_MAX, high = 0;
+                for (int c = 0; c < 4; c++) {
+                    const int cx = 2 * x + (c & 1), cz = 2 * z + (c >> 1);
+                    if (cx >= belowSize.x || cz >= belowSize.y) continue;
+                    const size_t child = below + static_cast<size_t>(cz) * belowSize.x + cx;
+                    low = std::min(low, pyramid[2 * child]);
+                    high = std::max(high, pyramid[2 * child + 1]);
+                }
+                const size_t node = offset + static_cast<size_t>(z) * size.x + x;
+                pyramid[2 * node] = low;
+                pyramid[2 * node + 1] = high;
+            }
+        }
+        below = offset;
+        offset += static_cast<size_t>(size.x) * size.y;
+    }
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(pyramid.data()), static_cast<std::streamsize>(pyramid.size() * sizeof(std::uint16_t)));
+    file.write(reinterpret_cast<const char*>(overview.data()), static_cast<std::streamsize>(overview.size() * sizeof(std::uint16_t)));
+    file.close();
+    if (!file) {
+        throw std::runtime_error("Failed to write terrain tiles file " + path);
+    }
+}
+
+void TerrainTiles::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Failed to open terrain tiles file " + path);
+    }
+    m_file = file;
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    m_size = static_cast<size_t>(size.QuadPart);
+    m_mapping = m_size > 0 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    if (m_mapping) m_data = static_cast<const std::byte*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+    m_file = ::open(path.c_str(), O_RDONLY);
+    if (m_file < 0) {
+        throw std::runtime_error("Failed to open terrain tiles file " + path);
+    }
+    struct stat info {};
+    fstat(m_file, &info);
+    m_size = static_cast<size_t>(info.st_size);
+    if (m_size > 0) {
+        void* mapped = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_file, 0);
+        if (mapped != MAP_FAILED) {
+            // Access follows the camera, not the file order
+            madvise(mapped, m_size, MADV_RANDOM);
+            m_data = static_cast<const std::byte*>(mapped);
+        }
+    }
+#endif
+    if (!m_data) {
+        close();
+        throw std::runtime_error("Failed to map terrain tiles file " + path);
+    }
+
+    auto fail = [&](const char* reason) {
+        close();
+        throw std::runtime_error("Terrain tiles file " + path + ": " + reason);
+    };
+    if (m_size < sizeof(TerrainTilesHeader)) fail("too short for a header");
+    m_header = reinterpret_cast<const TerrainTilesHeader*>(m_data);
+    if (std::memcmp(m_header->magic, MAGIC, sizeof(MAGIC)) != 0) fail("not a terrain tiles file");
+    if (m_header->version != VERSION) fail("unsupported version");
+    if (m_header->columns < 2 || m_header->rows < 2 || m_header->tileSize < 2 || m_header->overviewStep < 1) {
+        fail("invalid dimensions");
+    }
+
+    m_tilesX = ceilDiv(static_cast<int>(m_header->columns), static_cast<int>(m_header->tileSize));
+    m_tilesZ = ceilDiv(static_cast<int>(m_header->rows), static_cast<int>(m_header->tileSize));
+    const size_t pyramidNodes = pyramidShape(m_tilesX, m_tilesZ);
+    const std::uint64_t tileBytes = static_cast<std::uint64_t>(m_tilesX) * m_tilesZ * tileSamples() * sizeof(std::uint16_t);
+    const std::uint64_t overviewBytes =
+        static_cast<std::uint64_t>(m_header->overviewColumns) * m_header->overviewRows * sizeof(std::uint16_t);
+    if (m_header->pyramidOffset + pyramidNodes * 2 * sizeof(std::uint16_t) > m_size ||
+        m_header->overviewOffset + overviewBytes > m_size || m_header->tileOffset + tileBytes > m_size) {
+        fail("truncated");
+    }
+
+    m_pyramid = reinterpret_cast<const std::uint16_t*>(m_data + m_header->pyramidOffset);
+    m_overview = reinterpret_cast<const std::uint16_t*>(m_data + m_header->overviewOffset);
+    m_tiles = reinterpret_cast<const std::uint16_t*>(m_data + m_header->tileOffset);
+    m_layout = {m_header->worldScale, m_header->heightScale, m_header->baseY, glm::vec2(m_header->originX, m_header->originZ)};
+}
+
+void TerrainTiles::close() {
+#ifdef _WIN32
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(m_mapping);
+    if (m_file) CloseHandle(m_file);
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    if (m_data) munmap(const_cast<std::byte*>(m_data), m_size);
+    if (m_file >= 0) ::close(m_file);
+    m_file = -1;
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_header = nullptr;
+    m_pyramid = m_overview = m_tiles = nullptr;
+    m_tilesX = m_tilesZ = 0;
+}
+
+std::uint16_t TerrainTiles::sample(int x, int z) const {
+    x = std::clamp(x, 0, columns() - 1);
+    z = std::clamp(z, 0, rows() - 1);
+    const int size = tileSize();
+    return tile(x / size, z / size)[static_cast<size_t>(z % size) * size + x % size];
+}
+
+const std::uint16_t* TerrainTiles::pyramidLevel(int level, int* width, int* height) const {
+    const std::uint16_t* nodes = m_pyramid;
+    glm::ivec2 size(m_tilesX, m_tilesZ);
+    for (int l = 0; l < level; l++) {
+        nodes += 2 * static_cast<size_t>(size.x) * size.y;
+        size = glm::ivec2((size.x + 1) / 2, (size.y + 1) / 2);
+    }
+    *width = size.x;
+    *height = size.y;
+    return nodes;
+}
+
+glm::vec2 TerrainTiles::bounds(int level, int x, int z) const {
+    int width, height;
+    const std::uint16_t* nodes = pyramidLevel(std::clamp(level, 0, pyramidLevels() - 1), &width, &height);
+    const size_t node = 2 * (static_cast<size_t>(std::clamp(z, 0, height - 1)) * width + std::clamp(x, 0, width - 1));
+    return glm::vec2(m_layout.baseY + nodes[node] * m_layout.heightScale, m_layout.baseY + nodes[node + 1] * m_layout.heightScale);
+}
+
+glm::vec2 TerrainTiles::rangeBounds(int x0, int z0, int x1, int z1) const {
+    const int size = tileSize();
+    const int tx0 = std::clamp(x0 / size, 0, m_tilesX - 1), tx1 = std::clamp(x1 / size, 0, m_tilesX - 1);
+    const int tz0 = std::clamp(z0 / size, 0, m_tilesZ - 1), tz1 = std::clamp(z1 / size, 0, m_tilesZ - 1);
+    glm::vec2 result(1e30f, -1e30f);
+    for (int tz = tz0; tz <= tz1; tz++) {
+        for (int tx = tx0; tx <= tx1; tx++) {
+            const std::uint16_t* node = m_pyramid + 2 * (static_cast<size_t>(tz) * m_tilesX + tx);
+            result = glm::vec2(std::min(result.x, m_layout.baseY + node[0] * m_layout.heightScale),
+                               std::max(result.y, m_layout.baseY + node[1] * m_layout.heightScale));
+        }
+    }
+    return result;
+}
@@ -0,0 +1,112 @@
+// TerrainTiles.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <glm/glm.hpp>
+#include "TerrainQuery.hpp"
+
+// On-disk heightfield for terrains too large to hold in memory: 16-bit samples cut into
+// square tiles that are memory-mapped and paged in only where they're used.
+//
+// File layout, all little endian:
+//   TerrainTilesHeader
+//   min/max pyramid: level 0 has one (min, max) sample pair per tile, covering its samples
+//                    and the row and column shared with the next tiles; each level above
+//                    merges 2x2 nodes, up to a single node
+//   overview:        every overviewStep-th sample in both directions, small enough to keep
+//                    in memory and on the GPU for the whole terrain
+//   tiles:           tileSize^2 samples each, row major, tiles in row major order, starting
+//                    at a 64 KB boundary; tiles past the heightfield's edge repeat its last
+//                    row and column
+struct TerrainTilesHeader {
+    char magic[4];                     // "PG2T"
+    std::uint32_t version;
+    std::uint32_t columns, rows;       // samples
+    std::uint32_t tileSize;            // samples per tile side
+    std::uint32_t overviewStep;
+    std::uint32_t overviewColumns, overviewRows;
+    float worldScale, heightScale, baseY; // TerrainLayout, heightScale per 16-bit step
+    float originX, originZ;
+    std::uint32_t pyramidLevels;
+    std::uint64_t pyramidOffset, overviewOffset, tileOffset; // bytes from the start of the file
+};
+static_assert(sizeof(TerrainTilesHeader) == 80, "TerrainTilesHeader is written to disk as is");
+
+struct TerrainTilesWriteSettings {
+    int tileSize = 256;
+    int overviewSize = 2048; // overview samples per side at most
+};
+
+// Writes a columns x rows heightfield to path, pulling one row at a time from rowSource
+// (z, out), which fills columns samples. Only one row of tiles is held in memory, so the
+// source can be far larger than RAM. Throws std::runtime_error if the file can't be written.
+void writeTerrainTiles(const std::string& path, int columns, int rows, const TerrainLayout& layout,
+                       const TerrainTilesWriteSettings& settings,
+                       const std::function<void(int, std::uint16_t*)>& rowSource);
+
+// Read-only memory mapping of a tiles file. Nothing is read up front: the OS pages samples
+// in on first access and may drop them again under memory pressure.
+class TerrainTiles {
+public:
+    TerrainTiles() = default;
+    ~TerrainTiles() { close(); }
+
+    TerrainTiles(const TerrainTiles&) = delete;
+    TerrainTiles& operator=(const TerrainTiles&) = delete;
+
+    // Throws std::runtime_error if the file is missing, truncated or not a tiles file
+    void open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    const TerrainTilesHeader& header() const { return *m_header; }
+    int columns() const { return static_cast<int>(m_header->columns); }
+    int rows() const { return static_cast<int>(m_header->rows); }
+    int tileSize() const { return static_cast<int>(m_header->tileSize); }
+    int tilesX() const { return m_tilesX; }
+    int tilesZ() const { return m_tilesZ; }
+    const TerrainLayout& layout() const { return m_layout; }
+
+    // tileSize() x tileSize() samples straight from the mapping
+    const std::uint16_t* tile(int tileX, int tileZ) const {
+        return m_tiles + (static_cast<size_t>(tileZ) * m_tilesX + tileX) * tileSamples();
+    }
+    size_t tileSamples() const { return static_cast<size_t>(m_header->tileSize) * m_header->tileSize; }
+    // Sample (x, z), clamped to the heightfield
+    std::uint16_t sample(int x, int z) const;
+
+    // World heights (min, max) of a pyramid node; level 0 is one node per tile
+    glm::vec2 bounds(int level, int x, int z) const;
+    int pyramidLevels() const { return static_cast<int>(m_header->pyramidLevels); }
+    // Bounds over every tile a rectangle of samples [x0, x1] x [z0, z1] touches
+    glm::vec2 rangeBounds(int x0, int z0, int x1, int z1) const;
+
+    const std::uint16_t* overview() const { return m_overview; }
+    int overviewStep() const { return static_cast<int>(m_header->overviewStep); }
+    int overviewColumns() const { return static_cast<int>(m_header->overviewColumns); }
+    int overviewRows() const { return static_cast<int>(m_header->overviewRows); }
+
+    size_t fileBytes() const { return m_size; }
+
+private:
+    const std::uint16_t* pyramidLevel(int level, int* width, int* height) const;
+
+    const std::byte* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#else
+    int m_file = -1;
+#endif
+    const TerrainTilesHeader* m_header = nullptr;
+    const std::uint16_t* m_pyramid = nullptr;
+    const std::uint16_t* m_overview = nullptr;
+    const std::uint16_t* m_tiles = nullptr;
+    int m_tilesX = 0;
+    int m_tilesZ = 0;
+    TerrainLayout m_layout;
+};
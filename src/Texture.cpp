@@ -1,9 +1,11 @@
 #include "Texture.hpp"
+#include "Trace.hpp"
 #include <opencv2/opencv.hpp>
 #include <opencv2/videoio.hpp> // For VideoCapture
 #include <iostream>
 
 std::shared_ptr<Texture> Texture::create(const std::string& path) {
+    TRACE_SCOPE_DETAIL("Texture::create", path);
     auto texture = std::shared_ptr<Texture>(new Texture());
 
     try {
@@ -0,0 +1,79 @@
+// ThreadPool.cpp
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int threads) {
+    if (threads <= 0) threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (int i = 1; i < threads; i++) {
+        m_threads.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::run(size_t tasks, const std::function<void(size_t)>& task) {
+    if (tasks == 0) return;
+    if (m_threads.empty() || tasks == 1) {
+        for (size_t i = 0; i < tasks; i++) task(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_taskCount = tasks;
+        m_next = 0;
+        m_active = static_cast<int>(m_threads.size());
+        m_generation++;
+    }
+    m_wake.notify_all();
+
+    for (size_t i = m_next++; i < tasks; i = m_next++) {
+        task(i);
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_finished.wait(lock, [this] { return m_active == 0; });
+    m_task = nullptr;
+}
+
+void ThreadPool::parallelFor(size_t count, size_t minRange, const std::function<void(size_t, size_t)>& fn) {
+    const size_t ranges = std::clamp<size_t>(count / std::max<size_t>(minRange, 1), 1, static_cast<size_t>(size()));
+    run(ranges, [&](size_t range) {
+        fn(count * range / ranges, count * (range + 1) / ranges);
+    });
+}
+
+void ThreadPool::work() {
+    TRACE_THREAD_NAME("Thread pool");
+    std::uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+        if (m_stop) return;
+        seen = m_generation;
+        const std::function<void(size_t)>* task = m_task;
+        const size_t count = m_taskCount;
+        lock.unlock();
+
+        {
+            TRACE_SCOPE("Pool tasks");
+            for (size_t i = m_next++; i < count; i = m_next++) {
+                (*task)(i);
+            }
+        }
+
+        lock.lock();
+        if (--m_active == 0) m_finished.notify_all();
+    }
+}
@@ -0,0 +1,46 @@
+// ThreadPool.hpp
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent worker threads for splitting per-frame work over the cores without starting
+// threads every frame. run() hands out tasks and blocks until all are done; the calling
+// thread works on them too. One run() at a time.
+class ThreadPool {
+public:
+    // threads counts the caller, 0 = one per hardware thread
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Threads working on a run(), the caller included
+    int size() const { return static_cast<int>(m_threads.size()) + 1; }
+
+    // Calls task(i) for every i in [0, tasks), spread over the threads
+    void run(size_t tasks, const std::function<void(size_t)>& task);
+    // Splits [0, count) into one range per thread, none shorter than minRange: fn(begin, end)
+    void parallelFor(size_t count, size_t minRange, const std::function<void(size_t, size_t)>& fn);
+
+private:
+    void work();
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_finished;
+    const std::function<void(size_t)>* m_task = nullptr;
+    size_t m_taskCount = 0;
+    std::atomic<size_t> m_next{0};
+    int m_active = 0;
+    std::uint64_t m_generation = 0;
+    bool m_stop = false;
+    std::vector<std::thread> m_threads;
+};
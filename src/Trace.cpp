@@ -0,0 +1,198 @@
+// Trace.cpp
+#include "Trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+    struct Event {
+        std::uint64_t timestamp; // ns since the first event of the process
+        const char* name;
+        double value;
+        char phase;
+        char detail[Trace::DETAIL_SIZE - 1]; // zero terminated unless full
+    };
+    static_assert(sizeof(Event) == 64, "events should stay one cache line");
+
+    constexpr size_t BLOCK_EVENTS = 4096;
+
+    struct Block {
+        Event events[BLOCK_EVENTS];
+        std::atomic<Block*> next{nullptr};
+    };
+
+    // One thread's events. Only the owner writes; count is what readers may look at.
+    struct ThreadBuffer {
+        std::uint32_t id = 0;
+        std::atomic<const char*> name{nullptr};
+        Block first;
+        Block* last = &first;
+        std::atomic<size_t> count{0};
+        std::atomic<size_t> dropped{0};
+
+        ~ThreadBuffer() {
+            Block* block = first.next.load();
+            while (block) {
+                Block* next = block->next.load();
+                delete block;
+                block = next;
+            }
+        }
+    };
+
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>>& registry() {
+        static std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        return buffers;
+    }
+
+    // Created on the thread's first event, so threads that never record cost nothing
+    thread_local ThreadBuffer* threadBufferPtr = nullptr;
+    thread_local const char* threadName = nullptr;
+
+    ThreadBuffer& threadBuffer() {
+        if (!threadBufferPtr) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            auto& buffers = registry();
+            buffers.push_back(std::make_unique<ThreadBuffer>());
+            threadBufferPtr = buffers.back().get();
+            threadBufferPtr->id = static_cast<std::uint32_t>(buffers.size());
+            threadBufferPtr->name.store(threadName, std::memory_order_release);
+        }
+        return *threadBufferPtr;
+    }
+
+    void writeEscaped(std::ostream& out, const char* text, size_t length) {
+        length = std::find(text, text + length, '\0') - text;
+        const bool plain = std::none_of(text, text + length, [](char c) {
+            return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+        });
+        if (plain) {
+            out.write(text, static_cast<std::streamsize>(length));
+            return;
+        }
+        for (size_t i = 0; i < length; i++) {
+            const char c = text[i];
+            if (c == '"' || c == '\\') {
+                out << '\\' << c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out << escaped;
+            } else {
+                out << c;
+            }
+        }
+    }
+}
+
+void Trace::record(char phase, const char* name, std::string_view detail, double value) {
+    ThreadBuffer& buffer = threadBuffer();
+    const size_t index = buffer.count.load(std::memory_order_relaxed);
+    if (index >= MAX_EVENTS_PER_THREAD) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (index > 0 && index % BLOCK_EVENTS == 0) {
+        Block* block = new Block; // events are written before they are counted, no need to clear them
+        buffer.last->next.store(block, std::memory_order_release);
+        buffer.last = block;
+    }
+
+    Event& event = buffer.last->events[index % BLOCK_EVENTS];
+    event.timestamp = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+    event.name = name;
+    event.value = value;
+    event.phase = phase;
+    // The end of a path says more than its start
+    const size_t length = std::min(detail.size(), sizeof(event.detail));
+    std::copy_n(detail.data() + detail.size() - length, length, event.detail);
+    if (length < sizeof(event.detail)) event.detail[length] = '\0';
+
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+void Trace::setThreadName(const char* name) {
+    threadName = name;
+    if (threadBufferPtr) threadBufferPtr->name.store(name, std::memory_order_release);
+}
+
+size_t Trace::eventCount() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    size_t count = 0;
+    for (const auto& buffer : registry()) count += buffer->count.load(std::memory_order_acquire);
+    return count;
+}
+
+size_t Trace::droppedCount() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    size_t count = 0;
+    for (const auto& buffer : registry()) count += buffer->dropped.load(std::memory_order_relaxed);
+    return count;
+}
+
+bool Trace::write(const std::string& path) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Warning: failed to write trace " << path << "\n";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    size_t written = 0;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&] {
+        if (!first) out << ",\n";
+        first = false;
+    };
+    char number[64];
+    for (const auto& buffer : registry()) {
+        if (const char* name = buffer->name.load(std::memory_order_acquire)) {
+            separator();
+            out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->id << ",\"args\":{\"name\":\"";
+            writeEscaped(out, name, std::string_view(name).size());
+            out << "\"}}";
+        }
+
+        // Events past count may be half written, everything before it is complete
+        const size_t count = buffer->count.load(std::memory_order_acquire);
+        const Block* block = &buffer->first;
+        for (size_t i = 0; i < count; i++) {
+            if (i > 0 && i % BLOCK_EVENTS == 0) block = block->next.load(std::memory_order_acquire);
+            const Event& event = block->events[i % BLOCK_EVENTS];
+            separator();
+            out << "{\"ph\":\"" << event.phase << "\",\"name\":\"";
+            writeEscaped(out, event.name, std::string_view(event.name).size());
+            const int length = std::snprintf(number, sizeof(number), "\",\"cat\":\"pg2\",\"pid\":1,\"tid\":%u,\"ts\":%.3f",
+                                             buffer->id, event.timestamp / 1000.0);
+            out.write(number, length);
+            if (event.phase == 'C') {
+                std::snprintf(number, sizeof(number), "%.17g", event.value);
+                out << ",\"args\":{\"value\":" << number << "}";
+            } else if (event.phase == 'B' && event.detail[0]) {
+                out << ",\"args\":{\"detail\":\"";
+                writeEscaped(out, event.detail, sizeof(event.detail));
+                out << "\"}";
+            }
+            out << "}";
+        }
+        written += count;
+    }
+    out << "\n]}\n";
+
+    if (!out) {
+        std::cerr << "Warning: failed to write trace " << path << "\n";
+        return false;
+    }
+    std::cout << "Trace: " << written << " events written to " << path << "\n";
+    return true;
+}
@@ -0,0 +1,80 @@
+// Trace.hpp
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Event tracing for offline analysis: begin/end and counter events recorded from any
+// thread and written as Chrome trace JSON, for chrome://tracing or ui.perfetto.dev.
+//
+// Every thread records into its own buffer, a chain of fixed-size blocks only that thread
+// writes; the event count is published with a release store, so recording takes no lock
+// and export() can read a consistent prefix while threads keep recording. A thread's
+// buffer is registered (under a mutex) on its first event and outlives the thread.
+//
+// Recording is off until setEnabled(true). Off, a TRACE_SCOPE costs one relaxed atomic
+// load; built without PG2_TRACING the macros compile to nothing. Names must outlive the
+// export (string literals); details are copied, truncated to their last DETAIL_SIZE - 1
+// characters.
+class Trace {
+public:
+    static constexpr size_t DETAIL_SIZE = 40;
+    static constexpr size_t MAX_EVENTS_PER_THREAD = size_t(1) << 20; // 64 MB, then events are dropped
+
+    static void setEnabled(bool enabled) { s_enabled.store(enabled, std::memory_order_relaxed); }
+    static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    static void begin(const char* name, std::string_view detail = {}) {
+        if (enabled()) record('B', name, detail, 0.0);
+    }
+    static void end(const char* name) {
+        if (enabled()) record('E', name, {}, 0.0);
+    }
+    static void counter(const char* name, double value) {
+        if (enabled()) record('C', name, {}, value);
+    }
+    // Shown as the thread's track name; call from the thread, once
+    static void setThreadName(const char* name);
+
+    // Writes every event recorded so far. False (with a warning) if the file can't be written.
+    static bool write(const std::string& path);
+    static size_t eventCount();
+    static size_t droppedCount();
+
+    // Ends the event it began, even if tracing was switched off in between
+    class Scope {
+    public:
+        explicit Scope(const char* name, std::string_view detail = {}) : m_name(enabled() ? name : nullptr) {
+            if (m_name) record('B', name, detail, 0.0);
+        }
+        ~Scope() {
+            if (m_name) record('E', m_name, {}, 0.0);
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* m_name;
+    };
+
+private:
+    static void record(char phase, const char* name, std::string_view detail, double value);
+
+    static inline std::atomic<bool> s_enabled{false};
+};
+
+#ifdef PG2_TRACING
+#define PG2_TRACE_CONCAT_(a, b) a##b
+#define PG2_TRACE_CONCAT(a, b) PG2_TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) Trace::Scope PG2_TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_SCOPE_DETAIL(name, detail) Trace::Scope PG2_TRACE_CONCAT(traceScope, __LINE__)(name, detail)
+#define TRACE_COUNTER(name, value) Trace::counter(name, static_cast<double>(value))
+#define TRACE_THREAD_NAME(name) Trace::setThreadName(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_SCOPE_DETAIL(name, detail) ((void)0)
+#define TRACE_COUNTER(name, value) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif
@@ -0,0 +1,184 @@
+// TransformStore.cpp
+#include "TransformStore.hpp"
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRANSFORM_STORE_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+    constexpr float DEG_TO_RAD = 0.017453292519943295f;
+
+    // Rotation R = Rx * Ry * Rz (the order Model used with glm::rotate), written as
+    // the nine column-major entries for one transform
+    struct Rotation {
+        float c0x, c0y, c0z;
+        float c1x, c1y, c1z;
+        float c2x, c2y, c2z;
+    };
+
+    Rotation eulerRotation(float degX, float degY, float degZ) {
+        float sx = std::sin(degX * DEG_TO_RAD), cx = std::cos(degX * DEG_TO_RAD);
+        float sy = std::sin(degY * DEG_TO_RAD), cy = std::cos(degY * DEG_TO_RAD);
+        float sz = std::sin(degZ * DEG_TO_RAD), cz = std::cos(degZ * DEG_TO_RAD);
+        return {
+            cy * cz,  sx * sy * cz + cx * sz, -cx * sy * cz + sx * sz,
+            -cy * sz, -sx * sy * sz + cx * cz, cx * sy * sz + sx * cz,
+            sy,       -sx * cy,                cx * cy
+        };
+    }
+
+    // world = T * R * S, normal = (R * S)^-T = R * S^-1 because R is orthonormal
+    void composeScalar(const Rotation& r, float px, float py, float pz, float sx, float sy, float sz,
+                       glm::mat4& world, glm::mat4& normal) {
+        world[0] = glm::vec4(r.c0x * sx, r.c0y * sx, r.c0z * sx, 0.0f);
+        world[1] = glm::vec4(r.c1x * sy, r.c1y * sy, r.c1z * sy, 0.0f);
+        world[2] = glm::vec4(r.c2x * sz, r.c2y * sz, r.c2z * sz, 0.0f);
+        world[3] = glm::vec4(px, py, pz, 1.0f);
+
+        float ix = 1.0f / sx, iy = 1.0f / sy, iz = 1.0f / sz;
+        normal[0] = glm::vec4(r.c0x * ix, r.c0y * ix, r.c0z * ix, 0.0f);
+        normal[1] = glm::vec4(r.c1x * iy, r.c1y * iy, r.c1z * iy, 0.0f);
+        normal[2] = glm::vec4(r.c2x * iz, r.c2y * iz, r.c2z * iz, 0.0f);
+        normal[3] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+
+#ifdef TRANSFORM_STORE_SSE
+    // Four transforms at once: every lane of a register belongs to a different transform.
+    // Rotation entries and scales arrive in lanes, results are transposed back into mat4s.
+    void composeSSE(const Rotation* r, const float* px, const float* py, const float* pz,
+                    const float* sx, const float* sy, const float* sz,
+                    glm::mat4* world[4], glm::mat4* normal[4]) {
+        auto lanes = [&](float Rotation::*member) {
+            return _mm_setr_ps(r[0].*member, r[1].*member, r[2].*member, r[3].*member);
+        };
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 zero = _mm_setzero_ps();
+
+        __m128 scale[3] = {_mm_loadu_ps(sx), _mm_loadu_ps(sy), _mm_loadu_ps(sz)};
+        __m128 inv[3] = {_mm_div_ps(one, scale[0]), _mm_div_ps(one, scale[1]), _mm_div_ps(one, scale[2])};
+        __m128 cols[3][3] = {
+            {lanes(&Rotation::c0x), lanes(&Rotation::c0y), lanes(&Rotation::c0z)},
+            {lanes(&Rotation::c1x), lanes(&Rotation::c1y), lanes(&Rotation::c1z)},
+            {lanes(&Rotation::c2x), lanes(&Rotation::c2y), lanes(&Rotation::c2z)},
+        };
+
+        for (int c = 0; c < 3; c++) {
+            // World column c for the four transforms, one component per register
+            __m128 wx = _mm_mul_ps(cols[c][0], scale[c]);
+            __m128 wy = _mm_mul_ps(cols[c][1], scale[c]);
+            __m128 wz = _mm_mul_ps(cols[c][2], scale[c]);
+            __m128 ww = zero;
+            _MM_TRANSPOSE4_PS(wx, wy, wz, ww);
+            _mm_storeu_ps(&(*world[0])[c].x, wx);
+            _mm_storeu_ps(&(*world[1])[c].x, wy);
+            _mm_storeu_ps(&(*world[2])[c].x, wz);
+            _mm_storeu_ps(&(*world[3])[c].x, ww);
+
+            __m128 nx = _mm_mul_ps(cols[c][0], inv[c]);
+            __m128 ny = _mm_mul_ps(cols[c][1], inv[c]);
+            __m128 nz = _mm_mul_ps(cols[c][2], inv[c]);
+            __m128 nw = zero;
+            _MM_TRANSPOSE4_PS(nx, ny, nz, nw);
+            _mm_storeu_ps(&(*normal[0])[c].x, nx);
+            _mm_storeu_ps(&(*normal[1])[c].x, ny);
+            _mm_storeu_ps(&(*normal[2])[c].x, nz);
+            _mm_storeu_ps(&(*normal[3])[c].x, nw);
+        }
+
+        for (int i = 0; i < 4; i++) {
+            (*world[i])[3] = glm::vec4(px[i], py[i], pz[i], 1.0f);
+            (*normal[i])[3] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        }
+    }
+#endif
+}
+
+TransformStore::Id TransformStore::create(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale) {
+    Id id;
+    if (!m_free.empty()) {
+        id = m_free.back();
+        m_free.pop_back();
+    } else {
+        id = static_cast<Id>(m_world.size());
+        for (auto* column : {&m_posX, &m_posY, &m_posZ, &m_rotX, &m_rotY, &m_rotZ, &m_scaleX, &m_scaleY, &m_scaleZ}) {
+            column->push_back(0.0f);
+        }
+        m_world.emplace_back(1.0f);
+        m_normal.emplace_back(1.0f);
+        m_dirty.push_back(0);
+    }
+
+    m_posX[id] = position.x; m_posY[id] = position.y; m_posZ[id] = position.z;
+    m_rotX[id] = rotation.x; m_rotY[id] = rotation.y; m_rotZ[id] = rotation.z;
+    m_scaleX[id] = scale.x; m_scaleY[id] = scale.y; m_scaleZ[id] = scale.z;
+    markDirty(id);
+    return id;
+}
+
+void TransformStore::release(Id id) {
+    if (id == INVALID || id >= m_world.size()) return;
+    // A pending update for a dead slot is harmless, updateMatrices() just recomputes it
+    m_free.push_back(id);
+}
+
+void TransformStore::setPosition(Id id, const glm::vec3& position) {
+    m_posX[id] = position.x; m_posY[id] = position.y; m_posZ[id] = position.z;
+    markDirty(id);
+}
+
+void TransformStore::setRotation(Id id, const glm::vec3& rotation) {
+    m_rotX[id] = rotation.x; m_rotY[id] = rotation.y; m_rotZ[id] = rotation.z;
+    markDirty(id);
+}
+
+void TransformStore::setScale(Id id, const glm::vec3& scale) {
+    m_scaleX[id] = scale.x; m_scaleY[id] = scale.y; m_scaleZ[id] = scale.z;
+    markDirty(id);
+}
+
+void TransformStore::markDirty(Id id) {
+    if (!m_dirty[id]) {
+        m_dirty[id] = 1;
+        m_dirtyList.push_back(id);
+    }
+}
+
+void TransformStore::updateMatrices() {
+    const size_t count = m_dirtyList.size();
+    m_lastUpdateCount = count;
+    if (count == 0) return;
+
+    size_t i = 0;
+#ifdef TRANSFORM_STORE_SSE
+    for (; i + 4 <= count; i += 4) {
+        Rotation rot[4];
+        float px[4], py[4], pz[4], sx[4], sy[4], sz[4];
+        glm::mat4* world[4];
+        glm::mat4* normal[4];
+        for (int lane = 0; lane < 4; lane++) {
+            Id id = m_dirtyList[i + lane];
+            rot[lane] = eulerRotation(m_rotX[id], m_rotY[id], m_rotZ[id]);
+            px[lane] = m_posX[id]; py[lane] = m_posY[id]; pz[lane] = m_posZ[id];
+            sx[lane] = m_scaleX[id]; sy[lane] = m_scaleY[id]; sz[lane] = m_scaleZ[id];
+            world[lane] = &m_world[id];
+            normal[lane] = &m_normal[id];
+        }
+        composeSSE(rot, px, py, pz, sx, sy, sz, world, normal);
+    }
+#endif
+    // Remainder (or everything without SSE)
+    for (; i < count; i++) {
+        Id id = m_dirtyList[i];
+        composeScalar(eulerRotation(m_rotX[id], m_rotY[id], m_rotZ[id]),
+                      m_posX[id], m_posY[id], m_posZ[id],
+                      m_scaleX[id], m_scaleY[id], m_scaleZ[id],
+                      m_world[id], m_normal[id]);
+    }
+
+    for (Id id : m_dirtyList) {
+        m_dirty[id] = 0;
+    }
+    m_dirtyList.clear();
+}
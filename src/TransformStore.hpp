@@ -0,0 +1,61 @@
+// TransformStore.hpp
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Structure-of-arrays storage for object transforms (position, Euler rotation in
+// degrees, scale) with cached world and normal matrices.
+// Setters only mark an entry dirty; updateMatrices() recomputes the dirty entries
+// in batches of four with an SSE kernel, so static objects cost nothing per frame.
+// The matrices live in contiguous arrays indexed by id, ready for instancing or SSBO upload.
+class TransformStore {
+public:
+    using Id = std::uint32_t;
+    static constexpr Id INVALID = UINT32_MAX;
+
+    Id create(const glm::vec3& position = glm::vec3(0.0f),
+              const glm::vec3& rotation = glm::vec3(0.0f),
+              const glm::vec3& scale = glm::vec3(1.0f));
+    void release(Id id);
+
+    void setPosition(Id id, const glm::vec3& position);
+    void setRotation(Id id, const glm::vec3& rotation);
+    void setScale(Id id, const glm::vec3& scale);
+
+    glm::vec3 position(Id id) const { return {m_posX[id], m_posY[id], m_posZ[id]}; }
+    glm::vec3 rotation(Id id) const { return {m_rotX[id], m_rotY[id], m_rotZ[id]}; }
+    glm::vec3 scale(Id id) const { return {m_scaleX[id], m_scaleY[id], m_scaleZ[id]}; }
+
+    // Recompute world/normal matrices of every entry changed since the last call
+    void updateMatrices();
+
+    const glm::mat4& world(Id id) const { return m_world[id]; }
+    // Inverse transpose of the world matrix's upper 3x3, stored as a mat4 for std430 upload
+    const glm::mat4& normal(Id id) const { return m_normal[id]; }
+
+    // Contiguous matrix arrays, indexed by id (released slots hold stale data)
+    const glm::mat4* worldMatrices() const { return m_world.data(); }
+    const glm::mat4* normalMatrices() const { return m_normal.data(); }
+    size_t capacity() const { return m_world.size(); }
+    size_t size() const { return m_world.size() - m_free.size(); }
+
+    size_t lastUpdateCount() const { return m_lastUpdateCount; }
+
+private:
+    void markDirty(Id id);
+
+    // SoA transform components
+    std::vector<float> m_posX, m_posY, m_posZ;
+    std::vector<float> m_rotX, m_rotY, m_rotZ;
+    std::vector<float> m_scaleX, m_scaleY, m_scaleZ;
+
+    std::vector<glm::mat4> m_world;
+    std::vector<glm::mat4> m_normal;
+
+    std::vector<std::uint8_t> m_dirty;
+    std::vector<Id> m_dirtyList;
+    std::vector<Id> m_free;
+    size_t m_lastUpdateCount = 0;
+};
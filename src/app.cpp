@@ -10,7 +10,45 @@
 #include <opencv2/opencv.hpp>
 #include <chrono>
 #include <filesystem>
-#include <stack>
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include "Frustum.hpp"
+
+namespace {
+    const char* terrainModeName(int mode) {
+        static const char* names[] = {"mesh", "cdlod", "tessellation"};
+        return names[mode];
+    }
+
+    cv::Mat loadHeightMapImage() {
+        cv::Mat heightMap = cv::imread("resources/textures/heightmap_3_inverted.png", cv::IMREAD_GRAYSCALE);
+        if (heightMap.empty()) {
+            throw std::runtime_error("Failed to load heightmap texture");
+        }
+        return heightMap;
+    }
+
+    // Time slice for work spread over frames. The clock is only read every 64 items;
+    // a budget of 0 or less never runs out.
+    class WorkBudget {
+    public:
+        explicit WorkBudget(double milliseconds)
+            : m_unlimited(milliseconds <= 0.0),
+              m_deadline(std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                                 std::chrono::duration<double, std::milli>(std::max(milliseconds, 0.0)))) {}
+
+        bool more() { return m_unlimited || (m_items++ & 63) != 0 || std::chrono::steady_clock::now() < m_deadline; }
+
+    private:
+        bool m_unlimited;
+        std::chrono::steady_clock::time_point m_deadline;
+        size_t m_items = 0;
+    };
+}
 
 App::App() : lastX(0.0f), lastY(0.0f), firstMouse(true), deltaTime(0.0f),
              window(nullptr), vsyncOn(true), VAO_ID(0),
@@ -20,19 +58,39 @@ App::App() : lastX(0.0f), lastY(0.0f), firstMouse(true), deltaTime(0.0f),
 }
 
 App::~App() {
+    // Whatever was traced, App::run included, goes to the trace file
+    if (Trace::eventCount() > 0) Trace::write(traceOutput);
+
     // Cleanup in reverse order of creation
     shutdownImGUI();
 
-    // Clear maze resources
-    mazeWalls.clear();
-
-    // Clear shader
-    main_shader.reset();
+    // Clear scene, then the assets it references
+    scene.clear();
+    modelAssets.clear();
+
+    // Clear shader and materials
+    main_shaders.reset();
+    materials.reset();
+    frameStream.reset();
+    crowdStream.reset();
+    profiler.reset();
+    for (std::array<GLuint, 2>& timer : crowdTimers) {
+        if (timer[0]) glDeleteQueries(static_cast<GLsizei>(timer.size()), timer.data());
+    }
+    for (FrameQueries& queries : frameQueries) {
+        if (queries.begin) glDeleteQueries(3, &queries.begin);
+    }
 
     // GL resources
     if (VAO_ID) glDeleteVertexArrays(1, &VAO_ID);
     if (VBO_ID) glDeleteBuffers(1, &VBO_ID);
     if (debugTexture) glDeleteTextures(1, &debugTexture);
+    if (heightMapTexture) glDeleteTextures(1, &heightMapTexture);
+    if (terrainWindowTexture) glDeleteTextures(1, &terrainWindowTexture);
+    offscreen.reset();
+    terrainMesh.reset();
+    terrainTileCache.reset();
+    terrainTiles.reset();
 
     if (window) {
         glfwDestroyWindow(window);
@@ -42,6 +100,7 @@ App::~App() {
 }
 
 void App::init_assets() {
+    TRACE_SCOPE("App::init_assets");
     try {
         // Shader loading with validation
         auto vertPath = "resources/basic.vert";
@@ -53,61 +112,88 @@ void App::init_assets() {
             throw std::runtime_error("Fragment shader not found: " + std::string(fragPath));
         }
 
-        main_shader = ShaderProgram::create(vertPath, fragPath);
-        if (!main_shader) {
-            throw std::runtime_error("Shader program creation failed");
+        // Permutations of basic.vert/basic.frag, one per point light count
+        main_shaders = std::make_shared<ShaderVariants>(vertPath, fragPath);
+        // CDLOD terrain: own vertex stage, same shading
+        terrain_shaders = std::make_shared<ShaderVariants>("resources/terrain.vert", fragPath);
+        terrain_tess_shaders = std::make_shared<ShaderVariants>("resources/terrain_tess.vert", fragPath,
+                                                                "resources/terrain.tesc", "resources/terrain.tese");
+
+        // Every material lives in one GPU table; textures are packed into arrays on upload()
+        materials = std::make_unique<MaterialTable>();
+
+        Model* sunModel = addModelAsset("resources/objects/sphere.obj");
+        MaterialTable::Id sunMaterial = materials->add({.baseColor = glm::vec3(1.0f, 0.5f, 0.2f)}); // Orange color
+        sunEntity = spawn(sunModel, sunMaterial, glm::vec3(10.0f, 10.0f, 10.0f), glm::vec3(5.0f), Background{});
+
+        // Crowd agents are instances of the same sphere, tinted per group by the instance color
+        crowdModel = sunModel;
+        crowdMaterial = materials->add({.baseColor = glm::vec3(1.0f)});
+        crowd = std::make_unique<Crowd>(crowdSettings.threads);
+        for (std::array<GLuint, 2>& timer : crowdTimers) {
+            glCreateQueries(GL_TIMESTAMP, static_cast<GLsizei>(timer.size()), timer.data());
         }
 
-        sphereObject = std::make_unique<Model>("resources/objects/sphere.obj", main_shader);
-        sphereObject->position = glm::vec3(10.0f, 10.0f, 10.0f);
-        sphereObject->setColor(glm::vec3(1.0f, 0.5f, 0.2f)); // Orange color
-        sphereObject->scale = glm::vec3(1.0f);
+        // Walls, glass, water and lava all share one cube mesh and differ only by material
+        cubeModel = addModelAsset("resources/objects/cube.obj");
+        MaterialTexture boxTexture = materials->loadTexture("resources/textures/box.jpg");
+        if (boxTexture.array < 0) {
+            throw std::runtime_error("Failed to load wall texture");
+        }
+        wallMaterial = materials->add({.texture = boxTexture});
 
-        // Maze generation
-        generateMaze(main_shader);
+        // Maze generation, one fixed maze or chunks streamed around the player
+        if (infiniteMaze) {
+            startMazeStreaming();
+        } else {
+            generateMaze();
+        }
         initHeightMap();
 
-        // Create transparent objects
-        auto createTransparentObject = [this](const std::string& texturePath, float alpha, glm::vec3 pos) {
-            auto obj = std::make_unique<Model>("resources/objects/cube.obj", main_shader);
-            if (obj->setTexture(texturePath)) {
-                obj->setTransparency(alpha);
-                obj->position = pos;
-                transparentObjects.push_back(std::move(obj));
-                return true;
-            }
-            return false;
-        };
+        // Glass cubes, the top one spins
+        MaterialTexture glassTexture = materials->loadTexture("resources/textures/glass.png");
+        if (glassTexture.array >= 0) {
+            MaterialTable::Id glass = materials->add({.alpha = 1.0f, .texture = glassTexture});
+            auto spawnGlass = [&](const glm::vec3& position, auto... extra) {
+                spawn(cubeModel, glass, position, glm::vec3(1.0f), makeCollider(position, glm::vec3(1.0f)), extra...);
+            };
+            spawnGlass(glm::vec3(9.501f, 0.501f, 4.5f));
+            spawnGlass(glm::vec3(9.501f, 1.501f, 4.5f));
+            spawnGlass(glm::vec3(9.501f, 4.0f, 4.5f), Spin{cubeRotationSpeed}, Interpolated::at(glm::vec3(9.501f, 4.0f, 4.5f)));
+        }
 
-        // Create animated objects
+        // Animated objects, water and lava don't block movement
         auto createAnimatedObject = [this](const std::string& gifPath, float alpha, glm::vec3 pos) {
-            auto obj = std::make_unique<Model>("resources/objects/cube.obj", main_shader);
-            if (obj->setAnimatedTexture(gifPath)) {
-                obj->setTransparency(alpha);
-                obj->position = pos;
-                transparentObjects.push_back(std::move(obj));
-                return true;
+            MaterialTexture animation = materials->loadAnimation(gifPath);
+            if (animation.array >= 0) {
+                spawn(cubeModel, materials->add({.alpha = alpha, .texture = animation}), pos, glm::vec3(1.0f));
             }
-            return false;
         };
-
-        // Transparent objects
-        createTransparentObject("resources/textures/glass.png", 1.0f, glm::vec3(9.501f, 0.501f, 4.5f));
-        createTransparentObject("resources/textures/glass.png", 1.0f, glm::vec3(9.501f, 1.501f, 4.5f));
-        bool spinningCube = createTransparentObject("resources/textures/glass.png", 1.0f, glm::vec3(9.501f, 4.0f, 4.5f));
-        spinningGlassCube = transparentObjects.back().get();
-
-        // Animated objects
         createAnimatedObject("resources/textures/water.gif", 0.75f, glm::vec3(9.501f, 0.501f, 2.5f));
         createAnimatedObject("resources/textures/lava.gif", 1.0f, glm::vec3(9.501f, 0.501f, 6.5f));
 
+        materials->upload();
+
+        // Materials are data, so the variants left are the light tiers, alpha tested or not.
+        // Build every one the scene can use in one parallel batch so nothing compiles mid-frame.
+        bool alphaTested = false;
+        for (MaterialTable::Id id = 0; id < materials->size(); id++) {
+            alphaTested = alphaTested || materials->isAlphaTested(id);
+        }
+        std::vector<std::uint32_t> variantKeys;
+        for (int lights = 0; lights <= MAX_POINT_LIGHTS; lights++) {
+            variantKeys.push_back(ShaderVariants::key(lights));
+            if (alphaTested) variantKeys.push_back(ShaderVariants::key(lights, false, true));
+        }
+        main_shaders->precompile(variantKeys);
+
     } catch (const std::exception& e) {
         std::cerr << "Asset initialization failed: " << e.what() << std::endl;
         throw;
     }
 }
 
-bool App::init() {
+bool App::init(int argc, char** argv) {
     try {
         // Load config
         std::ifstream configFile("app_settings.json");
@@ -123,17 +209,100 @@ bool App::init() {
         int height = config["default_resolution"]["y"];
         std::string title = config.value("appname", "OpenGL Maze");
 
+        nlohmann::json headlessConfig = config.value("headless", nlohmann::json::object());
+        headless.enabled = headlessConfig.value("enabled", false);
+        headless.backend = headlessConfig.value("backend", std::string("egl"));
+        headless.frames = headlessConfig.value("frames", 600);
+        headless.output = headlessConfig.value("output", std::string());
+        nlohmann::json benchmarkConfig = config.value("benchmark", nlohmann::json::object());
+        benchmark.enabled = benchmarkConfig.value("enabled", false);
+        benchmark.seed = benchmarkConfig.value("seed", std::uint64_t(1));
+        benchmark.frames = benchmarkConfig.value("frames", 1000);
+        benchmark.warmup = benchmarkConfig.value("warmup", 60);
+        benchmark.frameStep = benchmarkConfig.value("frame_step", 1.0 / 60.0);
+        benchmark.path = benchmarkConfig.value("path", std::string());
+        benchmark.report = benchmarkConfig.value("report", std::string("benchmark_report.json"));
+        nlohmann::json tracingConfig = config.value("tracing", nlohmann::json::object());
+        Trace::setEnabled(tracingConfig.value("enabled", false));
+        traceOutput = tracingConfig.value("output", std::string("trace.json"));
+        parseCommandLine(argc, argv);
+        TRACE_THREAD_NAME("Main");
+
         // GLFW init
         glfwSetErrorCallback(App::errorCallback);
+        if (headless.enabled) {
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#else
+            throw std::runtime_error("Headless rendering needs GLFW 3.4 or newer");
+#endif
+        }
         if (!glfwInit()) {
             throw std::runtime_error("GLFW initialization failed");
         }
 
+        if (headless.enabled) {
+            if (headless.backend != "egl" && headless.backend != "osmesa") {
+                throw std::runtime_error("Unknown headless backend " + headless.backend + " (egl or osmesa)");
+            }
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API,
+                           headless.backend == "osmesa" ? GLFW_OSMESA_CONTEXT_API : GLFW_EGL_CONTEXT_API);
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            vsyncOn = false;
+        }
+        if (benchmark.enabled) {
+            // Frame times are what's measured, not the display's refresh
+            vsyncOn = false;
+        }
         glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
         glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
         glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
 
+        // Fixed simulation rate and catch-up limit, optional render frame cap
+        nlohmann::json simulation = config.value("simulation", nlohmann::json::object());
+        simulationClock.configure(simulation.value("rate", 120.0), simulation.value("max_steps_per_frame", 8));
+        maxFrameRate = config.value("max_fps", 0.0);
+
+        // Maze size, carving algorithm and seed
+        nlohmann::json maze = config.value("maze", nlohmann::json::object());
+        mazeSettings.width = maze.value("width", 19);
+        mazeSettings.height = maze.value("height", 19);
+        mazeSettings.algorithm = mazeAlgorithmFromName(maze.value("algorithm", std::string("backtracker")));
+        mazeSettings.seed = maze.value("seed", std::uint64_t(0));
+        mazeStagingBudgetMs = maze.value("staging_budget_ms", 1.0);
+        infiniteMaze = maze.value("infinite", false);
+        mazeStreamSettings.chunkCells = maze.value("chunk_cells", 8);
+        mazeStreamSettings.viewRadius = maze.value("view_chunks", 2);
+        mazeStreamSettings.workers = maze.value("stream_workers", 2);
+        if (benchmark.enabled) {
+            if (benchmark.seed == 0) {
+                std::cerr << "Warning: benchmark seed 0 would pick a random maze, using 1\n";
+                benchmark.seed = 1;
+            }
+            mazeSettings.seed = benchmark.seed;
+        }
+        nlohmann::json terrainConfig = config.value("terrain", nlohmann::json::object());
+        const std::string terrainModeSetting = terrainConfig.value("mode", std::string("cdlod"));
+        terrainMode = terrainModeSetting == "mesh" ? TerrainMode::Mesh
+                    : terrainModeSetting == "tessellation" ? TerrainMode::Tessellation
+                    : TerrainMode::Cdlod;
+        terrainTilesPath = terrainConfig.value("tiles", std::string());
+        terrainTileRadius = terrainConfig.value("tile_cache_radius", 4);
+        terrainMeshSettings.step = terrainConfig.value("mesh_step", 2);
+        terrainMeshSettings.chunkQuads = terrainConfig.value("mesh_chunk_quads", 128);
+        terrainLodSettings.patchQuads = terrainConfig.value("patch_quads", 32);
+        terrainLodSettings.lodDistance = terrainConfig.value("lod_distance", 0.0f);
+        terrainLodSettings.morphRatio = terrainConfig.value("morph_ratio", 0.3f);
+        terrainTessSettings.patchCells = terrainConfig.value("tess_patch_cells", 64);
+        terrainTessSettings.edgePixels = terrainConfig.value("tess_edge_pixels", 12.0f);
+        terrainTessSettings.flatDetail = terrainConfig.value("tess_flat_detail", 0.25f);
+        nlohmann::json crowdConfig = config.value("crowd", nlohmann::json::object());
+        crowdSettings.agents = crowdConfig.value("agents", size_t(0));
+        crowdSettings.groups = crowdConfig.value("groups", 8);
+        crowdSettings.threads = crowdConfig.value("threads", 0);
+        crowdSettings.radius = crowdConfig.value("radius", 0.2f);
+
         // Load AA settings first
         antialiasingEnabled = config["antialiasing"]["enabled"];
         antialiasingSamples = config["antialiasing"]["samples"];
@@ -158,9 +327,16 @@ bool App::init() {
 
         // GLEW init
         glewExperimental = GL_TRUE;
-        if (glewInit() != GLEW_OK) {
+        GLenum glewStatus = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+        // Without an X display GLEW still loads the GL entry points, only its GLX part fails
+        if (headless.enabled && glewStatus == GLEW_ERROR_NO_GLX_DISPLAY) glewStatus = GLEW_OK;
+#endif
+        if (glewStatus != GLEW_OK) {
             throw std::runtime_error("GLEW initialization failed");
         }
+        ShaderProgram::enableParallelCompile();
+        profiler = std::make_unique<Profiler>();
 
         // Print OpenGL context info
         std::cout << "\n--- OpenGL Context Information ---\n";
@@ -171,6 +347,16 @@ bool App::init() {
         printGLInfo(GL_CONTEXT_PROFILE_MASK, "Context Profile");
         printGLInfo(GL_CONTEXT_FLAGS, "Context Flags");
 
+        if (headless.enabled) {
+            int framebufferWidth = 0, framebufferHeight = 0;
+            glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+            offscreen = std::make_unique<OffscreenTarget>(framebufferWidth, framebufferHeight,
+                                                          antialiasingEnabled ? antialiasingSamples : 0);
+            offscreen->bind();
+            std::cout << "Headless: " << headless.backend << ", " << offscreen->width() << "x" << offscreen->height()
+                      << " offscreen, " << headless.frames << " frames\n";
+        }
+
         // OpenGL config
         glEnable(GL_DEPTH_TEST);
         glDepthFunc(GL_LESS);
@@ -192,18 +378,26 @@ bool App::init() {
         glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
         isMouseVisible = false;
 
+        // Triple-buffered ring for per-frame uniform data
+        frameStream = std::make_unique<StreamingBuffer>(1024 * 1024, 3);
+
         // Initialize systems
         initImGUI();
         init_assets();
 
         // Initial camera setup
         updateProjection();
-        camera.Position = glm::vec3(15.0f, playerHeight, 5.0f); // Start at ground level
+        playerPosition = glm::vec3(15.0f, getTerrainHeight(15.0f, 5.0f) + playerHeight, 5.0f); // Start at ground level
+        previousPlayerPosition = playerPosition;
+        camera.Position = playerPosition;
         camera.Yaw = 180.0f;
         camera.updateCameraVectors();
 
         // Set initial safe position
-        lastSafePosition = camera.Position;
+        lastSafePosition = playerPosition;
+
+        // The chunks around the start are in place before the first frame
+        if (mazeStreamer) updateMazeStreaming(0.0, true);
 
         // Enable blending for transparency
         glEnable(GL_BLEND);
@@ -211,6 +405,7 @@ bool App::init() {
         glDepthFunc(GL_LEQUAL); // Helps with transparency sorting
 
         setupLights();
+        if (benchmark.enabled) initBenchmark();
         return true;
     } catch (const std::exception& e) {
         std::cerr << "Initialization failed: " << e.what() << std::endl;
@@ -219,153 +414,455 @@ bool App::init() {
 }
 
 int App::run() {
-    float lastFrame = 0.0f;
+    TRACE_SCOPE("App::run");
+    double lastFrame = glfwGetTime();
     auto lastTime = std::chrono::steady_clock::now();
     int frameCount = 0;
 
     while (!glfwWindowShouldClose(window)) {
+        const auto frameStart = std::chrono::steady_clock::now();
+        profiler->beginFrame();
+        TRACE_SCOPE("Frame");
+
+        // Frame scoped memory
+        frameArena.reset();
+        AllocationCounter::beginFrame();
+        frameStream->beginFrame();
+        if (crowdStream) crowdStream->beginFrame();
+
         // Timing calculations
-        float currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
+        double currentFrame = glfwGetTime();
+        // Benchmarks simulate the same time every frame, however long the frames take
+        deltaTime = benchmark.enabled ? static_cast<float>(benchmark.frameStep) : static_cast<float>(currentFrame - lastFrame);
         lastFrame = currentFrame;
 
-        updateLights(deltaTime);
+        // Run the fixed steps this frame's time owes, then draw between the last two
+        {
+            Profiler::CpuScope scope(*profiler, "Simulation");
+            TRACE_SCOPE("Simulation");
+            int steps = simulationClock.advance(deltaTime);
+            for (int i = 0; i < steps; i++) {
+                simulate(static_cast<float>(simulationClock.step()));
+            }
+            applyInterpolation(simulationClock.alpha());
+        }
 
-        // Update animations
-        updateAnimations(deltaTime);
+        // A maze built in the background gets a slice of this frame. Benchmarks wait for
+        // whatever streams in, so the content never depends on how fast the workers were.
+        {
+            Profiler::CpuScope scope(*profiler, "Maze staging");
+            TRACE_SCOPE("Maze staging");
+            if (benchmark.enabled && terrainTileCache) {
+                terrainTileCache->update(glm::vec2(camera.Position.x, camera.Position.z));
+                terrainTileCache->finish();
+            }
+            const double stagingBudgetMs = benchmark.enabled ? 0.0 : mazeStagingBudgetMs;
+            if (mazeStreamer) {
+                updateMazeStreaming(stagingBudgetMs, benchmark.enabled);
+            } else {
+                updateMazeStaging(stagingBudgetMs);
+            }
+        }
 
-        processInput(window, deltaTime);
         glDisable(GL_CULL_FACE);
+        if (offscreen) offscreen->bind();
+        if (benchmark.enabled) beginFrameQueries();
         render();
+        if (benchmark.enabled) endFrameQueries();
         glEnable(GL_CULL_FACE);
+        frameStream->endFrame();
+        if (crowdStream) crowdStream->endFrame();
         updateFPS(frameCount, lastTime);
+        TRACE_COUNTER("Draw calls", renderQueue.stats().packets);
+        TRACE_COUNTER("Heap allocations", AllocationCounter::lastFrame());
+        TRACE_COUNTER("Stream KB", frameStream->stats().bytesThisFrame / 1024);
+
+        if (headless.enabled && !benchmark.enabled && headless.frames > 0 && ++headlessFrame >= headless.frames) {
+            if (!headless.output.empty()) saveOffscreenFrame(headless.output);
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
+
+        {
+            Profiler::CpuScope scope(*profiler, "Swap");
+            TRACE_SCOPE("Swap");
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        if (benchmark.enabled) {
+            endBenchmarkFrame(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+        }
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        // Render throttling doesn't slow the simulation, the next frame just owes more steps
+        if (maxFrameRate > 0.0) {
+            double frameEnd = currentFrame + 1.0 / maxFrameRate;
+            double remaining = frameEnd - glfwGetTime();
+            if (remaining > 0.0) {
+                std::this_thread::sleep_for(std::chrono::duration<double>(remaining));
+            }
+        }
+    }
+    if (benchmark.enabled && benchmarkFrame < benchmark.warmup + benchmark.frames) {
+        std::cerr << "Warning: benchmark stopped after " << benchmarkFrame << " of "
+                  << benchmark.warmup + benchmark.frames << " frames, no report written\n";
     }
     return EXIT_SUCCESS;
 }
 
-void App::render() {
-    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+void App::parseCommandLine(int argc, char** argv) {
+    int frames = -1; // --frames, applied once it's known whether this is a benchmark
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--headless") {
+            headless.enabled = true;
+        } else if (arg.rfind("--headless=", 0) == 0) {
+            headless.enabled = true;
+            headless.backend = arg.substr(std::strlen("--headless="));
+        } else if (arg == "--frames" && i + 1 < argc) {
+            frames = std::max(std::atoi(argv[++i]), 0);
+        } else if (arg == "--output" && i + 1 < argc) {
+            headless.output = argv[++i];
+        } else if (arg == "--benchmark") {
+            benchmark.enabled = true;
+        } else if (arg == "--seed" && i + 1 < argc) {
+            benchmark.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--path" && i + 1 < argc) {
+            benchmark.path = argv[++i];
+        } else if (arg == "--report" && i + 1 < argc) {
+            benchmark.report = argv[++i];
+        } else if (arg == "--trace") {
+            Trace::setEnabled(true);
+        } else if (arg == "--trace-output" && i + 1 < argc) {
+            traceOutput = argv[++i];
+        } else {
+            std::cerr << "Warning: unknown argument " << arg << "\n";
+        }
+    }
 
-    // Enable multisampling if AA is enabled
-    if (antialiasingEnabled) {
-        glEnable(GL_MULTISAMPLE);
-        // Enable sample shading for better quality
-        glEnable(GL_SAMPLE_SHADING);
-        glMinSampleShading(1.0f);
+    if (frames < 0) return;
+    if (benchmark.enabled) {
+        benchmark.frames = std::max(frames, 1);
     } else {
-        glDisable(GL_MULTISAMPLE);
-        glDisable(GL_SAMPLE_SHADING);
+        headless.frames = frames;
     }
+}
+
+void App::saveOffscreenFrame(const std::string& path) {
+    glFinish();
+    std::vector<std::uint8_t> pixels = offscreen->readPixels();
+    cv::Mat image(offscreen->height(), offscreen->width(), CV_8UC4, pixels.data());
+    cv::Mat bgr;
+    cv::cvtColor(image, bgr, cv::COLOR_RGBA2BGR);
+    cv::flip(bgr, bgr, 0);
+    if (!cv::imwrite(path, bgr)) {
+        std::cerr << "Warning: failed to write " << path << "\n";
+        return;
+    }
+    std::cout << "Headless: last frame written to " << path << "\n";
+}
 
-    main_shader->activate();
-    main_shader->setUniform("dirLight.direction", sun.direction);
-    main_shader->setUniform("dirLight.ambient", sun.ambient);
-    main_shader->setUniform("dirLight.diffuse", sun.diffuse);
-    main_shader->setUniform("dirLight.specular", sun.specular);
-
-    for (int i = 0; i < pointLights.size(); i++) {
-        std::string prefix = "pointLights[" + std::to_string(i) + "].";
-        main_shader->setUniform(prefix + "position", pointLights[i].position);
-        main_shader->setUniform(prefix + "ambient", pointLights[i].ambient);
-        main_shader->setUniform(prefix + "diffuse", pointLights[i].diffuse);
-        main_shader->setUniform(prefix + "specular", pointLights[i].specular);
-        main_shader->setUniform(prefix + "constant", pointLights[i].constant);
-        main_shader->setUniform(prefix + "linear", pointLights[i].linear);
-        main_shader->setUniform(prefix + "quadratic", pointLights[i].quadratic);
-    }
-
-    main_shader->setUniform("spotLight.position", flashlight.position);
-    main_shader->setUniform("spotLight.direction", flashlight.direction);
-    main_shader->setUniform("spotLight.cutOff", flashlight.cutOff);
-    main_shader->setUniform("spotLight.outerCutOff", flashlight.outerCutOff);
-    main_shader->setUniform("spotLight.ambient", flashlight.ambient);
-    main_shader->setUniform("spotLight.diffuse", flashlight.diffuse);
-    main_shader->setUniform("spotLight.specular", flashlight.specular);
-    main_shader->setUniform("spotLight.constant", flashlight.constant);
-    main_shader->setUniform("spotLight.linear", flashlight.linear);
-    main_shader->setUniform("spotLight.quadratic", flashlight.quadratic);
-
-    main_shader->setUniform("projection", projection);
-    main_shader->setUniform("view", camera.GetViewMatrix());
-    main_shader->setUniform("viewPos", camera.Position);
-
-    // Render heightmap with moon surface texture
-    if (heightMapMesh) {
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
-        main_shader->setUniform("model", model);
-        main_shader->setUniform("useTexture", 1); // Always use texture for heightmap
-
-        if (surfaceTexture) {
-            surfaceTexture->bind(GL_TEXTURE0);
-            main_shader->setUniform("diffuseTexture", 0);
+void App::initBenchmark() {
+    if (benchmark.path.empty()) {
+        cameraPath = orbitCameraPath();
+    } else {
+        std::ifstream file(benchmark.path);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open camera path " + benchmark.path);
         }
+        cameraPath = CameraPath::fromJson(nlohmann::json::parse(file));
+    }
+    benchmark.frames = std::max(benchmark.frames, 1);
+    benchmark.warmup = std::max(benchmark.warmup, 0);
+    benchmarkSamples.reserve(benchmark.frames);
+    for (FrameQueries& queries : frameQueries) {
+        glCreateQueries(GL_TIMESTAMP, 2, &queries.begin);
+        glCreateQueries(GL_PRIMITIVES_GENERATED, 1, &queries.primitives);
+    }
+    followCameraPath(0.0f);
+    previousPlayerPosition = playerPosition;
+    std::cout << "Benchmark: seed " << benchmark.seed << ", " << benchmark.warmup << " + " << benchmark.frames
+              << " frames of " << benchmark.frameStep * 1000.0 << " ms, camera path "
+              << (benchmark.path.empty() ? std::string("orbit") : benchmark.path) << " (" << cameraPath.size()
+              << " keys, " << cameraPath.duration() << " s)\n";
+}
 
-        // Set material properties for heightmap
-        main_shader->setUniform("objectColor", glm::vec3(1.0f)); // White base color
-        main_shader->setUniform("alpha", 1.0f); // Fully opaque
+CameraPath App::orbitCameraPath() const {
+    glm::vec2 center(playerPosition.x, playerPosition.z);
+    float radius = 10.0f;
+    if (!mazeStreamer && mazeMap.width() > 0) {
+        // The fixed maze is built centered on the origin
+        center = glm::vec2(0.0f);
+        radius = 0.6f * std::max(mazeMap.width(), mazeMap.height()) * mazePlacement.cellSize + 3.0f;
+    }
 
-        heightMapMesh->draw();
+    const float duration = static_cast<float>((benchmark.warmup + benchmark.frames) * benchmark.frameStep);
+    constexpr int KEYS = 36;
+    CameraPath path;
+    for (int i = 0; i <= KEYS; i++) {
+        const float angle = glm::radians(360.0f * i / KEYS);
+        const float x = center.x + radius * std::cos(angle);
+        const float z = center.y + radius * std::sin(angle);
+        // Facing the center: yaw is the angle of the direction back to it
+        path.add({duration * i / KEYS, glm::vec3(x, getTerrainHeight(x, z) + playerHeight + 3.0f, z),
+                  glm::degrees(angle) + 180.0f, -15.0f});
     }
+    return path;
+}
+
+void App::followCameraPath(float step) {
+    if (cameraPath.empty()) return;
+    cameraPathTime += step;
+    const CameraKey pose = cameraPath.sample(cameraPathTime);
+    playerPosition = pose.position;
+    lastSafePosition = playerPosition;
+    camera.Yaw = pose.yaw;
+    camera.Pitch = pose.pitch;
+    camera.updateCameraVectors();
+}
 
-    // First pass: draw all completely opaque objects
-    glDisable(GL_BLEND);
-    glDepthMask(GL_TRUE);
+void App::beginFrameQueries() {
+    FrameQueries& queries = frameQueries[benchmarkFrame % frameQueries.size()];
+    // Issued frameQueries.size() frames ago, long done unless the GPU is that far behind
+    if (queries.frame >= 0) collectFrameQueries(queries);
+    queries.frame = benchmarkFrame;
+    glQueryCounter(queries.begin, GL_TIMESTAMP);
+    glBeginQuery(GL_PRIMITIVES_GENERATED, queries.primitives);
+}
 
-    sphereObject->position = sunWorldPosition;
-    sphereObject->scale = glm::vec3(5.0f);
-    glDisable(GL_DEPTH_TEST);
-    sphereObject->draw();
-    glEnable(GL_DEPTH_TEST);
+void App::endFrameQueries() {
+    glEndQuery(GL_PRIMITIVES_GENERATED);
+    glQueryCounter(frameQueries[benchmarkFrame % frameQueries.size()].end, GL_TIMESTAMP);
+}
 
-    for (const auto& wall : mazeWalls) {
-        if (!wall->transparent) {
-            wall->draw();
-        }
+void App::collectFrameQueries(FrameQueries& queries) {
+    GLuint64 begin = 0, end = 0, primitives = 0;
+    glGetQueryObjectui64v(queries.begin, GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(queries.end, GL_QUERY_RESULT, &end);
+    glGetQueryObjectui64v(queries.primitives, GL_QUERY_RESULT, &primitives);
+    const int measured = queries.frame - benchmark.warmup;
+    if (measured >= 0 && measured < static_cast<int>(benchmarkSamples.size())) {
+        benchmarkSamples[measured].gpuMs = (end - begin) / 1e6;
+        benchmarkSamples[measured].triangles = primitives;
+    }
+    queries.frame = -1;
+}
+
+void App::endBenchmarkFrame(double cpuMs) {
+    if (benchmarkFrame >= benchmark.warmup) {
+        FrameSample sample;
+        sample.cpuMs = cpuMs;
+        sample.drawCalls = renderQueue.stats().packets;
+        benchmarkSamples.push_back(sample);
+    }
+    if (++benchmarkFrame < benchmark.warmup + benchmark.frames) return;
+
+    for (FrameQueries& queries : frameQueries) {
+        if (queries.frame >= 0) collectFrameQueries(queries);
     }
+    writeBenchmarkReport();
+    if (headless.enabled && !headless.output.empty()) saveOffscreenFrame(headless.output);
+    glfwSetWindowShouldClose(window, GLFW_TRUE);
+}
 
-    // Separate objects into opaque and transparent lists
-    std::vector<Model*> opaqueObjects;
-    std::vector<Model*> transparentObjects;
+void App::writeBenchmarkReport() {
+    int width = 0, height = 0;
+    glfwGetFramebufferSize(window, &width, &height);
+    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    nlohmann::json settings = {
+        {"seed", benchmark.seed},
+        {"frames", benchmark.frames},
+        {"warmup", benchmark.warmup},
+        {"frame_step", benchmark.frameStep},
+        {"camera_path", benchmark.path.empty() ? std::string("orbit") : benchmark.path},
+        {"renderer", renderer ? renderer : ""},
+        {"resolution", {width, height}},
+        {"headless", headless.enabled},
+        {"antialiasing", antialiasingEnabled ? antialiasingSamples : 0},
+        {"maze", {{"width", mazeSettings.width}, {"height", mazeSettings.height},
+                  {"algorithm", mazeAlgorithmName(mazeSettings.algorithm)}, {"infinite", infiniteMaze}}},
+        {"terrain_mode", terrainModeName(static_cast<int>(terrainMode))},
+        {"crowd_agents", crowd ? crowd->size() : size_t(0)},
+    };
+    const nlohmann::json report = benchmarkReport(benchmarkSamples, settings, true);
 
-    for (auto& obj : this->transparentObjects) {
-        if (obj->hasTransparency()) {
-            transparentObjects.push_back(obj.get());
-        } else {
-            opaqueObjects.push_back(obj.get());
-        }
+    std::ofstream file(benchmark.report);
+    if (!file.is_open()) {
+        std::cerr << "Warning: failed to write " << benchmark.report << "\n";
+        return;
+    }
+    file << report.dump(2) << "\n";
+    std::cout << "Benchmark: " << benchmarkSamples.size() << " frames, CPU "
+              << report["cpu_ms"]["mean"].get<double>() << " ms mean / " << report["cpu_ms"]["p99"].get<double>()
+              << " ms p99, GPU " << report["gpu_ms"]["mean"].get<double>() << " ms mean / "
+              << report["gpu_ms"]["p99"].get<double>() << " ms p99, report written to " << benchmark.report << "\n";
+}
+
+void App::toggleCameraRecording() {
+    recordingPath = !recordingPath;
+    if (recordingPath) {
+        recordedPath.clear();
+        recordTime = 0.0f;
+        recordedPath.add({0.0f, playerPosition, camera.Yaw, camera.Pitch});
+        std::cout << "Recording camera path (F9 stops)\n";
+        return;
+    }
+
+    const std::string path = "camera_path.json";
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Warning: failed to write " << path << "\n";
+        return;
+    }
+    file << recordedPath.toJson().dump(2) << "\n";
+    std::cout << "Camera path: " << recordedPath.size() << " keys, " << recordedPath.duration() << " s written to "
+              << path << "\n";
+}
+
+void App::recordCameraKey(float step) {
+    // A key every 0.1 s; playback's spline smooths between them
+    constexpr float KEY_INTERVAL = 0.1f;
+    const float previous = recordTime;
+    recordTime += step;
+    if (std::floor(recordTime / KEY_INTERVAL) > std::floor(previous / KEY_INTERVAL)) {
+        recordedPath.add({recordTime, playerPosition, camera.Yaw, camera.Pitch});
+    }
+}
+
+void App::simulate(float step) {
+    // What was current becomes the state interpolation starts from
+    previousPlayerPosition = playerPosition;
+    previousSunAngle = sunAngle;
+    previousLightPulse = lightPulse;
+    scene.each<Interpolated>([](Interpolated& state) {
+        state.previousPosition = state.position;
+        state.previousRotation = state.rotation;
+    });
+
+    if (benchmark.enabled) {
+        followCameraPath(step);
+    } else {
+        processInput(window, step);
+        if (recordingPath) recordCameraKey(step);
+    }
+    updateLights(step);
+    updateAnimations(step);
+    if (crowd) crowd->update(step);
+}
+
+void App::applyInterpolation(float alpha) {
+    camera.Position = glm::mix(previousPlayerPosition, playerPosition, alpha);
+    setLightState(glm::mix(previousSunAngle, sunAngle, alpha), glm::mix(previousLightPulse, lightPulse, alpha));
+
+    scene.each<Transform, Interpolated>([&](const Transform& transform, const Interpolated& state) {
+        // Rotations wrap at 360, blend across the short way
+        glm::vec3 turn = state.rotation - state.previousRotation;
+        turn -= 360.0f * glm::round(turn / 360.0f);
+        transforms.setPosition(transform.id, glm::mix(state.previousPosition, state.position, alpha));
+        transforms.setRotation(transform.id, state.previousRotation + turn * alpha);
+    });
+}
+
+void App::render() {
+    TRACE_SCOPE("App::render");
+    Profiler::CpuScope renderScope(*profiler, "Render");
+    {
+        Profiler::GpuScope scope(*profiler, "Clear");
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     }
 
-    // Draw nearly-opaque objects without blending
-    glDisable(GL_BLEND);
-    glDepthMask(GL_TRUE);
-    for (auto obj : opaqueObjects) {
-        obj->draw();
+    // Enable multisampling if AA is enabled
+    if (antialiasingEnabled) {
+        glEnable(GL_MULTISAMPLE);
+        // Enable sample shading for better quality
+        glEnable(GL_SAMPLE_SHADING);
+        glMinSampleShading(1.0f);
+    } else {
+        glDisable(GL_MULTISAMPLE);
+        glDisable(GL_SAMPLE_SHADING);
     }
 
-    // Sort and draw truly transparent objects
-    std::sort(transparentObjects.begin(), transparentObjects.end(),
-        [this](const Model* a, const Model* b) {
-            return glm::distance(camera.Position, a->position) >
-                   glm::distance(camera.Position, b->position);
-        });
+    // Camera and lights go to the GPU as two uniform blocks streamed through the ring buffer
+    CameraUniforms cameraData{
+        .projection = projection,
+        .view = camera.GetViewMatrix(),
+        .viewPos = camera.Position
+    };
+
+    LightUniforms lightData{};
+    lightData.dirLight = sun;
+    for (int i = 0; i < pointLights.size() && i < MAX_POINT_LIGHTS; i++) {
+        lightData.pointLights[i] = pointLights[i];
+    }
+    lightData.spotLight = flashlight;
+
+    StreamingBuffer::bind(GL_UNIFORM_BUFFER, CAMERA_UBO_BINDING, frameStream->push(cameraData));
+    StreamingBuffer::bind(GL_UNIFORM_BUFFER, LIGHTS_UBO_BINDING, frameStream->push(lightData));
+
+    // Only transforms that changed since last frame get new matrices
+    transforms.updateMatrices();
+
+    // Material table and its texture arrays stay bound for the whole frame
+    materials->bind();
+
+    // Everything drawn this frame goes through the render queue, which orders the draws
+    // by pass/program/material/depth and skips redundant GL state changes
+    renderQueue.clear();
+
+    // Heightmap with moon surface texture
+    // The terrain spans the whole scene, so it always takes every point light
+    int terrainLights[MAX_POINT_LIGHTS];
+    int terrainLightCount = std::min(static_cast<int>(pointLights.size()), MAX_POINT_LIGHTS);
+    for (int i = 0; i < terrainLightCount; i++) terrainLights[i] = i;
+    Frustum frustum = Frustum::fromMatrix(cameraData.projection * cameraData.view);
+    {
+        Profiler::CpuScope scope(*profiler, "Terrain");
+        queueTerrain(frustum, terrainLights, terrainLightCount);
+    }
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDepthMask(GL_FALSE);
+    // The crowd spans the maze like the terrain, so it takes the same lights
+    {
+        Profiler::CpuScope scope(*profiler, "Crowd");
+        queueCrowd(simulationClock.alpha(), terrainLights, terrainLightCount);
+    }
 
-    for (auto obj : transparentObjects) {
-        obj->draw();
+    // One pass over the scene: cull against the view frustum, refresh light assignments
+    // and queue whatever is visible
+    {
+        Profiler::CpuScope scope(*profiler, "Scene");
+        size_t visible = 0;
+        scene.each<Transform, Renderable, LightSet>(
+            [&](Entity entity, const Transform& transform, const Renderable& renderable, LightSet& lights) {
+                if (renderable.hidden) return;
+                glm::vec3 position = transforms.position(transform.id);
+                bool background = scene.has<Background>(entity);
+                if (!background && !frustum.intersectsSphere(position, renderable.radius)) return;
+
+                assignPointLights(position, renderable.radius, lights);
+                RenderPass pass = background ? RenderPass::Background
+                                : materials->isTransparent(renderable.material) ? RenderPass::Transparent
+                                : RenderPass::Opaque;
+                float depth01 = glm::distance(camera.Position, position) / FAR_PLANE;
+                renderable.model->enqueue(renderQueue, pass, renderable.material,
+                                          transforms.world(transform.id), transforms.normal(transform.id),
+                                          lights.indices.data(), lights.count, depth01,
+                                          materials->isAlphaTested(renderable.material));
+                visible++;
+            });
+        visibleEntities = visible;
     }
 
-    // Restore state
-    glDepthMask(GL_TRUE);
-    glDisable(GL_BLEND);
+    {
+        Profiler::CpuScope scope(*profiler, "Sort");
+        renderQueue.sort();
+    }
+    {
+        Profiler::CpuScope scope(*profiler, "Submit");
+        renderQueue.submit(profiler.get());
+    }
 
+    Profiler::CpuScope imguiScope(*profiler, "ImGui");
+    Profiler::GpuScope imguiGpuScope(*profiler, "ImGui");
     renderImGUI();
 }
 
@@ -426,46 +923,93 @@ void App::setupLights() {
 }
 
 void App::updateLights(float deltaTime) {
-    // Simple day/night cycle
-    static float sunAngle = 0.0f;
+    // Simple day/night cycle and pulsing point lights
     sunAngle += deltaTime * 0.1f;
+    lightPulse += deltaTime;
+}
 
+void App::setLightState(float angle, float pulse) {
     // Sun direction (pointing TOWARD the scene)
     sun.direction = glm::normalize(glm::vec3(
-        cos(sunAngle),
-        sin(sunAngle) * 0.5f - 0.7f,  // Keeps sun mostly above horizon
-        sin(sunAngle)
+        cos(angle),
+        sin(angle) * 0.5f - 0.7f,  // Keeps sun mostly above horizon
+        sin(angle)
     ));
 
     // Sun visual position (pointing AWAY from the scene)
     // Far away in the opposite direction
     sunWorldPosition = -sun.direction * 400.0f;
+    if (const Transform* sunTransform = scene.get<Transform>(sunEntity)) {
+        transforms.setPosition(sunTransform->id, sunWorldPosition);
+    }
 
     // Update flashlight to follow camera
     flashlight.position = camera.Position;
     flashlight.direction = camera.Front;
 
     // Make point lights pulse
-    static float pulse = 0.0f;
-    pulse += deltaTime;
     pointLights[0].diffuse.r = 0.8f + sin(pulse) * 0.2f;
     pointLights[1].diffuse.g = 0.8f + cos(pulse*0.7f) * 0.2f;
     pointLights[2].diffuse.b = 0.8f + sin(pulse*1.3f) * 0.2f;
+
+    for (int i = 0; i < pointLights.size() && i < MAX_POINT_LIGHTS; i++) {
+        pointLightRanges[i] = pointLightRange(pointLights[i]);
+    }
 }
 
+void App::assignPointLights(const glm::vec3& position, float radius, LightSet& lights) const {
+    lights.count = 0;
+    for (int i = 0; i < pointLights.size() && i < MAX_POINT_LIGHTS; i++) {
+        if (glm::distance(position, pointLights[i].position) < pointLightRanges[i] + radius) {
+            lights.indices[lights.count++] = i;
+        }
+    }
+}
 
-void App::updateAnimations(float deltaTime) {
-    for (auto& obj : transparentObjects) {
-        obj->update(deltaTime);
+Model* App::addModelAsset(const std::filesystem::path& path) {
+    modelAssets.push_back(std::make_unique<Model>(path, main_shaders));
+    return modelAssets.back().get();
+}
+
+void App::destroyEntity(Entity entity) {
+    if (const Transform* transform = scene.get<Transform>(entity)) {
+        transforms.release(transform->id);
     }
-    if (spinningGlassCube) {
-        spinningGlassCube->rotation += cubeRotationSpeed * deltaTime;
+    if (const Collider* collider = scene.get<Collider>(entity)) {
+        collisionWorld.bodies().remove(collider->body);
+    }
+    scene.destroy(entity);
+}
+
+Collider App::makeCollider(const glm::vec3& position, const glm::vec3& scale) {
+    glm::vec2 center(position.x, position.z);
+    glm::vec2 halfExtents = glm::vec2(scale.x, scale.z) * 0.5f;
+    return Collider{collisionWorld.bodies().insert(center, halfExtents)};
+}
+
+
+void App::updateAnimations(float deltaTime) {
+    // Animated materials step their frame layer in the material table
+    materials->update(deltaTime);
+
+    scene.each<Interpolated, Spin>([&](Interpolated& state, const Spin& spin) {
+        glm::vec3 rotation = state.rotation + spin.degreesPerSecond * deltaTime;
 
         // Keep rotations within 0-360 degrees
-        if (spinningGlassCube->rotation.x >= 360.0f) spinningGlassCube->rotation.x -= 360.0f;
-        if (spinningGlassCube->rotation.y >= 360.0f) spinningGlassCube->rotation.y -= 360.0f;
-        if (spinningGlassCube->rotation.z >= 360.0f) spinningGlassCube->rotation.z -= 360.0f;
-    }
+        if (rotation.x >= 360.0f) rotation.x -= 360.0f;
+        if (rotation.y >= 360.0f) rotation.y -= 360.0f;
+        if (rotation.z >= 360.0f) rotation.z -= 360.0f;
+        state.rotation = rotation;
+    });
+
+    // Moving colliders follow their simulated position; the hash only relinks boxes that changed cells
+    scene.each<Transform, Interpolated, Collider>([&](const Transform& transform, const Interpolated& state,
+                                                      const Collider& collider) {
+        glm::vec3 position = state.position;
+        glm::vec3 scale = transforms.scale(transform.id);
+        collisionWorld.bodies().update(collider.body, glm::vec2(position.x, position.z),
+                                       glm::vec2(scale.x, scale.z) * 0.5f);
+    });
 }
 
 void App::updateFPS(int& frameCount, std::chrono::steady_clock::time_point& lastTime) {
@@ -475,47 +1019,135 @@ void App::updateFPS(int& frameCount, std::chrono::steady_clock::time_point& last
 
     if (elapsed.count() >= 1) {
         double fps = frameCount / elapsed.count();
-        std::string title = "Maze Renderer - FPS: " + std::to_string(static_cast<int>(fps));
-        glfwSetWindowTitle(window, title.c_str());
+        char title[64];
+        std::snprintf(title, sizeof(title), "Maze Renderer - FPS: %d", static_cast<int>(fps));
+        glfwSetWindowTitle(window, title);
+        AllocationCounter::resetPeak();
         frameCount = 0;
         lastTime = currentTime;
     }
 }
 
-uchar App::getMapValue(int x, int y) const {
-    x = std::clamp(x, 0, mazeMap.cols - 1);
-    y = std::clamp(y, 0, mazeMap.rows - 1);
-    return mazeMap.at<uchar>(y, x);
-}
-
 void App::initHeightMap() {
-    // Load heightmap image
-    cv::Mat heightMap = cv::imread("resources/textures/heightmap_3_inverted.png", cv::IMREAD_GRAYSCALE);
-    if (heightMap.empty()) {
-        throw std::runtime_error("Failed to load heightmap texture");
-    }
+    if (!terrainTilesPath.empty()) {
+        initTerrainTiles();
+    } else {
+        cv::Mat heightMap = loadHeightMapImage();
 
-    // Store the height data for CPU access
-    heightData = heightMap.clone();
+        // Keep the heights on the CPU for gameplay queries, in the same layout as the mesh
+        terrain.build(heightMap.data, heightMap.cols, heightMap.rows, heightMap.step1(),
+                      TerrainLayout::centered(heightMap.cols, heightMap.rows, 0.2f, 1.0f / 255.0f * 2 * 10.0f));
 
-    // Generate mesh and height data texture
-    heightMapMesh = generateHeightMap(heightMap, 2);
-    heightMapTexture = loadHeightMapTexture(heightMap);
+        // Height texture for GPU displacement; the full mesh is only built if its mode is used
+        heightMapTexture = loadHeightMapTexture(heightMap);
+        terrainLod.build(terrain, terrainLodSettings);
+    }
+    std::vector<glm::vec2> patchPositions;
+    std::vector<GLuint> patchIndices;
+    TerrainLod::buildPatch(terrainLod.patchQuads(), patchPositions, patchIndices);
+    std::vector<vertex> patchVertices;
+    patchVertices.reserve(patchPositions.size());
+    for (const glm::vec2& position : patchPositions) {
+        patchVertices.emplace_back(glm::vec3(position.x, 0.0f, position.y), glm::vec3(0.0f, 1.0f, 0.0f), position);
+    }
+    terrainPatch = std::make_unique<Mesh>(GL_TRIANGLES, patchVertices, patchIndices);
+    setTerrainMode(terrainMode);
 
     // Load surface texture
-    surfaceTexture = Texture::create("resources/textures/moon_surface_tiled3.png");
-    if (!surfaceTexture || !surfaceTexture->valid()) {
+    MaterialTexture surfaceTexture = materials->loadTexture("resources/textures/moon_surface_tiled3.png");
+    if (surfaceTexture.array < 0) {
         throw std::runtime_error("Failed to load moon surface texture");
     }
+    terrainMaterial = materials->add({.texture = surfaceTexture});
+}
+
+void App::initTerrainTiles() {
+    // Without a tiles file yet, convert the heightmap so the mode works out of the box;
+    // terrains that don't fit in memory are written with writeTerrainTiles from their source
+    if (!std::filesystem::exists(terrainTilesPath)) {
+        cv::Mat heightMap = loadHeightMapImage();
+        std::cout << "Converting the heightmap to " << terrainTilesPath << "\n";
+        const float heightScale = 1.0f / 255.0f * 2 * 10.0f / 257.0f;
+        writeTerrainTiles(terrainTilesPath, heightMap.cols, heightMap.rows,
+                          TerrainLayout::centered(heightMap.cols, heightMap.rows, 0.2f, heightScale), {},
+                          [&](int z, std::uint16_t* row) {
+                              const std::uint8_t* source = heightMap.ptr<std::uint8_t>(z);
+                              for (int x = 0; x < heightMap.cols; x++) row[x] = static_cast<std::uint16_t>(source[x] * 257);
+                          });
+    }
+    terrainTiles = std::make_unique<TerrainTiles>();
+    terrainTiles->open(terrainTilesPath);
+    const TerrainTiles& tiles = *terrainTiles;
+
+    // Coarse queries and the far terrain come from the overview
+    TerrainLayout overviewLayout = tiles.layout();
+    overviewLayout.worldScale *= tiles.overviewStep();
+    terrain.build(tiles.overview(), tiles.overviewColumns(), tiles.overviewRows(),
+                  tiles.overviewColumns() * sizeof(std::uint16_t), overviewLayout);
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &heightMapTexture);
+    glTextureParameteri(heightMapTexture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(heightMapTexture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(heightMapTexture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(heightMapTexture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureStorage2D(heightMapTexture, 1, GL_R16, tiles.overviewColumns(), tiles.overviewRows());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    glTextureSubImage2D(heightMapTexture, 0, 0, 0, tiles.overviewColumns(), tiles.overviewRows(),
+                        GL_RED, GL_UNSIGNED_SHORT, tiles.overview());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    // Tiles sit at their coordinates modulo the window, which wraps around
+    terrainTileCache = std::make_unique<TerrainTileCache>(tiles, terrainTileRadius);
+    const int windowSamples = terrainTileCache->windowSamples();
+    glCreateTextures(GL_TEXTURE_2D, 1, &terrainWindowTexture);
+    glTextureParameteri(terrainWindowTexture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTextureParameteri(terrainWindowTexture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTextureParameteri(terrainWindowTexture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(terrainWindowTexture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureStorage2D(terrainWindowTexture, 1, GL_R16, windowSamples, windowSamples);
+
+    terrainLod.build(tiles, terrainLodSettings);
+
+    // Start with the tiles around the camera in place
+    terrainTileCache->update(glm::vec2(camera.Position.x, camera.Position.z));
+    terrainTileCache->finish();
+    streamTerrain();
+
+    std::cout << "Terrain tiles: " << tiles.columns() << "x" << tiles.rows() << " samples, "
+              << tiles.fileBytes() / (1024 * 1024) << " MB mapped, " << terrainTileCache->bytes() / (1024 * 1024)
+              << " MB cache, " << windowSamples << "^2 window\n";
+}
+
+void App::streamTerrain() {
+    if (!terrainTileCache) return;
+    terrainTileCache->update(glm::vec2(camera.Position.x, camera.Position.z));
+    const int tileSize = terrainTiles->tileSize();
+    for (TerrainTileCache::Slot slot : terrainTileCache->loaded()) {
+        const glm::ivec2 offset = terrainTileCache->windowOffset(slot);
+        glTextureSubImage2D(terrainWindowTexture, 0, offset.x, offset.y, tileSize, tileSize,
+                            GL_RED, GL_UNSIGNED_SHORT, terrainTileCache->data(slot));
+    }
+}
+
+void App::bindTerrainTextures() {
+    glBindTextureUnit(TERRAIN_HEIGHT_TEXTURE_UNIT, heightMapTexture);
+    TerrainWindowUniforms window;
+    if (terrainTileCache) {
+        glBindTextureUnit(TERRAIN_WINDOW_TEXTURE_UNIT, terrainWindowTexture);
+        window.rect = glm::vec4(terrainTileCache->residentRect());
+        window.info = glm::vec4(terrainTileCache->windowSamples(), terrainTiles->tileSize() * 0.5f,
+                                terrainTiles->overviewStep(), 0.0f);
+    }
+    StreamingBuffer::bind(GL_UNIFORM_BUFFER, TERRAIN_WINDOW_UBO_BINDING, frameStream->push(window));
 }
 
 GLuint App::loadHeightMapTexture(const cv::Mat& heightMap) {
     GLuint textureID;
     glCreateTextures(GL_TEXTURE_2D, 1, &textureID);
 
-    // Configure texture
-    glTextureParameteri(textureID, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTextureParameteri(textureID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    // Configure texture, past the edge the border texels extend like in TerrainQuery
+    glTextureParameteri(textureID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(textureID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTextureParameteri(textureID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTextureParameteri(textureID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
@@ -527,187 +1159,408 @@ GLuint App::loadHeightMapTexture(const cv::Mat& heightMap) {
     return textureID;
 }
 
-std::unique_ptr<Mesh> App::generateHeightMap(const cv::Mat& heightMap, unsigned int stepSize) {
-    std::vector<vertex> vertices;
-    std::vector<GLuint> indices;
-    GLuint index = 0;
-
-    const float heightScale = 1.0f / 255.0f * 2;
-    const float worldScale = 0.2f;
-    const float heightMapBaseY = 0.0f;
-
-    // Texture tiling factor
-    const float textureTileFactor = 15.0f;
-
-    // Calculate offset to center the heightmap (XZ only)
-    float xOffset = -heightMap.cols * worldScale * 0.5f;
-    float zOffset = -heightMap.rows * worldScale * 0.5f;
-
-    for (unsigned int z = 0; z < heightMap.rows - stepSize; z += stepSize) {
-        for (unsigned int x = 0; x < heightMap.cols - stepSize; x += stepSize) {
-            // Get height values (0-1 range)
-            float h0 = heightMap.at<uchar>(z, x) * heightScale;
-            float h1 = heightMap.at<uchar>(z, x + stepSize) * heightScale;
-            float h2 = heightMap.at<uchar>(z + stepSize, x + stepSize) * heightScale;
-            float h3 = heightMap.at<uchar>(z + stepSize, x) * heightScale;
-
-            // Vertex positions (Y coordinate uses explicit base + scaled height)
-            glm::vec3 p0(
-                x * worldScale + xOffset,
-                heightMapBaseY + h0 * 10.0f,
-                z * worldScale + zOffset
-            );
-            glm::vec3 p1(
-                (x + stepSize) * worldScale + xOffset,
-                heightMapBaseY + h1 * 10.0f,
-                z * worldScale + zOffset
-            );
-            glm::vec3 p2(
-                (x + stepSize) * worldScale + xOffset,
-                heightMapBaseY + h2 * 10.0f,
-                (z + stepSize) * worldScale + zOffset
-            );
-            glm::vec3 p3(
-                x * worldScale + xOffset,
-                heightMapBaseY + h3 * 10.0f,
-                (z + stepSize) * worldScale + zOffset
-            );
-
-            // Calculate normal
-            glm::vec3 normal = glm::normalize(glm::cross(p2 - p0, p1 - p0));
-
-            // Modified texture coordinates - multiplied by tile factor
-            glm::vec2 t0(
-                static_cast<float>(x) / heightMap.cols * textureTileFactor,
-                static_cast<float>(z) / heightMap.rows * textureTileFactor
-            );
-            glm::vec2 t1(
-                static_cast<float>(x + stepSize) / heightMap.cols * textureTileFactor,
-                static_cast<float>(z) / heightMap.rows * textureTileFactor
-            );
-            glm::vec2 t2(
-                static_cast<float>(x + stepSize) / heightMap.cols * textureTileFactor,
-                static_cast<float>(z + stepSize) / heightMap.rows * textureTileFactor
-            );
-            glm::vec2 t3(
-                static_cast<float>(x) / heightMap.cols * textureTileFactor,
-                static_cast<float>(z + stepSize) / heightMap.rows * textureTileFactor
-            );
-
-            // Add vertices
-            vertices.emplace_back(p0, normal, t0);
-            vertices.emplace_back(p1, normal, t1);
-            vertices.emplace_back(p2, normal, t2);
-            vertices.emplace_back(p3, normal, t3);
-
-            // Add indices (two triangles per quad)
-            indices.push_back(index);
-            indices.push_back(index + 1);
-            indices.push_back(index + 2);
-            indices.push_back(index);
-            indices.push_back(index + 2);
-            indices.push_back(index + 3);
-
-            index += 4;
+void App::setTerrainMode(TerrainMode mode) {
+    if (terrainTiles && mode != TerrainMode::Cdlod) {
+        std::cerr << "Warning: terrain mode " << terrainModeName(static_cast<int>(mode))
+                  << " needs the whole heightmap in memory, tiled terrains are drawn with CDLOD\n";
+        mode = TerrainMode::Cdlod;
+    }
+    terrainMode = mode;
+    if (mode == TerrainMode::Mesh && !terrainMesh && !terrain.empty()) {
+        auto start = std::chrono::steady_clock::now();
+        TerrainMeshData data = buildTerrainMesh(terrain, terrainMeshSettings);
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        terrainMesh = std::make_unique<TerrainMesh>(data);
+        std::cout << "Terrain mesh: " << data.vertices.size() << " vertices in " << data.chunks.size() << " chunks, "
+                  << data.bytes() / 1024 << " KB (" << legacyTerrainMeshBytes(terrain, terrainMeshSettings.step) / 1024
+                  << " KB in the old layout), built in " << ms << " ms\n";
+    }
+    if (mode == TerrainMode::Tessellation && !terrainTessPatches && !terrain.empty()) {
+        terrainTessellation.build(terrain, terrainTessSettings);
+        std::vector<vertex> corners;
+        corners.reserve(terrainTessellation.corners().size());
+        for (size_t i = 0; i < terrainTessellation.corners().size(); i++) {
+            const glm::vec2& corner = terrainTessellation.corners()[i];
+            corners.emplace_back(glm::vec3(corner.x, 0.0f, corner.y), glm::vec3(0.0f, 1.0f, 0.0f),
+                                 glm::vec2(terrainTessellation.cornerRoughness()[i], 0.0f));
         }
+        terrainTessPatches = std::make_unique<Mesh>(GL_PATCHES, corners, terrainTessellation.indices());
     }
+}
 
-    return std::make_unique<Mesh>(GL_TRIANGLES, main_shader, vertices, indices);
+void App::cycleTerrainMode() {
+    setTerrainMode(static_cast<TerrainMode>((static_cast<int>(terrainMode) + 1) % 3));
+    std::cout << "Terrain: " << terrainModeName(static_cast<int>(terrainMode)) << "\n";
 }
 
-void App::generateMaze(std::shared_ptr<ShaderProgram> shader) {
-    const int mazeWidth = 19;
-    const int mazeHeight = 19;
-    mazeMap = cv::Mat(mazeHeight, mazeWidth, CV_8U);
-    genLabyrinth(mazeMap);
+void App::queueTerrain(const Frustum& frustum, const int* lightIndices, int lightCount) {
+    static const glm::mat4 identity(1.0f);
+    const std::uint32_t variant = ShaderVariants::key(lightCount, false, materials->isAlphaTested(terrainMaterial));
+    DrawPacket packet;
+    packet.material = terrainMaterial;
+    packet.world = &identity;
+    packet.normal = &identity;
+    packet.lightIndices = lightIndices;
+    packet.lightCount = lightCount;
+
+    if (terrainMode == TerrainMode::Mesh) {
+        packet.program = main_shaders->get(variant);
+        if (!terrainMesh || !packet.program) return;
+        packet.vao = terrainMesh->vao();
+        packet.indexType = GL_UNSIGNED_SHORT;
+        for (const TerrainChunk& chunk : terrainMesh->chunks()) {
+            if (!frustum.intersectsBox(chunk.boundsMin, chunk.boundsMax)) continue;
+            // Nearest point of the chunk, so the one under the camera goes first
+            const glm::vec3 nearest = glm::clamp(camera.Position, chunk.boundsMin, chunk.boundsMax);
+            const float depth01 = glm::distance(camera.Position, nearest) / FAR_PLANE;
+            packet.key = RenderQueue::makeKey(RenderPass::Opaque, packet.program->sortId(), packet.material,
+                                              packet.vao, depth01);
+            packet.firstIndex = static_cast<GLsizei>(chunk.firstIndex);
+            packet.indexCount = static_cast<GLsizei>(chunk.indexCount);
+            packet.baseVertex = chunk.baseVertex;
+            renderQueue.push(packet);
+        }
+        return;
+    }
+
+    if (terrainMode == TerrainMode::Tessellation) {
+        packet.program = terrain_tess_shaders->get(variant);
+        if (!terrainTessPatches || terrainTessellation.empty() || !packet.program) return;
+        bindTerrainTextures();
+        glPatchParameteri(GL_PATCH_VERTICES, 4);
+
+        int framebufferWidth = 0, framebufferHeight = 0;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        const TerrainTessellationHeader header = terrainTessellation.header(
+            makeTerrainHeader(terrain, terrainLodSettings.textureTiling), static_cast<float>(framebufferHeight));
+        const auto& patches = terrainTessellation.patchHeights();
+        StreamingBuffer::Allocation alloc = frameStream->allocate(
+            static_cast<GLsizeiptr>(sizeof(header) + patches.size() * sizeof(glm::vec2)));
+        if (!alloc) return;
+        std::memcpy(alloc.data, &header, sizeof(header));
+        std::memcpy(static_cast<std::byte*>(alloc.data) + sizeof(header), patches.data(), patches.size() * sizeof(glm::vec2));
+
+        packet.primitive = GL_PATCHES;
+        packet.vao = terrainTessPatches->vao();
+        packet.indexCount = terrainTessPatches->indexCount();
+        packet.instanceBuffer = alloc.buffer;
+        packet.instanceOffset = alloc.offset;
+        packet.instanceSize = alloc.size;
+        packet.key = RenderQueue::makeKey(RenderPass::Opaque, packet.program->sortId(), packet.material, packet.vao, 0.0f);
+        renderQueue.push(packet);
+        return;
+    }
+
+    packet.program = terrain_shaders->get(variant);
+    if (!terrainPatch || terrainLod.empty() || !packet.program) return;
+    streamTerrain();
+    terrainLod.select(camera.Position, frustum);
+    bindTerrainTextures();
+
+    // One instanced draw per part, each with the header and its nodes in the frame stream
+    packet.vao = terrainPatch->vao();
+    packet.key = RenderQueue::makeKey(RenderPass::Opaque, packet.program->sortId(), packet.material, packet.vao, 0.0f);
+    for (int part = 0; part < TerrainLod::PART_COUNT; part++) {
+        const auto& nodes = terrainLod.selection(static_cast<TerrainLod::Part>(part));
+        if (nodes.empty()) continue;
+        const GLsizeiptr bytes = static_cast<GLsizeiptr>(sizeof(TerrainLodHeader) + nodes.size() * sizeof(TerrainLodNode));
+        StreamingBuffer::Allocation alloc = frameStream->allocate(bytes);
+        if (!alloc) return;
+        std::memcpy(alloc.data, &terrainLod.header(), sizeof(TerrainLodHeader));
+        std::memcpy(static_cast<std::byte*>(alloc.data) + sizeof(TerrainLodHeader), nodes.data(),
+                    nodes.size() * sizeof(TerrainLodNode));
+
+        packet.firstIndex = static_cast<GLsizei>(terrainLod.firstIndex(static_cast<TerrainLod::Part>(part)));
+        packet.indexCount = static_cast<GLsizei>(terrainLod.indexCount(static_cast<TerrainLod::Part>(part)));
+        packet.instanceCount = static_cast<GLsizei>(nodes.size());
+        packet.instanceBuffer = alloc.buffer;
+        packet.instanceOffset = alloc.offset;
+        packet.instanceSize = alloc.size;
+        renderQueue.push(packet);
+    }
+}
 
-    const float worldScale = 1.0f;
-    const float mazeElevation = 0.5f;
+MazeSettings App::resolveMazeSettings() const {
+    MazeSettings settings = mazeSettings;
+    if (settings.seed == 0) {
+        std::random_device rd;
+        settings.seed = (std::uint64_t(rd()) << 32) | rd();
+    }
+    return settings;
+}
 
-    mazeWalls.clear();
+void App::generateMaze() {
+    stagedMaze = std::make_unique<MazeBuild>();
+    stagedWalls = 0;
+    MazeBuild::build(*stagedMaze, mazeGenerator, resolveMazeSettings(), mazePlacement, mazeCrowdSettings(),
+                     crowd ? &crowd->pool() : nullptr);
+    updateMazeStaging(0.0);
+}
 
-    // Render all cells, including outer walls
-    for (int y = 0; y < mazeMap.rows; y++) {
-        for (int x = 0; x < mazeMap.cols; x++) {
-            uchar cell = getMapValue(x, y);
+void App::requestMaze() {
+    mazeBuilder.request(resolveMazeSettings(), mazePlacement, mazeCrowdSettings());
+}
 
-            // Only render walls, skip paths and openings
-            if (cell == '#') {
-                // Skip rendering the entrance and exit openings
-                bool isEntrance = (x == 0 && y == 1);
-                bool isExit = (x == mazeMap.cols-1 && y == mazeMap.rows-2);
+void App::updateMazeStaging(double budgetMs) {
+    WorkBudget budget(budgetMs);
 
-                if (!isEntrance && !isExit) {
-                    auto wall = std::make_unique<Model>("resources/objects/cube.obj", shader);
-                    if (wall->setTexture("resources/textures/box.jpg")) {
-                        wall->position = glm::vec3(
-                            (x - mazeWidth/2.0f) * worldScale,
-                            mazeElevation,
-                            (y - mazeHeight/2.0f) * worldScale
-                        );
-                        wall->scale = glm::vec3(worldScale);
-                        mazeWalls.push_back(std::move(wall));
-                    }
-                }
-            }
+    if (!stagedMaze) {
+        stagedMaze = mazeBuilder.takeResult();
+        stagedWalls = 0;
+    }
+    if (stagedMaze) {
+        const glm::vec3 scale(stagedMaze->placement.cellSize);
+        while (stagedWalls < stagedMaze->walls.size() && budget.more()) {
+            Entity wall = spawn(cubeModel, wallMaterial, stagedMaze->walls[stagedWalls++], scale, MazeWall{mazeId + 1});
+            scene.get<Renderable>(wall)->hidden = true;
+        }
+        if (stagedWalls == stagedMaze->walls.size()) {
+            swapMaze();
         }
     }
+
+    while (!retiredWalls.empty() && budget.more()) {
+        destroyEntity(retiredWalls.back());
+        retiredWalls.pop_back();
+    }
 }
 
-void App::genLabyrinth(cv::Mat& map) {
-    // Initialize with all walls
-    map.setTo('#');
+void App::startMazeStreaming() {
+    // Joins the old workers before anything they write to goes away
+    mazeStreamer.reset();
+    for (ChunkWalls& chunk : chunkWalls) {
+        for (Entity wall : chunk.walls) {
+            scene.get<Renderable>(wall)->hidden = true;
+            retiredWalls.push_back(wall);
+        }
+    }
+    chunkStaging.clear();
+
+    MazeStreamSettings settings = mazeStreamSettings;
+    settings.algorithm = mazeSettings.algorithm;
+    settings.seed = resolveMazeSettings().seed;
+    mazeSeed = settings.seed;
+    mazeStreamer = std::make_unique<MazeStreamer>(settings);
+    chunkWalls.assign(mazeStreamer->capacity(), ChunkWalls{});
+    collisionWindowDirty = true;
+}
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
+void App::updateMazeStreaming(double budgetMs, bool waitForChunks) {
+    WorkBudget budget(budgetMs);
+    const int side = mazeStreamer->chunkSide();
+    const glm::ivec2 focus = mazeStreamer->chunkOf(mazePositionOf(playerPosition));
+
+    // Every update() replaces the evicted and loaded lists, so each one is handled before
+    // the next. Waiting takes a second update() to collect what the first one queued.
+    for (int pass = 0; pass < (waitForChunks ? 2 : 1); pass++) {
+        if (pass > 0) mazeStreamer->finish();
+        mazeStreamer->update(focus);
+        takeStreamedChunks(focus);
+    }
 
-    // Start position (must be odd coordinates)
-    int startX = 1;
-    int startY = 1;
+    // Spawn walls of loaded chunks hidden, a chunk shows once all of its walls exist
+    const glm::vec3 scale(mazePlacement.cellSize);
+    while (!chunkStaging.empty()) {
+        const MazeStreamer::Slot slot = chunkStaging.front();
+        ChunkWalls& chunk = chunkWalls[slot];
+        const MazeGrid& grid = mazeStreamer->grid(slot);
+        const glm::ivec2 base = mazeStreamer->coord(slot) * side;
+        while (chunk.cursor < side * side && budget.more()) {
+            const int x = chunk.cursor % side, y = chunk.cursor / side;
+            chunk.cursor++;
+            if (!grid.isWall(x, y)) continue;
+            Entity wall = spawn(cubeModel, wallMaterial, mazeWorldPosition(base + glm::ivec2(x, y)), scale, MazeWall{mazeId});
+            scene.get<Renderable>(wall)->hidden = true;
+            chunk.walls.push_back(wall);
+        }
+        if (chunk.cursor < side * side) break;
 
-    std::stack<cv::Point> stack;
-    stack.push(cv::Point(startX, startY));
-    map.at<uchar>(startY, startX) = '.';
+        for (Entity wall : chunk.walls) {
+            scene.get<Renderable>(wall)->hidden = false;
+        }
+        chunk.cursor = -1;
+        chunkStaging.erase(chunkStaging.begin());
+    }
 
-    // Directions: up, right, down, left
-    const int dx[] = {0, 1, 0, -1};
-    const int dy[] = {-1, 0, 1, 0};
+    if (collisionWindowDirty || focus - 1 != collisionWindow) {
+        rebuildCollisionWindow(focus - 1);
+    }
 
-    while (!stack.empty()) {
-        cv::Point current = stack.top();
-        std::vector<int> directions = {0, 1, 2, 3};
-        std::shuffle(directions.begin(), directions.end(), gen);
+    while (!retiredWalls.empty() && budget.more()) {
+        destroyEntity(retiredWalls.back());
+        retiredWalls.pop_back();
+    }
+}
 
-        bool found = false;
-        for (int dir : directions) {
-            int nx = current.x + dx[dir] * 2;
-            int ny = current.y + dy[dir] * 2;
+void App::takeStreamedChunks(const glm::ivec2& focus) {
+    // Evicted chunks vanish now, their entities are destroyed over the next frames
+    for (MazeStreamer::Slot slot : mazeStreamer->evicted()) {
+        ChunkWalls& chunk = chunkWalls[slot];
+        for (Entity wall : chunk.walls) {
+            scene.get<Renderable>(wall)->hidden = true;
+            retiredWalls.push_back(wall);
+        }
+        chunk.walls.clear();
+        chunk.cursor = -1;
+        chunkStaging.erase(std::remove(chunkStaging.begin(), chunkStaging.end(), slot), chunkStaging.end());
+        collisionWindowDirty = true;
+    }
+    for (MazeStreamer::Slot slot : mazeStreamer->loaded()) {
+        chunkWalls[slot].cursor = 0;
+        chunkStaging.push_back(slot);
+        glm::ivec2 offset = glm::abs(mazeStreamer->coord(slot) - focus);
+        if (offset.x <= 1 && offset.y <= 1) collisionWindowDirty = true;
+    }
+}
 
-            if (nx >= 1 && nx < map.cols-1 && ny >= 1 && ny < map.rows-1 &&
-                map.at<uchar>(ny, nx) == '#') {
-                // Carve path
-                map.at<uchar>(current.y + dy[dir], current.x + dx[dir]) = '.';
-                map.at<uchar>(ny, nx) = '.';
-                stack.push(cv::Point(nx, ny));
-                found = true;
-                break;
+void App::rebuildCollisionWindow(const glm::ivec2& first) {
+    // 3x3 chunks of cells; chunks that aren't resident yet stay free
+    const int side = mazeStreamer->chunkSide();
+    const float cellSize = mazePlacement.cellSize;
+    collisionWorld.resetGrid(3 * side, 3 * side, (glm::vec2(first * side) - 0.5f) * cellSize, cellSize);
+    for (int cy = 0; cy < 3; cy++) {
+        for (int cx = 0; cx < 3; cx++) {
+            MazeStreamer::Slot slot;
+            if (!mazeStreamer->find(first + glm::ivec2(cx, cy), &slot)) continue;
+            const MazeGrid& grid = mazeStreamer->grid(slot);
+            for (int y = 0; y < side; y++) {
+                for (int x = 0; x < side; x++) {
+                    if (grid.isWall(x, y)) collisionWorld.setSolid(cx * side + x, cy * side + y, true);
                 }
+            }
         }
+    }
+    collisionWindow = first;
+    collisionWindowDirty = false;
+}
+
+// Streamed maze position (x, y) is centered on (x, y) * cellSize
+glm::ivec2 App::mazePositionOf(const glm::vec3& world) const {
+    return glm::ivec2(glm::round(glm::vec2(world.x, world.z) / mazePlacement.cellSize));
+}
+
+glm::vec3 App::mazeWorldPosition(const glm::ivec2& position) const {
+    return glm::vec3(position.x * mazePlacement.cellSize, mazePlacement.elevation, position.y * mazePlacement.cellSize);
+}
 
-        if (!found) {
-            stack.pop();
+void App::swapMaze() {
+    // One pass of flag flips, the costly spawning and destroying happen on other frames
+    const std::uint32_t next = mazeId + 1;
+    scene.each<MazeWall, Renderable>([&](Entity entity, const MazeWall& wall, Renderable& renderable) {
+        if (wall.maze == next) {
+            renderable.hidden = false;
+        } else if (wall.maze == mazeId) {
+            renderable.hidden = true;
+            retiredWalls.push_back(entity);
         }
+    });
+    mazeId = next;
+
+    MazeBuild& build = *stagedMaze;
+    collisionWorld.assignGrid(build.grid.width(), build.grid.height(), build.collisionOrigin,
+                              build.placement.cellSize, std::move(build.solid), build.walls.size());
+    mazeMap = std::move(build.grid);
+    mazeSeed = build.settings.seed;
+    mazeBuildMs = build.buildMs;
+
+    // The crowd's fields and positions belong to the old maze. The worker built new ones with
+    // the maze, unless the crowd size was changed (C) in the meantime.
+    CrowdSpawn spawn = std::move(build.crowd);
+    stagedMaze.reset();
+    resetCrowd(spawn.settings.agents == crowdSettings.agents ? &spawn : nullptr);
+}
+
+CrowdSettings App::mazeCrowdSettings() const {
+    CrowdSettings settings = crowdSettings;
+    if (!crowd || infiniteMaze) {
+        settings.agents = 0;
+    } else {
+        settings.threads = crowd->threads();
+    }
+    return settings;
+}
+
+void App::resetCrowd(CrowdSpawn* spawn) {
+    if (!crowd) return;
+    if (infiniteMaze || crowdSettings.agents == 0) {
+        crowd->clear();
+        crowdStream.reset();
+        return;
+    }
+
+    if (spawn) {
+        crowd->assign(mazeMap, std::move(*spawn));
+    } else {
+        crowd->reset(mazeMap, crowdSettings, mazeSeed);
+    }
+    // Instances are written in place, so each region holds the whole crowd
+    const GLsizeiptr bytes = static_cast<GLsizeiptr>(crowd->size() * sizeof(CrowdInstance));
+    if (!crowdStream || crowdStream->regionSize() < bytes) {
+        crowdStream = std::make_unique<StreamingBuffer>(bytes, 3);
+    }
+    std::cout << "Crowd: " << crowd->size() << " agents in " << crowd->groups() << " groups, fields built in "
+              << crowd->stats().fieldsMs << " ms\n";
+}
+
+void App::cycleCrowdSize() {
+    static constexpr size_t sizes[] = {0, 1000, 10000, 100000, 1000000};
+    auto next = std::upper_bound(std::begin(sizes), std::end(sizes), crowdSettings.agents);
+    crowdSettings.agents = next == std::end(sizes) ? 0 : *next;
+    if (infiniteMaze) {
+        std::cerr << "Warning: The crowd needs a fixed maze, it is off in infinite mode\n";
+        return;
     }
+    resetCrowd();
+}
 
-    // Create entrance and exit openings while maintaining outer walls
-    // Entrance (left side)
-    map.at<uchar>(1, 0) = '.';
-    // Exit (right side)
-    map.at<uchar>(map.rows-2, map.cols-1) = '.';
+void App::queueCrowd(float alpha, const int* lightIndices, int lightCount) {
+    if (!crowd || crowd->size() == 0 || !crowdStream || !crowdModel || crowdModel->meshes.empty()) return;
+
+    // GPU time of the draw from a few frames back, as far back as the stream's regions, so
+    // the result is in by now and reading it doesn't wait
+    const int slot = crowdTimerIndex;
+    crowdTimerIndex = (slot + 1) % static_cast<int>(crowdTimers.size());
+    if (crowdTimerPending[slot]) {
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(crowdTimers[slot][0], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(crowdTimers[slot][1], GL_QUERY_RESULT, &end);
+        crowdGpuMs = (end - begin) / 1.0e6;
+        crowdTimerPending[slot] = false;
+    }
 
-    // Mark start and exit positions
-    map.at<uchar>(1, 1) = 's';
-    map.at<uchar>(map.rows-2, map.cols-2) = 'e';
+    const GLsizeiptr bytes = static_cast<GLsizeiptr>(crowd->size() * sizeof(CrowdInstance));
+    StreamingBuffer::Allocation instances = crowdStream->allocate(bytes);
+    if (!instances) return;
+
+    const float cellSize = mazePlacement.cellSize;
+    CrowdPlacement placement;
+    placement.origin = -glm::vec2(mazeMap.width(), mazeMap.height()) / 2.0f * cellSize;
+    placement.cellSize = cellSize;
+    placement.height = mazePlacement.elevation + (crowd->settings().radius - 0.5f) * cellSize; // standing on the maze floor
+    placement.scale = crowd->settings().radius * cellSize / crowdModel->boundingRadius;
+    crowd->writeInstances(static_cast<CrowdInstance*>(instances.data), alpha, placement);
+
+    static const glm::mat4 identity(1.0f);
+    const Mesh& mesh = crowdModel->meshes.front();
+    const std::uint32_t variant = ShaderVariants::key(lightCount, true, materials->isAlphaTested(crowdMaterial));
+    DrawPacket packet;
+    packet.program = main_shaders->get(variant);
+    packet.vao = mesh.vao();
+    packet.indexCount = mesh.indexCount();
+    packet.material = crowdMaterial;
+    packet.world = &identity;
+    packet.normal = &identity;
+    packet.lightIndices = lightIndices;
+    packet.lightCount = lightCount;
+    packet.instanceCount = static_cast<GLsizei>(crowd->size());
+    packet.instanceBuffer = instances.buffer;
+    packet.instanceOffset = instances.offset;
+    packet.instanceSize = instances.size;
+    packet.timestamps = crowdTimers[slot];
+    packet.key = RenderQueue::makeKey(RenderPass::Opaque, packet.program->sortId(), packet.material, packet.vao, 0.0f);
+    if (!packet.program) return;
+    renderQueue.push(packet);
+    crowdTimerPending[slot] = true;
 }
 
 void App::updateProjection() {
@@ -715,7 +1568,7 @@ void App::updateProjection() {
     glfwGetWindowSize(window, &width, &height);
     projection = glm::perspective(glm::radians(camera.Zoom),
                                 static_cast<float>(width)/static_cast<float>(height),
-                                0.1f, 1000.0f);
+                                NEAR_PLANE, FAR_PLANE);
 }
 
 void App::initImGUI() {
@@ -757,14 +1610,156 @@ void App::renderImGUI() {
                camera.Position.x, camera.Position.y, camera.Position.z);
     ImGui::Text("Facing: (%.1f, %.1f, %.1f)",
                camera.Front.x, camera.Front.y, camera.Front.z);
-    ImGui::Text("Maze Size: %dx%d", mazeMap.cols, mazeMap.rows);
-    ImGui::Text("Walls: %zu", mazeWalls.size());
+    glm::vec3 groundNormal = terrain.normal(camera.Position.x, camera.Position.z);
+    ImGui::Text("Ground: %.2f, normal (%.2f, %.2f, %.2f)%s",
+               getTerrainHeight(camera.Position.x, camera.Position.z),
+               groundNormal.x, groundNormal.y, groundNormal.z, isOnGround() ? "" : " (airborne)");
+    float pickDistance;
+    if (terrain.raycast(camera.Position, camera.Front, FAR_PLANE, &pickDistance)) {
+        glm::vec3 pick = camera.Position + camera.Front * pickDistance;
+        ImGui::Text("Looking at terrain: (%.1f, %.1f, %.1f), %.1f away", pick.x, pick.y, pick.z, pickDistance);
+    }
+    ImGui::Text("Simulation: %.0f Hz, %d step(s) this frame, alpha %.2f, %.2f s dropped",
+               simulationClock.rate(), simulationClock.lastSteps(), simulationClock.alpha(),
+               simulationClock.droppedSeconds());
+    if (benchmark.enabled) {
+        ImGui::Text("Benchmark: frame %d/%d (%d warmup), path %.1f/%.1f s", benchmarkFrame,
+                    benchmark.warmup + benchmark.frames, benchmark.warmup, cameraPathTime, cameraPath.duration());
+    } else if (recordingPath) {
+        ImGui::Text("Recording camera path: %zu keys, %.1f s (F9 stops)", recordedPath.size(), recordTime);
+    }
+    if (mazeStreamer) {
+        ImGui::Text("Maze: infinite (%s, seed %llu), %zu/%zu chunks resident, %zu building, %zu bytes",
+                   mazeAlgorithmName(mazeSettings.algorithm), static_cast<unsigned long long>(mazeSeed),
+                   mazeStreamer->residentCount(), mazeStreamer->capacity(), mazeStreamer->pendingCount(),
+                   mazeStreamer->bytes());
+    } else {
+        ImGui::Text("Maze Size: %dx%d (%s, seed %llu, %zu bytes, built in %.1f ms)", mazeMap.width(), mazeMap.height(),
+                   mazeAlgorithmName(mazeSettings.algorithm), static_cast<unsigned long long>(mazeSeed), mazeMap.bytes(),
+                   mazeBuildMs);
+    }
+    if (stagedMaze) {
+        ImGui::Text("Next maze: staging %zu/%zu walls", stagedWalls, stagedMaze->walls.size());
+    } else if (mazeBuilder.busy()) {
+        ImGui::Text("Next maze: building");
+    }
+    if (!retiredWalls.empty()) {
+        ImGui::Text("Old maze: %zu walls left to remove", retiredWalls.size());
+    }
+    ImGui::Text("Walls: %zu (%zu solid cells, %zu dynamic colliders)", scene.count<MazeWall>(),
+               collisionWorld.solidCount(), collisionWorld.bodies().size());
+    if (terrainMode == TerrainMode::Cdlod) {
+        ImGui::Text("Terrain: CDLOD, %zu nodes (%zu culled), %d levels, %zu triangles (T switches)",
+                    terrainLod.selectedCount(), terrainLod.culledCount(), terrainLod.levelCount(), terrainLod.triangleCount());
+        if (terrainTileCache) {
+            ImGui::Text("  tiles %dx%d: %zu resident, %zu loading, %.1f MB cache; height queries %zu hit, %zu paged in",
+                        terrainTiles->tilesX(), terrainTiles->tilesZ(), terrainTileCache->residentCount(),
+                        terrainTileCache->pendingCount(), terrainTileCache->bytes() / (1024.0 * 1024.0),
+                        terrainTileCache->hits(), terrainTileCache->misses());
+        }
+    } else if (terrainMode == TerrainMode::Tessellation) {
+        ImGui::Text("Terrain: tessellated, %zu patches of %d cells, %.0f px edges (T switches)",
+                    terrainTessellation.patchCount(), terrainTessSettings.patchCells, terrainTessSettings.edgePixels);
+    } else {
+        ImGui::Text("Terrain: mesh, %zu triangles in %zu chunks, %.1f MB (T switches)",
+                    terrainMesh ? terrainMesh->triangleCount() : 0, terrainMesh ? terrainMesh->chunks().size() : 0,
+                    terrainMesh ? terrainMesh->bytes() / (1024.0 * 1024.0) : 0.0);
+    }
+    if (crowd && crowd->size() > 0) {
+        const auto& crowdStats = crowd->stats();
+        ImGui::Text("Crowd: %zu agents, %d groups, %d threads (C cycles)", crowd->size(), crowd->groups(), crowd->threads());
+        ImGui::Text("  update %.2f ms/step, instances %.2f ms (%.1f MB), GPU draw %.2f ms", crowdStats.updateMs,
+                    crowdStats.instanceMs, crowd->size() * sizeof(CrowdInstance) / (1024.0 * 1024.0), crowdGpuMs);
+    }
+    ImGui::Text("Entities: %zu (%zu visible, %zu archetypes)", scene.size(), visibleEntities, scene.archetypeCount());
+    ImGui::Text("Transforms: %zu (%zu updated)", transforms.size(), transforms.lastUpdateCount());
+    const auto& queue = renderQueue.stats();
+    ImGui::Text("Draws: %zu, state changes saved: %zu", queue.packets, queue.saved());
+    ImGui::Text("  program %zu/%zu, VAO %zu/%zu, uniforms %zu/%zu (issued/skipped)",
+               queue.programBinds, queue.programSkipped, queue.vaoBinds, queue.vaoSkipped,
+               queue.uniformUploads, queue.uniformSkipped);
+    ImGui::Text("Materials: %zu in %zu texture arrays (%zu layers)",
+               materials->size(), materials->arrayCount(), materials->layerCount());
+    ImGui::Separator();
+    ImGui::Text("Heap allocations/frame: %llu (peak %llu)",
+               static_cast<unsigned long long>(AllocationCounter::lastFrame()),
+               static_cast<unsigned long long>(AllocationCounter::peakFrame()));
+    ImGui::Text("Frame arena: %zu / %zu KB", frameArena.bytesUsed() / 1024, frameArena.capacity() / 1024);
+    const auto& stream = frameStream->stats();
+    ImGui::Text("Stream buffer: %lld / %lld KB x%d",
+               static_cast<long long>(stream.bytesThisFrame / 1024),
+               static_cast<long long>(frameStream->regionSize() / 1024), frameStream->regionCount());
+    ImGui::Text("Stream stalls: %llu (last %.2f ms)", stream.totalStalls, stream.lastStallMs);
     ImGui::End();
 
+    renderProfiler();
+
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
 
+void App::renderProfiler() {
+    ImGui::Begin("Profiler");
+    bool enabled = profiler->enabled();
+    if (ImGui::Checkbox("Enabled", &enabled)) profiler->setEnabled(enabled);
+    ImGui::SameLine();
+    bool tracing = Trace::enabled();
+    if (ImGui::Checkbox("Record trace", &tracing)) Trace::setEnabled(tracing);
+    ImGui::SameLine();
+    ImGui::Text("%zu events (%zu dropped), F10 writes %s", Trace::eventCount(), Trace::droppedCount(),
+                traceOutput.c_str());
+
+    // Frame time graphs over the last TimingHistory::SIZE frames
+    auto graph = [](const char* label, const char* what, const TimingHistory& history) {
+        char overlay[96];
+        std::snprintf(overlay, sizeof(overlay), "%s %.2f ms (avg %.2f, max %.2f)", what, history.latest(),
+                      history.average(), history.max());
+        ImGui::PlotLines(label, history.values(), history.count(), history.offset(), overlay, 0.0f,
+                         std::max(history.max() * 1.1f, 1.0f), ImVec2(0.0f, 60.0f));
+    };
+    graph("##cpu frame", "CPU frame", profiler->frameCpuMs());
+    graph("##gpu frame", "GPU frame", profiler->frameGpuMs());
+    ImGui::Text("GPU results two frames back, %zu scopes skipped waiting for one", profiler->gpuSkipped());
+
+    const ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit;
+    if (ImGui::BeginTable("scopes", 7, flags)) {
+        ImGui::TableSetupColumn("Scope");
+        ImGui::TableSetupColumn("Calls");
+        ImGui::TableSetupColumn("CPU ms");
+        ImGui::TableSetupColumn("CPU max");
+        ImGui::TableSetupColumn("GPU ms");
+        ImGui::TableSetupColumn("GPU max");
+        ImGui::TableSetupColumn("History");
+        ImGui::TableHeadersRow();
+
+        const auto& scopes = profiler->scopes();
+        for (size_t i = 0; i < scopes.size(); i++) {
+            const Profiler::Scope& scope = scopes[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%*s%s", scope.depth * 2, "", scope.name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", scope.calls);
+            auto timings = [](bool used, const TimingHistory& history) {
+                ImGui::TableNextColumn();
+                if (used) ImGui::Text("%.3f", history.average()); else ImGui::TextUnformatted("-");
+                ImGui::TableNextColumn();
+                if (used) ImGui::Text("%.3f", history.max()); else ImGui::TextUnformatted("-");
+            };
+            timings(scope.cpu, scope.cpuMs);
+            timings(scope.gpu, scope.gpuMs);
+            ImGui::TableNextColumn();
+            const TimingHistory& history = scope.cpu ? scope.cpuMs : scope.gpuMs;
+            ImGui::PushID(static_cast<int>(i));
+            ImGui::PlotLines("##history", history.values(), history.count(), history.offset(), nullptr, 0.0f,
+                             std::max(history.max(), 0.01f), ImVec2(120.0f, 0.0f));
+            ImGui::PopID();
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
 void App::shutdownImGUI() {
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -801,6 +1796,7 @@ void App::mouseButtonCallback(GLFWwindow* window, int button, int action, int mo
 void App::mouseCallback(GLFWwindow* window, double xpos, double ypos) {
     App* app = static_cast<App*>(glfwGetWindowUserPointer(window));
     if (!app || app->isMouseVisible) return;  // Only process when mouse is invisible
+    if (app->benchmark.enabled) return;        // The camera path has the camera
 
     if (app->firstMouse) {
         app->lastX = xpos;
@@ -849,6 +1845,9 @@ void App::keyCallback(GLFWwindow* window, int key, int scancode, int action, int
         }
     }
 
+    // A benchmark only takes ESC, anything else would change what it measures
+    if (app->benchmark.enabled && key != GLFW_KEY_ESCAPE) return;
+
     if (action == GLFW_PRESS || action == GLFW_REPEAT) {
         switch (key) {
         case GLFW_KEY_ESCAPE:
@@ -860,8 +1859,18 @@ void App::keyCallback(GLFWwindow* window, int key, int scancode, int action, int
             std::cout << "VSync " << (app->vsyncOn ? "enabled" : "disabled") << "\n";
             break;
         case GLFW_KEY_R:
-            app->generateMaze(app->main_shader);
-            std::cout << "Regenerated maze\n";
+            if (app->mazeStreamer) {
+                app->startMazeStreaming();
+            } else {
+                app->requestMaze();
+            }
+            std::cout << "Regenerating maze\n";
+            break;
+        case GLFW_KEY_C:
+            if (action == GLFW_PRESS) app->cycleCrowdSize();
+            break;
+        case GLFW_KEY_T:
+            if (action == GLFW_PRESS) app->cycleTerrainMode();
             break;
         case GLFW_KEY_F1:
             app->antialiasingEnabled = !app->antialiasingEnabled;
@@ -879,6 +1888,12 @@ void App::keyCallback(GLFWwindow* window, int key, int scancode, int action, int
         case GLFW_KEY_F11:  // Add this case for fullscreen toggle
             app->toggleFullscreen();
             break;
+        case GLFW_KEY_F9:
+            if (action == GLFW_PRESS) app->toggleCameraRecording();
+            break;
+        case GLFW_KEY_F10:
+            if (action == GLFW_PRESS) Trace::write(app->traceOutput);
+            break;
         }
     }
 }
@@ -972,85 +1987,40 @@ void App::processInput(GLFWwindow* window, float deltaTime) {
         moveDir = glm::normalize(moveDir);
         glm::vec3 velocity = moveDir * 2.5f * deltaTime;
 
-        glm::vec3 newPosition = camera.Position + velocity;
-        if (!checkWallCollision(newPosition, {})) {
-            camera.Position = newPosition;
-        } else {
-            // Get collision normal
-            glm::vec3 collisionNormal(0.0f);
-            glm::vec3 testPos = camera.Position + glm::vec3(velocity.x, 0, 0);
-            if (checkWallCollision(testPos, {})) collisionNormal.x = 1.0f;
-
-            testPos = camera.Position + glm::vec3(0, 0, velocity.z);
-            if (checkWallCollision(testPos, {})) collisionNormal.z = 1.0f;
-
-            // Calculate slide direction
-            if (glm::length(collisionNormal) > 0.0f) {
-                collisionNormal = glm::normalize(collisionNormal);
-                glm::vec3 slideVelocity = velocity - collisionNormal * glm::dot(velocity, collisionNormal);
-
-                // Slide movement
-                newPosition = camera.Position + slideVelocity;
-                if (!checkWallCollision(newPosition, {})) {
-                    camera.Position = newPosition;
-                }
-            }
-        }
-
-        camera.Position.y = playerHeight;
-        lastSafePosition = camera.Position;
+        // One swept move: stops at walls and slides along them, however long the frame was
+        playerPosition = resolveWallCollision(playerPosition, velocity);
+        playerPosition.y = getTerrainHeight(playerPosition.x, playerPosition.z) + playerHeight;
+        lastSafePosition = playerPosition;
     }
 }
 
+float App::getTerrainHeight(float worldX, float worldZ) const {
+    // Tiled terrains answer from the resident tiles, paging in any others on demand
+    if (terrainTileCache) return terrainTileCache->height(worldX, worldZ);
+    return terrain.height(worldX, worldZ);
+}
+
+bool App::isOnGround() const {
+    const float tolerance = 0.01f;
+    return playerPosition.y - playerHeight <= getTerrainHeight(playerPosition.x, playerPosition.z) + tolerance;
+}
+
 bool App::checkWallCollision(const glm::vec3& position, glm::vec3* normal) const {
-    const float wallHalfSize = 0.5f;
-    const float playerRadius = 0.3f;
-    const float maxDist = playerRadius + wallHalfSize;
-    bool collision = false;
-
-    auto checkObject = [&](const glm::vec3& objPos) -> bool {
-        if (glm::distance(glm::vec2(position.x, position.z),
-                         glm::vec2(objPos.x, objPos.z)) > maxDist * 1.5f) {
-            return false;
-                         }
-
-        // Precise collision check
-        float overlapX = maxDist - abs(position.x - objPos.x);
-        float overlapZ = maxDist - abs(position.z - objPos.z);
-
-        if (overlapX > 0 && overlapZ > 0) {
-            if (normal) {
-                if (overlapX < overlapZ) {
-                    *normal = glm::vec3((position.x < objPos.x) ? -1.0f : 1.0f, 0.0f, 0.0f);
-                } else {
-                    *normal = glm::vec3(0.0f, 0.0f, (position.z < objPos.z) ? -1.0f : 1.0f);
-                }
-            }
-            return true;
-        }
+    // Only the cells and hash buckets around the player are looked at, whatever the maze size
+    CollisionHit hit;
+    if (!collisionWorld.overlapCircle(glm::vec2(position.x, position.z), playerRadius, &hit)) {
         return false;
-    };
-
-    // Check maze walls
-    for (const auto& wall : mazeWalls) {
-        if (checkObject(wall->position)) {
-            return true;
-        }
     }
-
-    // Check transparent objects - only those that should block movement
-    for (const auto& obj : transparentObjects) {
-        // Skip water and lava by checking animatedTextures
-        if (obj->hasAnimatedTexture()) {
-            continue; // Skip water and lava
-        }
-
-        if (checkObject(obj->position)) {
-            return true;
-        }
+    if (normal) {
+        *normal = glm::vec3(hit.normal.x, 0.0f, hit.normal.y);
     }
+    return true;
+}
 
-    return false;
+glm::vec3 App::resolveWallCollision(const glm::vec3& position, const glm::vec3& velocity) {
+    glm::vec2 moved = collisionWorld.moveCircle(glm::vec2(position.x, position.z), playerRadius,
+                                                glm::vec2(velocity.x, velocity.z));
+    return glm::vec3(moved.x, position.y, moved.y);
 }
 
 void App::toggleFullscreen() {
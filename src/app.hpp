@@ -13,11 +13,33 @@
 #include <iostream>
 #include <fstream>
 #include <chrono>
+#include <algorithm>
 #include "Camera.hpp"
 #include <nlohmann/json.hpp>
 #include "assets.hpp"
 #include "ShaderProgram.hpp"
 #include "Model.hpp"
+#include "FrameArena.hpp"
+#include "AllocationCounter.hpp"
+#include "StreamingBuffer.hpp"
+#include "FrameUniforms.hpp"
+#include "SceneComponents.hpp"
+#include "RenderQueue.hpp"
+#include "MaterialTable.hpp"
+#include "CollisionWorld.hpp"
+#include "TerrainQuery.hpp"
+#include "FixedTimestep.hpp"
+#include "MazeBuilder.hpp"
+#include "MazeStreamer.hpp"
+#include "Crowd.hpp"
+#include "TerrainLod.hpp"
+#include "TerrainTessellation.hpp"
+#include "TerrainMesh.hpp"
+#include "TerrainTileCache.hpp"
+#include "OffscreenTarget.hpp"
+#include "Benchmark.hpp"
+#include "Profiler.hpp"
+#include "Trace.hpp"
 
 
 class App {
@@ -27,16 +49,34 @@ public:
 
 
     void init_assets();
-    bool init();
+    // Command line options override app_settings.json:
+    //   --headless[=egl|osmesa]  render offscreen without a display
+    //   --frames N               headless frames to render before exiting, 0 = until killed;
+    //                            with --benchmark, the frames measured after the warmup
+    //   --output FILE            image of the last headless frame
+    //   --benchmark              play the camera path and write a frame time report
+    //   --seed N                 benchmark maze seed
+    //   --path FILE              benchmark camera path, instead of orbiting the maze
+    //   --report FILE            benchmark report
+    //   --trace                  record a Chrome trace, written on exit and with F10
+    //   --trace-output FILE      where the trace goes
+    bool init(int argc = 0, char** argv = nullptr);
     void updateFPS(int& frameCount, std::chrono::steady_clock::time_point& lastTime);
     void updateAnimations(float deltaTime);
+    // One fixed simulation step: input, lights, animations
+    void simulate(float step);
+    // Sets the rendered state between the last two simulation steps (alpha 0 = previous)
+    void applyInterpolation(float alpha);
     int run();
     void render();
     void checkBoundaries();
+    // Whether the player's feet are at (or below) the terrain surface
     bool isOnGround() const;
     float getTerrainHeight(float worldX, float worldZ) const;
     bool checkWallCollision(const glm::vec3& position, glm::vec3* normal = nullptr) const;
     void toggleFullscreen();
+    // Moves the player by velocity (this frame's displacement) on the XZ plane, stopping at
+    // walls and sliding along them; y is kept
     glm::vec3 resolveWallCollision(const glm::vec3& position, const glm::vec3& velocity);
     static void printGLInfo(GLenum, const std::string&);
 
@@ -52,18 +92,60 @@ public:
     void processInput(GLFWwindow* window, float deltaTime);
     void updateProjection();
 
-    cv::Mat mazeMap;
-    std::vector<std::unique_ptr<Model>> mazeWalls;
-    std::vector<std::unique_ptr<Model>> levelObjects;
-    std::unique_ptr<Model> mazeFloor;
-    void genLabyrinth(cv::Mat& map);
+    TransformStore transforms;
+
+    // Shared mesh/material assets, referenced by the scene's Renderable components
+    std::vector<std::unique_ptr<Model>> modelAssets;
+    Model* cubeModel = nullptr;
+
+    // Material of every scene entity and the terrain, one GPU table
+    std::unique_ptr<MaterialTable> materials;
+    MaterialTable::Id wallMaterial = 0;
+    MaterialTable::Id terrainMaterial = 0;
+
+    // Every drawable object in the level is an entity with a Transform and a Renderable
+    Scene scene;
+    Entity sunEntity;
+
+    Model* addModelAsset(const std::filesystem::path& path);
+
+    // Creates an entity drawing the model at the given placement, plus any extra components
+    template <typename... Extra>
+    Entity spawn(Model* model, MaterialTable::Id material, const glm::vec3& position, const glm::vec3& scale,
+                 Extra... extra) {
+        Transform transform{transforms.create(position, glm::vec3(0.0f), scale)};
+        float radius = model->boundingRadius * std::max({scale.x, scale.y, scale.z});
+        return scene.create(transform, Renderable{model, material, radius}, LightSet{}, std::move(extra)...);
+    }
+    void destroyEntity(Entity entity);
+    // Registers an axis aligned box of the given placement with the collision world
+    Collider makeCollider(const glm::vec3& position, const glm::vec3& scale);
+
+    // Bit-packed maze, regenerated from mazeSettings; a seed of 0 picks a new one each time
+    MazeGrid mazeMap;
+    MazeGenerator mazeGenerator;
+    MazeSettings mazeSettings;
+    MazePlacement mazePlacement;
+    std::uint64_t mazeSeed = 0; // seed of the current maze
+    double mazeBuildMs = 0.0;   // how long building it took
 
     // Maze generation methods
-    void generateMaze(std::shared_ptr<ShaderProgram> shader);
+    // Builds and shows a maze right away, for startup
+    void generateMaze();
+    // Builds a maze on the worker thread, it replaces the current one once staged
+    void requestMaze();
+    // Infinite mode: drops the current chunks and streams a maze with a new seed
+    void startMazeStreaming();
+    // Respawns the crowd on the current maze with crowdSettings (none in infinite mode), or
+    // takes over spawn when it was built along with the maze
+    void resetCrowd(CrowdSpawn* spawn = nullptr);
+    // crowdSettings as the maze worker builds them with the next maze
+    CrowdSettings mazeCrowdSettings() const;
+    // Next crowd size of the stress test steps (0, 1k, 10k, 100k, 1M)
+    void cycleCrowdSize();
+    // Next terrain rendering mode
+    void cycleTerrainMode();
     void generateTerrain();
-    uchar getMapValue(int x, int y) const;
-
-    std::unique_ptr<Model> sphereObject;
 
     bool isMouseVisible = false;
     bool altPressed = false;
@@ -74,46 +156,219 @@ private:
     // Physics/Collision variables
     float playerHeight = 1.62f; // Player height in world units
     float playerRadius = 0.3f; // Player collision radius
+    glm::vec3 playerPosition;         // Simulated feet + eye height, the camera shows it interpolated
+    glm::vec3 previousPlayerPosition; // at the step before
     glm::vec3 lastSafePosition; // Last safe position (no collisions)
-    cv::Mat heightData;
+    // Maze cells as a solid grid plus a spatial hash of the other colliders
+    CollisionWorld collisionWorld;
+    // CPU copy of the heightmap for height, normal and ray queries
+    TerrainQuery terrain;
 
     //light
     DirLight sun;
     std::vector<PointLight> pointLights;
     SpotLight flashlight;
+    std::array<float, MAX_POINT_LIGHTS> pointLightRanges{};
+
+    // Simulated light animation, rendered interpolated like everything else
+    float sunAngle = 0.0f, previousSunAngle = 0.0f;
+    float lightPulse = 0.0f, previousLightPulse = 0.0f;
 
     void setupLights();
     void updateLights(float deltaTime);
+    // Derives the sun, flashlight and point light parameters from the light animation state
+    void setLightState(float angle, float pulse);
+    // Fills lights with the point lights reaching the bounding sphere, picking the shader light tier
+    void assignPointLights(const glm::vec3& position, float radius, LightSet& lights) const;
 
-    Model* spinningGlassCube = nullptr;
     glm::vec3 cubeRotationSpeed = glm::vec3(50.0f, 100.0f, 80.0f);
 
     //cam
     Camera camera;
     glm::mat4 projection;
+    static constexpr float NEAR_PLANE = 0.1f;
+    static constexpr float FAR_PLANE = 1000.0f;
     float lastX = 0, lastY = 0;
     bool firstMouse = true;
     float deltaTime = 0.0f;
 
+    // Simulation runs at a fixed rate (app_settings.json "simulation"), rendering as fast as
+    // it can or capped to maxFrameRate ("max_fps", 0 = no cap)
+    FixedTimestep simulationClock;
+    double maxFrameRate = 0.0;
+
+    // Scratch memory rebuilt every frame (render queue, terrain node selection), reset at the
+    // top of the frame. Collision queries walk cells in place and need none.
+    FrameArena frameArena;
+
+    // CPU and GPU timings of the frame's stages and render passes, shown in the Profiler window
+    std::unique_ptr<Profiler> profiler;
+    // Chrome trace of frames, loading and worker threads ("tracing" in app_settings.json)
+    std::string traceOutput = "trace.json";
+
     // Window and rendering
     GLFWwindow* window = nullptr;
     bool vsyncOn = true;
 
+    // Headless mode: GLFW's null platform with an EGL (surfaceless) or OSMesa context and an
+    // invisible window, render() drawing into an offscreen framebuffer. Everything else,
+    // the frame loop included, runs unchanged.
+    struct HeadlessSettings {
+        bool enabled = false;
+        std::string backend = "egl"; // or "osmesa"
+        int frames = 600;
+        std::string output;
+    };
+    HeadlessSettings headless;
+    std::unique_ptr<OffscreenTarget> offscreen;
+    int headlessFrame = 0;
+    void parseCommandLine(int argc, char** argv);
+    void saveOffscreenFrame(const std::string& path);
+
+    // Benchmark mode: a fixed maze seed, the camera played back along a path instead of
+    // processInput, the same simulated time every frame, and after warmup + frames a JSON
+    // report of CPU and GPU frame times, draw calls and triangles. Streamed maze chunks and
+    // terrain tiles are waited for, so every run draws the same frames.
+    struct BenchmarkSettings {
+        bool enabled = false;
+        std::uint64_t seed = 1;
+        int frames = 1000;
+        int warmup = 60;               // frames rendered before measuring starts
+        double frameStep = 1.0 / 60.0; // simulated seconds per frame
+        std::string path;              // camera path JSON, empty = orbit around the maze
+        std::string report = "benchmark_report.json";
+    };
+    // GPU timestamps around render() and the primitives it generated, read back a few
+    // frames later so the measurement never waits on the GPU
+    struct FrameQueries {
+        GLuint begin = 0, end = 0, primitives = 0;
+        int frame = -1; // benchmark frame measured, -1 while free
+    };
+    BenchmarkSettings benchmark;
+    CameraPath cameraPath;
+    float cameraPathTime = 0.0f;
+    int benchmarkFrame = 0;
+    std::vector<FrameSample> benchmarkSamples;
+    std::array<FrameQueries, 4> frameQueries{};
+    void initBenchmark();
+    // One full turn around the maze over the benchmark's frames, looking at its center
+    CameraPath orbitCameraPath() const;
+    void followCameraPath(float step);
+    void beginFrameQueries();
+    void endFrameQueries();
+    void collectFrameQueries(FrameQueries& queries);
+    // Records the frame that just ended; writes the report and closes the window after the last
+    void endBenchmarkFrame(double cpuMs);
+    void writeBenchmarkReport();
+
+    // F9 records the camera's path while playing, for the benchmark to replay
+    bool recordingPath = false;
+    CameraPath recordedPath;
+    float recordTime = 0.0f;
+    void toggleCameraRecording();
+    void recordCameraKey(float step);
+
     glm::vec3 sunWorldPosition;
 
     // Resources
-    std::shared_ptr<ShaderProgram> main_shader;
+    std::shared_ptr<ShaderVariants> main_shaders;
+
+    // Ring of per-frame dynamic data (camera/light uniform blocks, ...)
+    std::unique_ptr<StreamingBuffer> frameStream;
+
+    GLuint heightMapTexture = 0;
+
+    // Tiled terrain ("tiles" in the "terrain" settings): the heightfield stays on disk and
+    // memory-mapped, the tiles around the camera are paged into terrainTileCache and its
+    // window texture, heightMapTexture is the file's overview and terrain is built from that
+    // for the coarse queries (normals, ray casts). Only the CDLOD mode draws it.
+    std::string terrainTilesPath;
+    int terrainTileRadius = 4;
+    std::unique_ptr<TerrainTiles> terrainTiles;
+    std::unique_ptr<TerrainTileCache> terrainTileCache;
+    GLuint terrainWindowTexture = 0;
+    void initTerrainTiles();
+    void streamTerrain();
+    void bindTerrainTextures();
 
-    std::unique_ptr<Mesh> heightMapMesh;
-    GLuint heightMapTexture;
-    std::shared_ptr<Texture> surfaceTexture;
+    // How the terrain is drawn ("terrain" in app_settings.json, T switches):
+    //   Mesh          - terrainMesh, the whole heightmap at a fixed step in culled chunks
+    //   Cdlod         - one patch instanced over TerrainLod's quadtree nodes, displaced on the GPU
+    //   Tessellation  - coarse patches subdivided by the tessellation stages to the screen
+    enum class TerrainMode { Mesh, Cdlod, Tessellation };
+    TerrainMode terrainMode = TerrainMode::Cdlod;
+    TerrainMeshSettings terrainMeshSettings;
+    std::unique_ptr<TerrainMesh> terrainMesh;
+    TerrainLodSettings terrainLodSettings;
+    TerrainLod terrainLod{&frameArena}; // node selection is rebuilt every frame
+    std::unique_ptr<Mesh> terrainPatch;
+    std::shared_ptr<ShaderVariants> terrain_shaders; // terrain.vert with basic.frag
+    TerrainTessellationSettings terrainTessSettings;
+    TerrainTessellation terrainTessellation;
+    std::unique_ptr<Mesh> terrainTessPatches;
+    std::shared_ptr<ShaderVariants> terrain_tess_shaders; // terrain_tess.vert, terrain.tesc/.tese, basic.frag
+    void setTerrainMode(TerrainMode mode);
+    void queueTerrain(const Frustum& frustum, const int* lightIndices, int lightCount);
 
     void initHeightMap();
     GLuint loadHeightMapTexture(const cv::Mat& heightMap);
-    std::unique_ptr<Mesh> generateHeightMap(const cv::Mat& heightMap, unsigned int stepSize);
 
-    //Transparency
-    std::vector<std::unique_ptr<Model>> transparentObjects; // For storing transparent objects
+    // Entities that passed frustum culling last frame, for the debug overlay
+    size_t visibleEntities = 0;
+
+    // Background maze regeneration: the worker builds the maze, then its walls are spawned
+    // hidden over as many frames as the budget needs, shown all at once, and the old walls
+    // are destroyed over the following frames
+    MazeBuilder mazeBuilder;
+    std::unique_ptr<MazeBuild> stagedMaze;
+    size_t stagedWalls = 0;         // walls of stagedMaze spawned so far
+    std::uint32_t mazeId = 0;       // MazeWall::maze of the shown walls
+    std::vector<Entity> retiredWalls;
+    double mazeStagingBudgetMs = 1.0; // per frame, 0 = unlimited
+    MazeSettings resolveMazeSettings() const;
+    void updateMazeStaging(double budgetMs);
+    void swapMaze();
+
+    // Infinite maze: chunks streamed around the player instead of one fixed maze. Walls
+    // are spawned per chunk like a staged maze and shown once the chunk is complete.
+    // Collision covers the 3x3 chunks around the player.
+    struct ChunkWalls {
+        std::vector<Entity> walls;
+        int cursor = -1; // next grid position to spawn, -1 once the chunk is shown
+    };
+    bool infiniteMaze = false;
+    MazeStreamSettings mazeStreamSettings;
+    std::unique_ptr<MazeStreamer> mazeStreamer;
+    std::vector<ChunkWalls> chunkWalls;             // per streamer slot
+    std::vector<MazeStreamer::Slot> chunkStaging;   // chunks whose walls are being spawned
+    glm::ivec2 collisionWindow = glm::ivec2(0);     // first chunk of the collision grid
+    bool collisionWindowDirty = true;
+    // waitForChunks blocks until every chunk the focus needs is built, so they all stage this call
+    void updateMazeStreaming(double budgetMs, bool waitForChunks = false);
+    // Lets go of the chunks the last update() evicted and queues the ones it loaded for staging
+    void takeStreamedChunks(const glm::ivec2& focus);
+    void rebuildCollisionWindow(const glm::ivec2& first);
+    glm::ivec2 mazePositionOf(const glm::vec3& world) const;
+    glm::vec3 mazeWorldPosition(const glm::ivec2& position) const;
+
+    // Crowd stress mode ("crowd" in app_settings.json, C cycles the size): agents walking
+    // the fixed maze, drawn as one instanced sphere draw. Instance data is written straight
+    // into its own ring buffer every frame, and a timer query ring measures the draw.
+    CrowdSettings crowdSettings;
+    std::unique_ptr<Crowd> crowd;
+    std::unique_ptr<StreamingBuffer> crowdStream;
+    Model* crowdModel = nullptr;
+    MaterialTable::Id crowdMaterial = 0;
+    std::array<std::array<GLuint, 2>, 3> crowdTimers{}; // GL_TIMESTAMP pairs
+    std::array<bool, 3> crowdTimerPending{};
+    int crowdTimerIndex = 0;
+    double crowdGpuMs = 0.0;
+    // Queues the crowd's draw with this frame's instances, blended by alpha
+    void queueCrowd(float alpha, const int* lightIndices, int lightCount);
+
+    // Sorted draw submission, rebuilt every frame in the frame arena
+    RenderQueue renderQueue{&frameArena};
+
     bool antialiasingEnabled;
     int antialiasingSamples;
 
@@ -135,5 +390,6 @@ private:
 
     void initImGUI();
     void renderImGUI();
+    void renderProfiler();
     void shutdownImGUI();
 };
\ No newline at end of file
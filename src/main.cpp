@@ -3,7 +3,7 @@
 int main(int argc, char** argv) {
     App app;
     try {
-        if (app.init()) {
+        if (app.init(argc, argv)) {
             return app.run();
         }
     } catch (const std::exception& e) {